@@ -20,6 +20,7 @@
 
 #include "f2p_gmp.h"
 #include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
 
 #if defined(__cplusplus)
@@ -27,13 +28,23 @@ extern "C" {
 #endif
 
 #if defined(DEBUG)
+/**
+ * print polynomial, reentrant.
+ *
+ * The string is allocated for each call, and one line is printed
+ * with stdout locked, so that lines of threads are not mixed.
+ */
 static inline void f2p_print(char *s, mpz_t x)
 {
-    static char buff[20000];
-    f2p_get_binstr(buff, x);
+    char *buff = f2p_get_binstr(NULL, x);
     int d = f2p_degree(x);
+    flockfile(stdout);
     printf("%s %d,%s\n", s, d, buff);
     fflush(stdout);
+    funlockfile(stdout);
+    void (*free_func)(void *, size_t);
+    mp_get_memory_functions(NULL, NULL, &free_func);
+    free_func(buff, strlen(buff) + 1);
 }
 #define PRT(s, x) f2p_print(s, x)
 #define PUTS(s) puts(s)
@@ -0,0 +1,282 @@
+/**
+ * @file f2p_alloc.c
+ *
+ * @brief Scoped caching allocator for GMP used in f2p operations.
+ *
+ * GMP memory functions are process wide and can be changed only when
+ * no other thread is using GMP. The caching functions are installed
+ * once, when the first scope begins, and never restored. Only the
+ * per-thread depth of scope changes afterwards, and threads without
+ * scope are forwarded to the previous functions.
+ *
+ * GMP gives the size of the block to free and realloc, so cached
+ * blocks need no header, and a block allocated in a scope can be
+ * freed by the previous free function after the scope. Blocks
+ * allocated in a scope should be freed in the same thread or after
+ * the scope.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "f2p_alloc.h"
+#include <gmp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    F2P_ALLOC_UNIT = sizeof(mp_limb_t),    // size class step
+    F2P_ALLOC_CLASSES = 8192,              // sizes up to 64KiB are cached
+    F2P_ALLOC_CACHE_MAX = 16 * 1024 * 1024 // max bytes cached per thread
+};
+
+struct F2P_ALLOC_CONTEXT_T {
+    int depth;
+    size_t cached;                         // bytes in list
+    f2p_alloc_stats_t stats;
+    void *list[F2P_ALLOC_CLASSES];
+};
+
+typedef struct F2P_ALLOC_CONTEXT_T f2p_alloc_context_t;
+
+// set once by install_hooks, read only afterwards
+static void *(*prev_alloc)(size_t);
+static void *(*prev_realloc)(void *, size_t, size_t);
+static void (*prev_free)(void *, size_t);
+static pthread_once_t f2p_alloc_hook_once = PTHREAD_ONCE_INIT;
+
+static pthread_key_t f2p_alloc_key;
+static pthread_once_t f2p_alloc_key_once = PTHREAD_ONCE_INIT;
+
+/**
+ * size class of size, -1 if not cached
+ */
+static inline int size_class(size_t size)
+{
+    if (size % F2P_ALLOC_UNIT != 0 || size < F2P_ALLOC_UNIT) {
+        return -1;
+    }
+    size_t c = size / F2P_ALLOC_UNIT;
+    if (c >= F2P_ALLOC_CLASSES) {
+        return -1;
+    }
+    return (int)c;
+}
+
+/**
+ * free cached blocks of context
+ */
+static void release_cache(f2p_alloc_context_t *ctx)
+{
+    for (int i = 1; i < F2P_ALLOC_CLASSES; i++) {
+        while (ctx->list[i] != NULL) {
+            void *p = ctx->list[i];
+            memcpy(&ctx->list[i], p, sizeof(void *));
+            prev_free(p, (size_t)i * F2P_ALLOC_UNIT);
+        }
+    }
+    ctx->cached = 0;
+}
+
+static void context_destroy(void *p)
+{
+    f2p_alloc_context_t *ctx = p;
+    ctx->depth = 0;
+    release_cache(ctx);
+    free(ctx);
+}
+
+static void key_create(void)
+{
+    pthread_key_create(&f2p_alloc_key, context_destroy);
+}
+
+/**
+ * context of the calling thread, NULL if not in scope
+ */
+static inline f2p_alloc_context_t * active_context(void)
+{
+    f2p_alloc_context_t *ctx = pthread_getspecific(f2p_alloc_key);
+    if (ctx == NULL || ctx->depth == 0) {
+        return NULL;
+    }
+    return ctx;
+}
+
+static void * cache_pop(f2p_alloc_context_t *ctx, int c)
+{
+    void *p = ctx->list[c];
+    if (p != NULL) {
+        memcpy(&ctx->list[c], p, sizeof(void *));
+        ctx->cached -= (size_t)c * F2P_ALLOC_UNIT;
+    }
+    return p;
+}
+
+/**
+ * keep p in cache, or free it if the cache is full
+ *
+ *@return 1 if cached, 0 if freed
+ */
+static int cache_push(f2p_alloc_context_t *ctx, int c, void *p)
+{
+    size_t size = (size_t)c * F2P_ALLOC_UNIT;
+    if (ctx->cached + size > F2P_ALLOC_CACHE_MAX) {
+        prev_free(p, size);
+        return 0;
+    }
+    memcpy(p, &ctx->list[c], sizeof(void *));
+    ctx->list[c] = p;
+    ctx->cached += size;
+    return 1;
+}
+
+static void * f2p_alloc_func(size_t size)
+{
+    f2p_alloc_context_t *ctx = active_context();
+    if (ctx == NULL) {
+        return prev_alloc(size);
+    }
+    ctx->stats.alloc++;
+    int c = size_class(size);
+    if (c >= 0) {
+        void *p = cache_pop(ctx, c);
+        if (p != NULL) {
+            ctx->stats.alloc_cached++;
+            return p;
+        }
+    }
+    return prev_alloc(size);
+}
+
+static void * f2p_realloc_func(void *ptr, size_t old_size, size_t new_size)
+{
+    f2p_alloc_context_t *ctx = active_context();
+    if (ctx == NULL) {
+        return prev_realloc(ptr, old_size, new_size);
+    }
+    ctx->stats.realloc++;
+    int oc = size_class(old_size);
+    int nc = size_class(new_size);
+    if (oc < 0 || nc < 0) {
+        return prev_realloc(ptr, old_size, new_size);
+    }
+    void *p = cache_pop(ctx, nc);
+    if (p != NULL) {
+        ctx->stats.realloc_cached++;
+    } else {
+        p = prev_alloc(new_size);
+    }
+    memcpy(p, ptr, old_size < new_size ? old_size : new_size);
+    cache_push(ctx, oc, ptr);
+    return p;
+}
+
+static void f2p_free_func(void *ptr, size_t size)
+{
+    f2p_alloc_context_t *ctx = active_context();
+    if (ctx == NULL) {
+        prev_free(ptr, size);
+        return;
+    }
+    ctx->stats.free++;
+    int c = size_class(size);
+    if (c < 0) {
+        prev_free(ptr, size);
+        return;
+    }
+    if (cache_push(ctx, c, ptr)) {
+        ctx->stats.free_cached++;
+    }
+}
+
+/**
+ * install caching functions, once in the process
+ */
+static void install_hooks(void)
+{
+    mp_get_memory_functions(&prev_alloc, &prev_realloc, &prev_free);
+    mp_set_memory_functions(f2p_alloc_func, f2p_realloc_func,
+                            f2p_free_func);
+}
+
+/**
+ * begin allocation scope of the calling thread.
+ *
+ * Scopes can be nested. Caching is effective until the outermost
+ * scope ends. The first call in the process installs memory
+ * functions of GMP, so it should be made while no other thread is
+ * using GMP.
+ */
+void f2p_alloc_scope_begin(void)
+{
+    pthread_once(&f2p_alloc_key_once, key_create);
+    pthread_once(&f2p_alloc_hook_once, install_hooks);
+    f2p_alloc_context_t *ctx = pthread_getspecific(f2p_alloc_key);
+    if (ctx == NULL) {
+        ctx = calloc(1, sizeof(f2p_alloc_context_t));
+        if (ctx == NULL) {
+            fprintf(stderr, "f2p_alloc: cannot allocate context\n");
+            abort();
+        }
+        pthread_setspecific(f2p_alloc_key, ctx);
+    }
+    ctx->depth++;
+}
+
+/**
+ * end allocation scope of the calling thread.
+ *
+ * When the outermost scope ends, cached blocks are freed. Memory
+ * functions of GMP are not restored.
+ */
+void f2p_alloc_scope_end(void)
+{
+    pthread_once(&f2p_alloc_key_once, key_create);
+    f2p_alloc_context_t *ctx = pthread_getspecific(f2p_alloc_key);
+    if (ctx == NULL || ctx->depth == 0) {
+        return;
+    }
+    if (--ctx->depth == 0) {
+        release_cache(ctx);
+    }
+}
+
+/**
+ * counters of the calling thread.
+ *
+ *@param stats counters
+ */
+void f2p_alloc_get_stats(f2p_alloc_stats_t *stats)
+{
+    pthread_once(&f2p_alloc_key_once, key_create);
+    f2p_alloc_context_t *ctx = pthread_getspecific(f2p_alloc_key);
+    if (ctx == NULL) {
+        memset(stats, 0, sizeof(f2p_alloc_stats_t));
+    } else {
+        *stats = ctx->stats;
+    }
+}
+
+/**
+ * reset counters of the calling thread.
+ */
+void f2p_alloc_reset_stats(void)
+{
+    pthread_once(&f2p_alloc_key_once, key_create);
+    f2p_alloc_context_t *ctx = pthread_getspecific(f2p_alloc_key);
+    if (ctx != NULL) {
+        memset(&ctx->stats, 0, sizeof(f2p_alloc_stats_t));
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef F2P_ALLOC_H
+#define F2P_ALLOC_H
+/**
+ * @file f2p_alloc.h
+ *
+ * @brief Scoped caching allocator for GMP used in f2p operations.
+ *
+ * Between f2p_alloc_scope_begin and f2p_alloc_scope_end, memory freed
+ * by GMP in the calling thread is kept in per-thread free lists
+ * classified by size, and reused by following allocations of the same
+ * size, instead of calling malloc and free every time. The lists of a
+ * thread keep at most 16MiB.
+ *
+ * The first f2p_alloc_scope_begin installs memory functions of GMP
+ * for the whole process, and they are kept after the scope ends. It
+ * should be called while no other thread is using GMP. After that,
+ * every allocation of GMP in every thread looks up the scope of the
+ * thread by pthread_getspecific, and is forwarded to the previous
+ * functions when the thread is not in scope.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * counters of the calling thread.
+ */
+    struct F2P_ALLOC_STATS_T {
+        unsigned long alloc;          // allocations in scope
+        unsigned long alloc_cached;   // allocations served from cache
+        unsigned long realloc;        // reallocations in scope
+        unsigned long realloc_cached; // reallocations served from cache
+        unsigned long free;           // frees in scope
+        unsigned long free_cached;    // frees kept in cache
+    };
+
+    typedef struct F2P_ALLOC_STATS_T f2p_alloc_stats_t;
+
+    void f2p_alloc_scope_begin(void);
+
+    void f2p_alloc_scope_end(void);
+
+    void f2p_alloc_get_stats(f2p_alloc_stats_t *stats);
+
+    void f2p_alloc_reset_stats(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_ALLOC_H
@@ -0,0 +1,252 @@
+/**
+ * @file f2p_async.c
+ *
+ * @brief Asynchronous jobs of long computations of F2 Polynomial
+ * Library.
+ *
+ * Each job runs in its own detached thread, so long jobs do not
+ * occupy workers of the executor, which are used by the computation
+ * itself, e.g. parallel multiplication.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_async.h"
+#include <stdlib.h>
+
+enum {
+    KIND_MINPOLY,
+    KIND_IRREDUCIBLE,
+    KIND_JUMP
+};
+
+static void * job_main(void *p)
+{
+    f2p_job_t *job = p;
+    f2p_control_set(&job->control);
+    switch (job->kind) {
+    case KIND_MINPOLY:
+        f2p_minpoly(job->poly, job->input, job->maxdeg);
+        break;
+    case KIND_IRREDUCIBLE:
+        job->irreducible = f2p_is_irreducible(job->input);
+        break;
+    default:
+        f2p_calc_jump(job->poly, job->input, job->step);
+        break;
+    }
+    f2p_control_set(NULL);
+    // a cancel after the last step of the loop does not change the result
+    int state = F2P_JOB_DONE;
+    if (f2p_control_stopped(&job->control)) {
+        state = F2P_JOB_CANCELLED;
+    }
+    int running = F2P_JOB_RUNNING;
+    __atomic_compare_exchange_n(&job->state, &running, state, 0,
+                                __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    if (job->callback != NULL) {
+        job->callback(job, job->arg);
+    }
+    pthread_mutex_lock(&job->mutex);
+    job->finished = 1;
+    pthread_cond_broadcast(&job->cond);
+    pthread_mutex_unlock(&job->mutex);
+    return NULL;
+}
+
+static f2p_job_t * job_new(int kind, f2p_job_callback_t callback,
+                           void *arg)
+{
+    f2p_job_t *job = malloc(sizeof(f2p_job_t));
+    assert(job != NULL);
+    job->kind = kind;
+    job->state = F2P_JOB_RUNNING;
+    job->finished = 0;
+    job->maxdeg = 0;
+    job->irreducible = 0;
+    mpz_init(job->poly);
+    mpz_init(job->input);
+    mpz_init(job->step);
+    job->control.cancel = 0;
+    job->control.progress = 0;
+    job->control.stopped = 0;
+    job->control.parent = NULL;
+    job->callback = callback;
+    job->arg = arg;
+    pthread_mutex_init(&job->mutex, NULL);
+    pthread_cond_init(&job->cond, NULL);
+    return job;
+}
+
+/**
+ * start a job, the job runs in the calling thread if a thread can
+ * not be created.
+ */
+static f2p_job_t * job_start(f2p_job_t *job)
+{
+    pthread_t th;
+    if (pthread_create(&th, NULL, job_main, job) == 0) {
+        pthread_detach(th);
+    } else {
+        job_main(job);
+    }
+    return job;
+}
+
+/**
+ * start f2p_minpoly asynchronously.
+ *
+ *@param seq linear recurrence sequence, copied
+ *@param maxdeg supporsed max degree of minpoly
+ *@param callback called when the job ends, can be NULL
+ *@param arg argument of callback
+ *@return job
+ */
+f2p_job_t * f2p_minpoly_async(mpz_t seq, int maxdeg,
+                              f2p_job_callback_t callback, void *arg)
+{
+    f2p_job_t *job = job_new(KIND_MINPOLY, callback, arg);
+    mpz_set(job->input, seq);
+    job->maxdeg = maxdeg;
+    return job_start(job);
+}
+
+/**
+ * start f2p_is_irreducible asynchronously.
+ *
+ *@param poly input polynomial, copied
+ *@param callback called when the job ends, can be NULL
+ *@param arg argument of callback
+ *@return job
+ */
+f2p_job_t * f2p_is_irreducible_async(mpz_t poly,
+                                     f2p_job_callback_t callback, void *arg)
+{
+    f2p_job_t *job = job_new(KIND_IRREDUCIBLE, callback, arg);
+    mpz_set(job->input, poly);
+    return job_start(job);
+}
+
+/**
+ * start f2p_calc_jump asynchronously.
+ *
+ *@param minpoly minimum polynomial of PRNG, copied
+ *@param step jump step, copied
+ *@param callback called when the job ends, can be NULL
+ *@param arg argument of callback
+ *@return job
+ */
+f2p_job_t * f2p_calc_jump_async(mpz_t minpoly, mpz_t step,
+                                f2p_job_callback_t callback, void *arg)
+{
+    f2p_job_t *job = job_new(KIND_JUMP, callback, arg);
+    mpz_set(job->input, minpoly);
+    mpz_set(job->step, step);
+    return job_start(job);
+}
+
+/**
+ * request cancel of a job.
+ *
+ * The job stops at the next step of its loop, and its state becomes
+ * F2P_JOB_CANCELLED. A job which has done its last step before the
+ * request is not affected, and its state becomes F2P_JOB_DONE.
+ *
+ *@param job job
+ */
+void f2p_job_cancel(f2p_job_t *job)
+{
+    if (f2p_job_state(job) == F2P_JOB_RUNNING) {
+        f2p_control_cancel(&job->control);
+    }
+}
+
+/**
+ * state of a job.
+ *
+ *@param job job
+ *@return F2P_JOB_RUNNING, F2P_JOB_DONE or F2P_JOB_CANCELLED
+ */
+int f2p_job_state(f2p_job_t *job)
+{
+    return __atomic_load_n(&job->state, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * progress of a job, see f2p_async.h.
+ *
+ *@param job job
+ *@return progress
+ */
+long f2p_job_progress(f2p_job_t *job)
+{
+    return f2p_control_progress(&job->control);
+}
+
+/**
+ * wait the end of a job and its callback.
+ *
+ *@param job job
+ *@return F2P_JOB_DONE or F2P_JOB_CANCELLED
+ */
+int f2p_job_wait(f2p_job_t *job)
+{
+    pthread_mutex_lock(&job->mutex);
+    while (!job->finished) {
+        pthread_cond_wait(&job->cond, &job->mutex);
+    }
+    int state = job->state;
+    pthread_mutex_unlock(&job->mutex);
+    return state;
+}
+
+/**
+ * result of f2p_minpoly_async or f2p_calc_jump_async.
+ *
+ * state of the job should be F2P_JOB_DONE.
+ *
+ *@param poly result polynomial
+ *@param job job
+ */
+void f2p_job_get_poly(mpz_t poly, f2p_job_t *job)
+{
+    assert(f2p_job_state(job) == F2P_JOB_DONE);
+    mpz_set(poly, job->poly);
+}
+
+/**
+ * result of f2p_is_irreducible_async.
+ *
+ * state of the job should be F2P_JOB_DONE.
+ *
+ *@param job job
+ *@return 1 if the polynomial is irreducible, 0 otherwise
+ */
+int f2p_job_get_irreducible(f2p_job_t *job)
+{
+    assert(f2p_job_state(job) == F2P_JOB_DONE);
+    return job->irreducible;
+}
+
+/**
+ * wait the end of a job and free it.
+ *
+ *@param job job
+ */
+void f2p_job_free(f2p_job_t *job)
+{
+    f2p_job_wait(job);
+    mpz_clear(job->poly);
+    mpz_clear(job->input);
+    mpz_clear(job->step);
+    pthread_mutex_destroy(&job->mutex);
+    pthread_cond_destroy(&job->cond);
+    free(job);
+}
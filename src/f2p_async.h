@@ -0,0 +1,109 @@
+#pragma once
+#ifndef F2P_ASYNC_H
+#define F2P_ASYNC_H
+/**
+ * @file f2p_async.h
+ *
+ * @brief Asynchronous jobs of long computations of F2 Polynomial
+ * Library.
+ *
+ * f2p_minpoly_async, f2p_is_irreducible_async and f2p_calc_jump_async
+ * copy their inputs, start the computation in a new thread and return
+ * a job at once. The callback given at submission is called in the
+ * thread of the job after the job is finished or cancelled. A job
+ * can be cancelled by f2p_job_cancel; the computation stops at the
+ * next step of its Euclid or squaring loop. The progress of a job is
+ * the value stored by the loop running (see f2p_control_t):
+ * - minpoly: degree of the current remainder, which decreases to
+ *   maxdeg
+ * - is_irreducible: number of squarings done, up to degree / 2
+ * - calc_jump: number of bits of step processed
+ *
+ * Jobs should be freed by f2p_job_free, which waits the end of the
+ * job and its callback.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+#include <pthread.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+    enum {
+        F2P_JOB_RUNNING = 0,
+        F2P_JOB_DONE = 1,
+        F2P_JOB_CANCELLED = 2
+    };
+
+    typedef struct F2P_JOB_T f2p_job_t;
+
+/**
+ * callback called when a job is finished or cancelled.
+ *
+ * The callback is called in the thread of the job, and should not
+ * call f2p_job_wait or f2p_job_free of the job.
+ *
+ *@param job finished job
+ *@param arg user argument
+ */
+    typedef void (*f2p_job_callback_t)(f2p_job_t *job, void *arg);
+
+/**
+ * asynchronous job
+ */
+    struct F2P_JOB_T {
+        int kind;
+        int state;             // F2P_JOB_RUNNING, DONE or CANCELLED, atomic
+        int finished;          // 1 after callback returned
+        int maxdeg;
+        int irreducible;       // result of f2p_is_irreducible
+        mpz_t poly;            // result of f2p_minpoly or f2p_calc_jump
+        mpz_t input;
+        mpz_t step;
+        f2p_control_t control;
+        f2p_job_callback_t callback;
+        void *arg;
+        pthread_mutex_t mutex;
+        pthread_cond_t cond;
+    };
+
+    f2p_job_t * f2p_minpoly_async(mpz_t seq, int maxdeg,
+                                  f2p_job_callback_t callback, void *arg);
+
+    f2p_job_t * f2p_is_irreducible_async(mpz_t poly,
+                                         f2p_job_callback_t callback,
+                                         void *arg);
+
+    f2p_job_t * f2p_calc_jump_async(mpz_t minpoly, mpz_t step,
+                                    f2p_job_callback_t callback, void *arg);
+
+    void f2p_job_cancel(f2p_job_t *job);
+
+    int f2p_job_state(f2p_job_t *job);
+
+    long f2p_job_progress(f2p_job_t *job);
+
+    int f2p_job_wait(f2p_job_t *job);
+
+    void f2p_job_get_poly(mpz_t poly, f2p_job_t *job);
+
+    int f2p_job_get_irreducible(f2p_job_t *job);
+
+    void f2p_job_free(f2p_job_t *job);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_ASYNC_H
@@ -0,0 +1,547 @@
+/**
+ * @file f2p_batch.c
+ *
+ * @brief arrays of F2 polynomials sharing one modulus.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_batch.h"
+#include "f2p_limb.h"
+#include "f2p_small.h"
+#include "f2p_thread.h"
+
+#define L F2P_BATCH_LANES
+
+/**
+ * Barrett reduction by carry-less products of lanes in lock step.
+ * Without PCLMULQDQ, the comb method of each lane is faster.
+ */
+#if defined(F2P_SMALL) && defined(__PCLMUL__)
+#define F2P_BATCH_CLMUL 1
+#endif
+
+/**
+ * carry-less product of two limbs
+ *
+ *@param hi upper half of the product
+ *@param a limb
+ *@param b limb
+ *@return lower half of the product
+ */
+static inline mp_limb_t batch_clmul(mp_limb_t *hi, mp_limb_t a, mp_limb_t b)
+{
+#if defined(F2P_SMALL)
+    f2p_u128 p = f2p_small_clmul(a, b);
+    *hi = (mp_limb_t)(p >> 64);
+    return (mp_limb_t)p;
+#else
+    return f2p_limb_clmul(hi, a, b);
+#endif
+}
+
+/**
+ * p = a * b for L lanes
+ *
+ * Products of the same limb positions of L lanes are independent and
+ * computed one after another.
+ *
+ *@param p result of 2 * n limbs for each lane, limb j of lane l is
+ * p[j * L + l]
+ *@param a polynomials, limb j of lane l is a[j * astride + l]
+ *@param astride stride of a
+ *@param b polynomials, limb j of lane l is b[j * bstride + l]
+ *@param bstride stride of b
+ *@param n number of limbs of a polynomial
+ */
+static void mul_lanes(mp_limb_t *p, const mp_limb_t *a, int astride,
+                      const mp_limb_t *b, int bstride, int n)
+{
+    for (int j = 0; j < 2 * n * L; j++) {
+        p[j] = 0;
+    }
+    for (int j = 0; j < n; j++) {
+        const mp_limb_t *aj = a + j * astride;
+        for (int k = 0; k < n; k++) {
+            const mp_limb_t *bk = b + k * bstride;
+            mp_limb_t *pj = p + (j + k) * L;
+            for (int l = 0; l < L; l++) {
+                mp_limb_t hi;
+                mp_limb_t lo = batch_clmul(&hi, aj[l], bk[l]);
+                pj[l] ^= lo;
+                pj[L + l] ^= hi;
+            }
+        }
+    }
+}
+
+/**
+ * p = a * a for L lanes
+ *
+ *@param p result of 2 * n limbs for each lane, limb j of lane l is
+ * p[j * L + l]
+ *@param a polynomials, limb j of lane l is a[j * astride + l]
+ *@param astride stride of a
+ *@param n number of limbs of a polynomial
+ */
+static void sqr_lanes(mp_limb_t *p, const mp_limb_t *a, int astride, int n)
+{
+    for (int j = 0; j < n; j++) {
+        const mp_limb_t *aj = a + j * astride;
+        mp_limb_t *pj = p + 2 * j * L;
+        for (int l = 0; l < L; l++) {
+            pj[l] = f2p_limb_sqr(&pj[L + l], aj[l]);
+        }
+    }
+}
+
+#if defined(F2P_BATCH_CLMUL)
+/**
+ * r = p / t^shift for L lanes
+ *
+ *@param r result of rn limbs for each lane, limb j of lane l is
+ * r[j * L + l]
+ *@param rn number of limbs of r
+ *@param p polynomials of pn limbs, limb j of lane l is p[j * L + l]
+ *@param pn number of limbs of p
+ *@param shift shift in bits
+ */
+static void rshift_lanes(mp_limb_t *r, int rn, const mp_limb_t *p, int pn,
+                         int shift)
+{
+    const int w = F2P_LIMB_BITS;
+    int k = shift / w;
+    int s = shift % w;
+    for (int j = 0; j < rn; j++) {
+        const mp_limb_t *lo = p + (j + k) * L;
+        const mp_limb_t *hi = lo + L;
+        mp_limb_t *rj = r + j * L;
+        if (j + k >= pn) {
+            for (int l = 0; l < L; l++) {
+                rj[l] = 0;
+            }
+        } else if (s == 0) {
+            for (int l = 0; l < L; l++) {
+                rj[l] = lo[l];
+            }
+        } else if (j + k + 1 >= pn) {
+            for (int l = 0; l < L; l++) {
+                rj[l] = lo[l] >> s;
+            }
+        } else {
+            for (int l = 0; l < L; l++) {
+                rj[l] = (lo[l] >> s) | (hi[l] << (w - s));
+            }
+        }
+    }
+}
+
+/**
+ * r ^= limbs lo, ..., hi - 1 of a * b for L lanes, b is shared by
+ * the lanes.
+ *
+ * Products of the same limb positions of L lanes are independent and
+ * computed one after another.
+ *
+ *@param r result of hi - lo limbs for each lane, limb j of lane l is
+ * r[(j - lo) * L + l]
+ *@param lo lowest limb of the product
+ *@param hi highest limb of the product plus one
+ *@param a polynomials of an limbs, limb j of lane l is a[j * L + l]
+ *@param an number of limbs of a
+ *@param b polynomial
+ *@param bn number of limbs of b
+ */
+static void mul_shared_lanes(mp_limb_t *r, int lo, int hi,
+                             const mp_limb_t *a, int an,
+                             const mp_limb_t *b, int bn)
+{
+    for (int i = 0; i < an; i++) {
+        const mp_limb_t *ai = a + i * L;
+        int j0 = lo - 1 - i > 0 ? lo - 1 - i : 0;
+        int j1 = hi - i < bn ? hi - i : bn;
+        for (int j = j0; j < j1; j++) {
+            int k = i + j;
+            mp_limb_t *rk = r + (k - lo) * L;
+            mp_limb_t pl[L];
+            mp_limb_t ph[L];
+            for (int l = 0; l < L; l++) {
+                pl[l] = batch_clmul(&ph[l], ai[l], b[j]);
+            }
+            if (k >= lo) {
+                for (int l = 0; l < L; l++) {
+                    rk[l] ^= pl[l];
+                }
+            }
+            if (k + 1 < hi) {
+                for (int l = 0; l < L; l++) {
+                    rk[L + l] ^= ph[l];
+                }
+            }
+        }
+    }
+}
+
+#endif
+
+/**
+ * get limbs of lane l
+ */
+static void get_lane(mp_limb_t *r, const mp_limb_t *a, int stride, int n)
+{
+    for (int j = 0; j < n; j++) {
+        r[j] = a[j * stride];
+    }
+}
+
+#if !defined(F2P_BATCH_CLMUL)
+/**
+ * r = p % mod by Barrett reduction
+ *
+ * q = ((p / t^n) * mu) / t^n is the exact quotient for p of degree
+ * less than 2n, and r is the lower n bits of p + q * mod.
+ *
+ *@param r result of ctx->size limbs
+ *@param p polynomial of degree less than 2 * ctx->degree
+ *@param pn number of limbs of p
+ *@param ctx modulus data, mtable should be made
+ *@param work work space of 5 * ctx->size + 8 limbs
+ */
+static void reduce(mp_limb_t *r, mp_limb_t *p, int pn,
+                   const f2p_modctx_t *ctx, mp_limb_t *work)
+{
+    const int w = F2P_LIMB_BITS;
+    int n = ctx->degree;
+    int nl = ctx->size;
+    pn = f2p_limb_normalize(p, pn);
+    for (int j = 0; j < nl; j++) {
+        r[j] = j < pn ? p[j] : 0;
+    }
+    if (f2p_limb_poly_degree(p, pn) >= n) {
+        mp_limb_t *p1 = work;
+        int lo = n / w;
+        int p1n = f2p_limb_rshift(p1, p, pn, n);
+        int hi = p1n + ctx->mtsize;
+        mp_limb_t *h = p1 + nl + 1;
+        mp_limb_t *acc = h + 2 * nl + 3;
+        for (int j = 0; j < hi - lo; j++) {
+            h[j] = 0;
+        }
+        f2p_limb_comb_mul(h, lo, hi, p1, p1n, ctx->mtable, ctx->mtsize, acc);
+        int qn = f2p_limb_rshift(h, h, hi - lo, n - lo * w);
+        f2p_limb_comb_mul(r, 0, nl, h, qn, ctx->table, ctx->tsize, acc);
+    }
+    if (n % w != 0) {
+        r[nl - 1] &= ((mp_limb_t)1 << (n % w)) - 1;
+    }
+}
+
+/**
+ * set limbs of lane l
+ */
+static void set_lane(mp_limb_t *r, int stride, const mp_limb_t *a, int n)
+{
+    for (int j = 0; j < n; j++) {
+        r[j * stride] = a[j];
+    }
+}
+
+#endif
+
+/**
+ * r = p % mod for L lanes by Barrett reduction
+ *
+ * q = ((p / t^n) * mu) / t^n is the exact quotient for p of degree
+ * less than 2n, and r is the lower n bits of p + q * mod. With
+ * F2P_BATCH_CLMUL, only the upper half of (p / t^n) * mu and the lower
+ * half of q * mod are computed by carry-less products, and the lanes
+ * are processed in lock step. Otherwise each lane is reduced by the
+ * comb method.
+ *
+ *@param r result of ctx->size limbs for each lane, limb j of lane l
+ * is r[j * rstride + l]
+ *@param rstride stride of r
+ *@param p polynomials of degree less than 2 * ctx->degree, 2 *
+ * ctx->size limbs for each lane, limb j of lane l is p[j * L + l]
+ *@param ctx modulus data, mtable should be made
+ *@param work work space of 4 * ctx->size * L limbs
+ */
+static void reduce_lanes(mp_limb_t *r, int rstride, const mp_limb_t *p,
+                         const f2p_modctx_t *ctx, mp_limb_t *work)
+{
+#if defined(F2P_BATCH_CLMUL)
+    const int w = F2P_LIMB_BITS;
+    int n = ctx->degree;
+    int nl = ctx->size;
+    int lo = n / w;
+    // entry 1 of the tables is mu and mod themselves
+    const mp_limb_t *mu = ctx->mtable + ctx->mtsize;
+    const mp_limb_t *mod = ctx->table + ctx->tsize;
+    mp_limb_t *p1 = work;
+    mp_limb_t *h = p1 + nl * L;
+    mp_limb_t *q = h + 2 * nl * L;
+    rshift_lanes(p1, nl, p, 2 * nl, n);
+    for (int j = 0; j < (2 * nl - lo) * L; j++) {
+        h[j] = 0;
+    }
+    mul_shared_lanes(h, lo, 2 * nl, p1, nl, mu, ctx->mtsize - 1);
+    rshift_lanes(q, nl, h, 2 * nl - lo, n - lo * w);
+    mp_limb_t *rl = h;
+    for (int j = 0; j < nl * L; j++) {
+        rl[j] = p[j];
+    }
+    mul_shared_lanes(rl, 0, nl, q, nl, mod, ctx->tsize - 1);
+    if (n % w != 0) {
+        mp_limb_t mask = ((mp_limb_t)1 << (n % w)) - 1;
+        for (int l = 0; l < L; l++) {
+            rl[(nl - 1) * L + l] &= mask;
+        }
+    }
+    for (int j = 0; j < nl; j++) {
+        for (int l = 0; l < L; l++) {
+            r[j * rstride + l] = rl[j * L + l];
+        }
+    }
+#else
+    int nl = ctx->size;
+    mp_limb_t *lane = work;
+    mp_limb_t *res = lane + 2 * nl;
+    for (int l = 0; l < L; l++) {
+        get_lane(lane, p + l, L, 2 * nl);
+        reduce(res, lane, 2 * nl, ctx, res + nl);
+        set_lane(r + l, rstride, res, nl);
+    }
+#endif
+}
+
+/**
+ * allocate limbs by memory functions of GMP
+ *
+ *@param n number of limbs
+ *@return limbs
+ */
+static mp_limb_t * limb_alloc(int n)
+{
+    void *(*alloc_func)(size_t);
+    mp_get_memory_functions(&alloc_func, NULL, NULL);
+    return alloc_func((size_t)n * sizeof(mp_limb_t));
+}
+
+/**
+ * free limbs allocated by limb_alloc
+ *
+ *@param p limbs
+ *@param n number of limbs
+ */
+static void limb_free(mp_limb_t *p, int n)
+{
+    void (*free_func)(void *, size_t);
+    mp_get_memory_functions(NULL, NULL, &free_func);
+    free_func(p, (size_t)n * sizeof(mp_limb_t));
+}
+
+/**
+ * initialize batch, all polynomials are set to 0.
+ *
+ *@param batch batch
+ *@param count number of polynomials
+ *@param ctx modulus data
+ */
+void f2p_batch_init(f2p_batch_t *batch, int count, const f2p_modctx_t *ctx)
+{
+    batch->ctx = ctx;
+    batch->count = count;
+    batch->stride = (count + L - 1) / L * L;
+    batch->size = ctx->size;
+    int n = batch->stride * batch->size;
+    batch->limb = limb_alloc(n > 0 ? n : 1);
+    for (int i = 0; i < n; i++) {
+        batch->limb[i] = 0;
+    }
+}
+
+/**
+ * free batch
+ *
+ *@param batch batch
+ */
+void f2p_batch_clear(f2p_batch_t *batch)
+{
+    int n = batch->stride * batch->size;
+    limb_free(batch->limb, n > 0 ? n : 1);
+}
+
+/**
+ * batch[index] = z % mod
+ *
+ * use 2 wm of the calling thread.
+ *
+ *@param batch batch
+ *@param index index of polynomial
+ *@param z polynomial
+ */
+void f2p_batch_set(f2p_batch_t *batch, int index, mpz_t z)
+{
+    assert(0 <= index && index < batch->count);
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_set(*x, z);
+    f2p_mod(*x, (mpz_ptr)batch->ctx->mod, wm); // 1 wm
+    int n = mpz_size(*x);
+    const mp_limb_t *xp = mpz_limbs_read(*x);
+    for (int j = 0; j < batch->size; j++) {
+        batch->limb[j * batch->stride + index] = j < n ? xp[j] : 0;
+    }
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * z = batch[index]
+ *
+ *@param z result
+ *@param batch batch
+ *@param index index of polynomial
+ */
+void f2p_batch_get(mpz_t z, const f2p_batch_t *batch, int index)
+{
+    assert(0 <= index && index < batch->count);
+    int n = batch->size;
+    if (n == 0) {
+        mpz_set_ui(z, 0);
+        return;
+    }
+    mp_limb_t *zp = mpz_limbs_write(z, n);
+    get_lane(zp, batch->limb + index, batch->stride, n);
+    mpz_limbs_finish(z, f2p_limb_normalize(zp, n));
+}
+
+struct F2P_BATCH_ARG_T {
+    f2p_batch_t *r;
+    const f2p_batch_t *a;
+    const f2p_batch_t *b;
+    mpz_ptr e;
+};
+
+/**
+ * work space for a block, 6 * n * L limbs
+ */
+static mp_limb_t * block_work(f2p_wm_t *wm, int n)
+{
+    return mpz_limbs_write(*f2p_wm_alloc(wm), 6 * n * L);
+}
+
+/**
+ * r[i] = a[i] * b[i] % mod for a block of L polynomials
+ */
+static void mulmod_job(int index, int worker, void *p)
+{
+    (void)worker;
+    struct F2P_BATCH_ARG_T *arg = p;
+    const f2p_modctx_t *ctx = arg->r->ctx;
+    int n = ctx->size;
+    int stride = arg->r->stride;
+    int i0 = index * L;
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *prod = block_work(wm, n);
+    mp_limb_t *work = prod + 2 * n * L;
+    mul_lanes(prod, arg->a->limb + i0, stride, arg->b->limb + i0, stride, n);
+    reduce_lanes(arg->r->limb + i0, stride, prod, ctx, work);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * r[i] = x[i]^e % mod for a block of L polynomials
+ *
+ * left to right binary method, the current powers of the block are
+ * kept in structure of arrays layout.
+ */
+static void powermod_job(int index, int worker, void *p)
+{
+    (void)worker;
+    struct F2P_BATCH_ARG_T *arg = p;
+    const f2p_modctx_t *ctx = arg->r->ctx;
+    int n = ctx->size;
+    int stride = arg->r->stride;
+    int i0 = index * L;
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *prod = block_work(wm, n);
+    mp_limb_t *work = prod + 2 * n * L;
+    mp_limb_t *pw = mpz_limbs_write(*f2p_wm_alloc(wm), n * L);
+    const mp_limb_t *x = arg->a->limb + i0;
+    for (int j = 0; j < n * L; j++) {
+        pw[j] = 0;
+    }
+    for (int l = 0; l < L; l++) {
+        pw[l] = 1;
+    }
+    for (long bpos = (long)mpz_sizeinbase(arg->e, 2) - 1; bpos >= 0;
+         bpos--) {
+        sqr_lanes(prod, pw, L, n);
+        reduce_lanes(pw, L, prod, ctx, work);
+        if (mpz_tstbit(arg->e, bpos)) {
+            mul_lanes(prod, pw, L, x, stride, n);
+            reduce_lanes(pw, L, prod, ctx, work);
+        }
+    }
+    for (int j = 0; j < n; j++) {
+        for (int l = 0; l < L; l++) {
+            arg->r->limb[j * stride + i0 + l] = pw[j * L + l];
+        }
+    }
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * r[i] = (a[i] * b[i]) % mod for all i
+ *
+ * r can be a or b.
+ *
+ *@param r result
+ *@param a batch
+ *@param b batch
+ *@param num_threads number of threads, 0 means size of the executor
+ */
+void f2p_mulmod_batch(f2p_batch_t *r, const f2p_batch_t *a,
+                      const f2p_batch_t *b, int num_threads)
+{
+    assert(r->ctx == a->ctx && r->ctx == b->ctx);
+    assert(r->count == a->count && r->count == b->count);
+    if (r->size == 0) {
+        return;
+    }
+    f2p_modctx_mu_table(r->ctx);
+    struct F2P_BATCH_ARG_T arg = {r, a, b, NULL};
+    f2p_parallel_for(r->stride / L, num_threads, mulmod_job, &arg);
+}
+
+/**
+ * r[i] = (x[i]^e) % mod for all i
+ *
+ * r can be x.
+ *
+ *@param r result
+ *@param x batch
+ *@param e exponent (big integer)
+ *@param num_threads number of threads, 0 means size of the executor
+ */
+void f2p_powermod_batch(f2p_batch_t *r, const f2p_batch_t *x, mpz_t e,
+                        int num_threads)
+{
+    assert(r->ctx == x->ctx && r->count == x->count);
+    if (r->size == 0) {
+        return;
+    }
+    f2p_modctx_mu_table(r->ctx);
+    struct F2P_BATCH_ARG_T arg = {r, x, NULL, e};
+    f2p_parallel_for(r->stride / L, num_threads, powermod_job, &arg);
+}
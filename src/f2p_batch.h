@@ -0,0 +1,73 @@
+#pragma once
+#ifndef F2P_BATCH_H
+#define F2P_BATCH_H
+/**
+ * @file f2p_batch.h
+ *
+ * @brief arrays of F2 polynomials sharing one modulus.
+ *
+ * f2p_batch_t keeps residues modulo the modulus of an f2p_modctx_t
+ * in structure of arrays layout: limb j of all polynomials are
+ * stored contiguously. Operations on batches process
+ * F2P_BATCH_LANES polynomials in lock step, so that independent
+ * carry-less multiplications are interleaved, and split the batch
+ * among threads. Products are reduced by Barrett reduction with mu
+ * and the modulus, which are made once by the first operation and
+ * shared by all batches of the modulus. Compiled with PCLMULQDQ, the
+ * squarings, products and reductions of the lanes are all
+ * interleaved; otherwise each lane is reduced by the comb method.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_precomp.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define F2P_BATCH_LANES 4
+
+/**
+ * array of residues
+ *
+ * limb j of polynomial i is limb[j * stride + i].
+ */
+    struct F2P_BATCH_T {
+        const f2p_modctx_t *ctx;  // modulus, should live longer
+        int count;                // number of polynomials
+        int stride;               // count rounded up to F2P_BATCH_LANES
+        int size;                 // number of limbs of a polynomial
+        mp_limb_t *limb;
+    };
+
+    typedef struct F2P_BATCH_T f2p_batch_t;
+
+    void f2p_batch_init(f2p_batch_t *batch, int count,
+                        const f2p_modctx_t *ctx);
+
+    void f2p_batch_clear(f2p_batch_t *batch);
+
+    void f2p_batch_set(f2p_batch_t *batch, int index, mpz_t z);
+
+    void f2p_batch_get(mpz_t z, const f2p_batch_t *batch, int index);
+
+    void f2p_mulmod_batch(f2p_batch_t *r, const f2p_batch_t *a,
+                          const f2p_batch_t *b, int num_threads);
+
+    void f2p_powermod_batch(f2p_batch_t *r, const f2p_batch_t *x, mpz_t e,
+                            int num_threads);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_BATCH_H
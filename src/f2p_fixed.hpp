@@ -0,0 +1,549 @@
+#pragma once
+#ifndef F2P_FIXED_HPP
+#define F2P_FIXED_HPP
+/**
+ * @file f2p_fixed.hpp
+ *
+ * @brief F2 polynomials of fixed size for C++.
+ *
+ * F2Poly<Bits> keeps coefficients of x^0, ..., x^(Bits - 1) in
+ * std::array, sizes of all loops are known at compile time and no
+ * heap memory is used. F2PolyMod<Modulus> is a residue class modulo
+ * a polynomial fixed at compile time.
+ *
+ * Functions are constexpr when compiled as C++17 or later, and
+ * inline otherwise.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <gmp.h>
+
+#if __cplusplus >= 201703L
+#define F2P_CONSTEXPR constexpr
+#else
+#define F2P_CONSTEXPR inline
+#endif
+
+namespace f2p {
+
+    namespace detail {
+/**
+ * degree of nonzero word
+ */
+        F2P_CONSTEXPR int degree64(uint64_t x)
+        {
+#if defined(__GNUC__)
+            return 63 - __builtin_clzll(x);
+#else
+            int d = 0;
+            while (x >>= 1) {
+                d++;
+            }
+            return d;
+#endif
+        }
+
+/**
+ * carry-less product of two words, four bits window.
+ * same method as f2p_limb_clmul in f2p_limb.h.
+ */
+        F2P_CONSTEXPR uint64_t clmul64(uint64_t& hi, uint64_t a, uint64_t b)
+        {
+            uint64_t u[16] = {};
+            u[1] = a;
+            for (int i = 2; i < 16; i += 2) {
+                u[i] = u[i / 2] << 1;
+                u[i + 1] = u[i] ^ a;
+            }
+            uint64_t l = u[b >> 60];
+            uint64_t h = 0;
+            for (int i = 56; i >= 0; i -= 4) {
+                h = (h << 4) | (l >> 60);
+                l = (l << 4) ^ u[(b >> i) & 15];
+            }
+            // bits 63, 62, 61 of a are lost in u[]
+            uint64_t v = b;
+            for (int j = 1; j < 4; j++) {
+                v = (v & UINT64_C(0xeeeeeeeeeeeeeeee)) >> 1;
+                h ^= v & (0 - ((a >> (64 - j)) & 1));
+            }
+            hi = h;
+            return l;
+        }
+
+/**
+ * spread bits of 32 bit word to even positions.
+ */
+        F2P_CONSTEXPR uint64_t spread32(uint64_t y)
+        {
+            y = (y | (y << 16)) & UINT64_C(0x0000ffff0000ffff);
+            y = (y | (y << 8)) & UINT64_C(0x00ff00ff00ff00ff);
+            y = (y | (y << 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+            y = (y | (y << 2)) & UINT64_C(0x3333333333333333);
+            y = (y | (y << 1)) & UINT64_C(0x5555555555555555);
+            return y;
+        }
+
+        F2P_CONSTEXPR int hexval(char c)
+        {
+            if (c >= '0' && c <= '9') {
+                return c - '0';
+            }
+            if (c >= 'a' && c <= 'f') {
+                return c - 'a' + 10;
+            }
+            if (c >= 'A' && c <= 'F') {
+                return c - 'A' + 10;
+            }
+            return -1;
+        }
+    }
+
+/**
+ * F2 polynomial with Bits coefficients.
+ *
+ * coefficient of x^i is bit (i % 64) of limb[i / 64]. Bits above
+ * Bits - 1 are always zero.
+ */
+    template<int Bits>
+    class F2Poly {
+    public:
+        static_assert(Bits > 0, "Bits should be positive");
+        static constexpr int bits = Bits;
+        static constexpr int size = (Bits + 63) / 64;
+        std::array<uint64_t, size> limb;
+
+        constexpr F2Poly() : limb() {}
+
+        F2P_CONSTEXPR explicit F2Poly(uint64_t v) : limb()
+        {
+            limb[0] = v;
+            mask_top();
+        }
+
+        static F2P_CONSTEXPR F2Poly monomial(int n)
+        {
+            F2Poly r;
+            r.setbit(n);
+            return r;
+        }
+
+/**
+ * polynomial from hexadecimal string, same as f2p_set_hexstr.
+ * coefficients of degree Bits or more are discarded.
+ */
+        static F2P_CONSTEXPR F2Poly from_hex(const char *str)
+        {
+            F2Poly r;
+            for (; *str != '\0'; str++) {
+                int v = detail::hexval(*str);
+                if (v < 0) {
+                    continue;
+                }
+                r <<= 4;
+                r.limb[0] |= static_cast<uint64_t>(v);
+            }
+            r.mask_top();
+            return r;
+        }
+
+/**
+ * degree of polynomial, -1 for the polynomial 0.
+ */
+        F2P_CONSTEXPR int degree() const
+        {
+            for (int i = size - 1; i >= 0; i--) {
+                if (limb[i] != 0) {
+                    return i * 64 + detail::degree64(limb[i]);
+                }
+            }
+            return -1;
+        }
+
+        F2P_CONSTEXPR bool is_zero() const
+        {
+            for (int i = 0; i < size; i++) {
+                if (limb[i] != 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        F2P_CONSTEXPR int coefficient(int i) const
+        {
+            if (i < 0 || i >= Bits) {
+                return 0;
+            }
+            return static_cast<int>((limb[i / 64] >> (i % 64)) & 1);
+        }
+
+        F2P_CONSTEXPR void setbit(int i)
+        {
+            assert(i >= 0 && i < Bits);
+            limb[i / 64] |= UINT64_C(1) << (i % 64);
+        }
+
+/**
+ * coefficients of x^pos, ..., x^(pos + 63), pos can be negative.
+ */
+        F2P_CONSTEXPR uint64_t get_bits(int pos) const
+        {
+            if (pos <= -64) {
+                return 0;
+            }
+            if (pos < 0) {
+                return limb[0] << -pos;
+            }
+            int k = pos / 64;
+            int s = pos % 64;
+            uint64_t lo = k < size ? limb[k] : 0;
+            if (s == 0) {
+                return lo;
+            }
+            uint64_t hi = k + 1 < size ? limb[k + 1] : 0;
+            return (lo >> s) | (hi << (64 - s));
+        }
+
+/**
+ * this ^= w * x^pos, terms of degree Bits or more are discarded.
+ */
+        F2P_CONSTEXPR void xor_word(uint64_t w, int pos)
+        {
+            int k = pos / 64;
+            int s = pos % 64;
+            if (k < size) {
+                limb[k] ^= w << s;
+            }
+            if (s != 0 && k + 1 < size) {
+                limb[k + 1] ^= w >> (64 - s);
+            }
+        }
+
+        F2P_CONSTEXPR F2Poly& operator+=(const F2Poly& b)
+        {
+            for (int i = 0; i < size; i++) {
+                limb[i] ^= b.limb[i];
+            }
+            return *this;
+        }
+
+/**
+ * multiply by x^n, terms of degree Bits or more are discarded.
+ */
+        F2P_CONSTEXPR F2Poly& operator<<=(int n)
+        {
+            int k = n / 64;
+            int s = n % 64;
+            for (int i = size - 1; i >= 0; i--) {
+                uint64_t lo = i - k >= 0 ? limb[i - k] : 0;
+                uint64_t lo2 = i - k - 1 >= 0 ? limb[i - k - 1] : 0;
+                limb[i] = s == 0 ? lo : (lo << s) | (lo2 >> (64 - s));
+            }
+            mask_top();
+            return *this;
+        }
+
+/**
+ * divide by x^n, lower terms are discarded.
+ */
+        F2P_CONSTEXPR F2Poly& operator>>=(int n)
+        {
+            for (int i = 0; i < size; i++) {
+                limb[i] = get_bits(i * 64 + n);
+            }
+            return *this;
+        }
+
+        friend F2P_CONSTEXPR F2Poly operator+(F2Poly a, const F2Poly& b)
+        {
+            a += b;
+            return a;
+        }
+
+        friend F2P_CONSTEXPR F2Poly operator<<(F2Poly a, int n)
+        {
+            a <<= n;
+            return a;
+        }
+
+        friend F2P_CONSTEXPR F2Poly operator>>(F2Poly a, int n)
+        {
+            a >>= n;
+            return a;
+        }
+
+        friend F2P_CONSTEXPR bool operator==(const F2Poly& a, const F2Poly& b)
+        {
+            for (int i = 0; i < size; i++) {
+                if (a.limb[i] != b.limb[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        friend F2P_CONSTEXPR bool operator!=(const F2Poly& a, const F2Poly& b)
+        {
+            return !(a == b);
+        }
+
+/**
+ * same polynomial with B coefficients, higher terms are discarded.
+ */
+        template<int B>
+        F2P_CONSTEXPR F2Poly<B> resize() const
+        {
+            F2Poly<B> r;
+            for (int i = 0; i < F2Poly<B>::size && i < size; i++) {
+                r.limb[i] = limb[i];
+            }
+            r.mask_top();
+            return r;
+        }
+
+        void get_mpz(mpz_t z) const
+        {
+            mpz_import(z, static_cast<size_t>(size), -1, sizeof(uint64_t), 0, 0, limb.data());
+        }
+
+/**
+ * this = z, z should have at most Bits bits.
+ */
+        void set_mpz(mpz_srcptr z)
+        {
+            assert(mpz_sizeinbase(z, 2) <= static_cast<size_t>(Bits));
+            limb = std::array<uint64_t, size>();
+            mpz_export(limb.data(), nullptr, -1, sizeof(uint64_t), 0, 0, z);
+        }
+
+        static F2Poly from_mpz(mpz_srcptr z)
+        {
+            F2Poly r;
+            r.set_mpz(z);
+            return r;
+        }
+
+        F2P_CONSTEXPR void mask_top()
+        {
+            if (Bits % 64 != 0) {
+                limb[size - 1] &= (UINT64_C(1) << (Bits % 64)) - 1;
+            }
+        }
+    };
+
+/**
+ * a * b
+ */
+    template<int A, int B>
+    F2P_CONSTEXPR F2Poly<A + B - 1> mul(const F2Poly<A>& a,
+                                        const F2Poly<B>& b)
+    {
+        F2Poly<A + B - 1> r;
+        for (int i = 0; i < F2Poly<A>::size; i++) {
+            for (int j = 0; j < F2Poly<B>::size; j++) {
+                uint64_t hi = 0;
+                uint64_t lo = detail::clmul64(hi, a.limb[i], b.limb[j]);
+                r.xor_word(lo, (i + j) * 64);
+                r.xor_word(hi, (i + j + 1) * 64);
+            }
+        }
+        return r;
+    }
+
+/**
+ * a * a
+ */
+    template<int A>
+    F2P_CONSTEXPR F2Poly<2 * A - 1> square(const F2Poly<A>& a)
+    {
+        F2Poly<2 * A - 1> r;
+        for (int i = 0; i < F2Poly<A>::size; i++) {
+            r.xor_word(detail::spread32(a.limb[i] & 0xffffffffu), i * 128);
+            r.xor_word(detail::spread32(a.limb[i] >> 32), i * 128 + 64);
+        }
+        return r;
+    }
+
+/**
+ * a % m
+ *
+ * Each step computes up to 64 bits of quotient from the top words of
+ * a and m, like f2p_limb_divrem.
+ */
+    template<int A, int M>
+    F2P_CONSTEXPR F2Poly<M - 1> mod(const F2Poly<A>& a, const F2Poly<M>& m)
+    {
+        static_assert(M > 1, "modulus should have degree 1 or more");
+        int db = m.degree();
+        assert(db >= 0); // zero divide
+        F2Poly<A> r = a;
+        uint64_t bt = m.get_bits(db - 63);
+        int dr = r.degree();
+        while (dr >= db) {
+            int k = dr - db + 1 < 64 ? dr - db + 1 : 64;
+            uint64_t t = r.get_bits(dr - 63);
+            uint64_t q = 0;
+            for (int i = 0; i < k; i++) {
+                if ((t >> (63 - i)) & 1) {
+                    q |= UINT64_C(1) << (k - 1 - i);
+                    t ^= bt >> i;
+                }
+            }
+            int shift = dr - db - (k - 1);
+            for (int j = 0; j < F2Poly<M>::size; j++) {
+                uint64_t hi = 0;
+                uint64_t lo = detail::clmul64(hi, q, m.limb[j]);
+                r.xor_word(lo, j * 64 + shift);
+                r.xor_word(hi, j * 64 + 64 + shift);
+            }
+            dr = r.degree();
+        }
+        return r.template resize<M - 1>();
+    }
+
+/**
+ * residue class modulo a fixed polynomial
+ *
+ * Modulus is a type with static member degree and static function
+ * poly() returning F2Poly<degree + 1>, for example,
+ *@code
+ * struct TinyMTMod {
+ *     static constexpr int degree = 127;
+ *     static F2P_CONSTEXPR f2p::F2Poly<128> poly() {
+ *         return f2p::F2Poly<128>::from_hex("d8524022ed8dff4a8dcc50c798faba43");
+ *     }
+ * };
+ *@endcode
+ */
+    template<typename Modulus>
+    class F2PolyMod {
+    public:
+        static constexpr int degree = Modulus::degree;
+        static_assert(degree > 0, "degree of modulus should be positive");
+        typedef F2Poly<degree> poly_type;
+        typedef F2Poly<degree + 1> modulus_type;
+        poly_type value;
+
+        constexpr F2PolyMod() : value() {}
+
+        F2P_CONSTEXPR explicit F2PolyMod(const poly_type& v) : value(v) {}
+
+#if __cplusplus >= 201703L
+        static constexpr modulus_type modulus_value = Modulus::poly();
+
+        static constexpr const modulus_type& modulus()
+        {
+            return modulus_value;
+        }
+#else
+        static const modulus_type& modulus()
+        {
+            static const modulus_type m = Modulus::poly();
+            return m;
+        }
+#endif
+
+        template<int B>
+        static F2P_CONSTEXPR F2PolyMod reduce(const F2Poly<B>& a)
+        {
+            return F2PolyMod(mod(a, modulus()));
+        }
+
+        static F2P_CONSTEXPR F2PolyMod one()
+        {
+            return reduce(F2Poly<1>(1));
+        }
+
+        static F2P_CONSTEXPR F2PolyMod x()
+        {
+            return reduce(F2Poly<2>(2));
+        }
+
+        F2P_CONSTEXPR F2PolyMod& operator+=(const F2PolyMod& b)
+        {
+            value += b.value;
+            return *this;
+        }
+
+        F2P_CONSTEXPR F2PolyMod& operator*=(const F2PolyMod& b)
+        {
+            *this = reduce(mul(value, b.value));
+            return *this;
+        }
+
+        friend F2P_CONSTEXPR F2PolyMod operator+(F2PolyMod a,
+                                                 const F2PolyMod& b)
+        {
+            a += b;
+            return a;
+        }
+
+        friend F2P_CONSTEXPR F2PolyMod operator*(F2PolyMod a,
+                                                 const F2PolyMod& b)
+        {
+            a *= b;
+            return a;
+        }
+
+        friend F2P_CONSTEXPR bool operator==(const F2PolyMod& a,
+                                             const F2PolyMod& b)
+        {
+            return a.value == b.value;
+        }
+
+        friend F2P_CONSTEXPR bool operator!=(const F2PolyMod& a,
+                                             const F2PolyMod& b)
+        {
+            return a.value != b.value;
+        }
+
+        F2P_CONSTEXPR F2PolyMod square() const
+        {
+            return reduce(f2p::square(value));
+        }
+
+/**
+ * this^e, left to right binary method.
+ */
+        F2P_CONSTEXPR F2PolyMod pow(uint64_t e) const
+        {
+            F2PolyMod r = one();
+            for (int i = 63; i >= 0; i--) {
+                r = r.square();
+                if ((e >> i) & 1) {
+                    r *= *this;
+                }
+            }
+            return r;
+        }
+
+        F2PolyMod pow(mpz_srcptr e) const
+        {
+            F2PolyMod r = one();
+            for (long i = static_cast<long>(mpz_sizeinbase(e, 2)) - 1;
+                 i >= 0; i--) {
+                r = r.square();
+                if (mpz_tstbit(e, static_cast<mp_bitcnt_t>(i))) {
+                    r *= *this;
+                }
+            }
+            return r;
+        }
+    };
+}
+
+#endif // F2P_FIXED_HPP
@@ -3,6 +3,9 @@
  *
  * @brief Simple F2 Polynomial Library for GMP (GNU Multi-Precision Library).
  *
+ * f2p_mod, f2p_mulmod, f2p_gcd and f2p_is_irreducible_aux use
+ * functions of f2p_small.h when operands have degree less than 128.
+ *
  * @author Mutsuo Saito
  * @author Makoto Matsumoto (Hiroshima University)
  *
@@ -13,27 +16,122 @@
  * The MIT License is applied to this software, see
  * LICENSE.txt
  */
-
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
 #include "f2p_gmp.h"
 #include "debug_f2p.h"
+#include "f2p_limb.h"
+#include "f2p_small.h"
+#include "f2p_thread.h"
 #include <stdlib.h> // malloc
+#include <pthread.h>
+
+static void f2p_mul_inplace(mpz_t r, mpz_t b);
+static void f2p_mul_karatsuba(mpz_t r, mpz_t a, mpz_t b, f2p_wm_t *wm);
+static void f2p_mod_limbs(mpz_t a, mpz_t mod, mp_limb_t *tmp);
+
+#if defined(F2P_SMALL)
+/**
+ * get polynomial of degree less than 128.
+ *
+ *@param x result
+ *@param a polynomial
+ *@return 1 if a fits in two limbs, 0 otherwise
+ */
+static inline int f2p_small_get(f2p_u128 *x, mpz_srcptr a)
+{
+    if (mpz_size(a) > 2) {
+        return 0;
+    }
+    *x = ((f2p_u128)mpz_getlimbn(a, 1) << 64) | mpz_getlimbn(a, 0);
+    return 1;
+}
+
+/**
+ * set polynomial of degree less than 128.
+ *
+ *@param r result
+ *@param x polynomial
+ */
+static inline void f2p_small_set(mpz_ptr r, f2p_u128 x)
+{
+    mp_limb_t *d = mpz_limbs_write(r, 2);
+    d[0] = (mp_limb_t)x;
+    d[1] = (mp_limb_t)(x >> 64);
+    mpz_limbs_finish(r, 2);
+}
+#endif
+
+/**
+ * print message and abort when malloc fails.
+ * GMP also aborts when allocation fails.
+ */
+static void f2p_wm_alloc_failure(void)
+{
+    fprintf(stderr, "f2p_wm: cannot allocate working memory\n");
+    abort();
+}
 
-static void f2p_mul_aux(mpz_t r, mpz_t a, mpz_t b, int wp, f2p_wm_t *wm);
-static void f2p_mulmod_aux(mpz_t r, mpz_t a, mpz_t b, mpz_t mod,
-                           int wp, f2p_wm_t *wm);
+/**
+ * add one chunk of slots to working memory.
+ * Slots already allocated are not moved.
+ *
+ * @param wm working memory
+ */
+static void f2p_wm_add_chunk(f2p_wm_t *wm)
+{
+    int n = wm->num_chunks;
+    mpz_t **chunk = realloc(wm->chunk, (n + 1) * sizeof(mpz_t *));
+    if (chunk == NULL) {
+        f2p_wm_alloc_failure();
+    }
+    wm->chunk = chunk;
+    wm->chunk[n] = malloc(F2P_WM_CHUNK * sizeof(mpz_t));
+    if (wm->chunk[n] == NULL) {
+        f2p_wm_alloc_failure();
+    }
+    for (int i = 0; i < F2P_WM_CHUNK; i++) {
+        mpz_init2(wm->chunk[n][i], wm->bits);
+    }
+    wm->num_chunks = n + 1;
+    wm->max_size += F2P_WM_CHUNK;
+}
 
 /**
  * Initialization of (Shared) Working Memory
  *
+ * Working memory grows on demand, size is the number of slots
+ * allocated at first.
+ *
  * @param wm working memory
+ * @param size initial number of slots
  */
 void f2p_wm_init(f2p_wm_t *wm, int size)
 {
-    wm->max_size = size;
-    wm->ar = malloc(size * sizeof(mpz_t));
-    assert(wm->ar != NULL);
-    for (int i = 0; i < size; i++) {
-        mpz_init(wm->ar[i]);
+    f2p_wm_init2(wm, size, 0);
+}
+
+/**
+ * Initialization of (Shared) Working Memory with limb capacity
+ *
+ * Each slot has space for bits bits, so that operations on
+ * polynomials of degree about bits do not reallocate.
+ *
+ * @param wm working memory
+ * @param size initial number of slots
+ * @param bits initial capacity of each slot in bits
+ */
+void f2p_wm_init2(f2p_wm_t *wm, int size, mp_bitcnt_t bits)
+{
+    wm->max_size = 0;
+    wm->top = 0;
+    wm->high_water = 0;
+    wm->bits = bits;
+    wm->num_chunks = 0;
+    wm->chunk = NULL;
+    while (wm->max_size < size) {
+        f2p_wm_add_chunk(wm);
     }
 }
 
@@ -44,10 +142,179 @@ void f2p_wm_init(f2p_wm_t *wm, int size)
  */
 void f2p_wm_clear(f2p_wm_t *wm)
 {
-    for (int i = 0; i < wm->max_size; i++) {
-        mpz_clear(wm->ar[i]);
+    for (int i = 0; i < wm->num_chunks; i++) {
+        for (int j = 0; j < F2P_WM_CHUNK; j++) {
+            mpz_clear(wm->chunk[i][j]);
+        }
+        free(wm->chunk[i]);
+    }
+    free(wm->chunk);
+    wm->chunk = NULL;
+    wm->num_chunks = 0;
+    wm->max_size = 0;
+    wm->top = 0;
+}
+
+/**
+ * allocate one slot of working memory, growing working memory
+ * if all slots are in use.
+ *
+ * @param wm working memory
+ * @return pointer to the slot, valid until released.
+ */
+mpz_t * f2p_wm_grow(f2p_wm_t *wm)
+{
+    if (wm->top >= wm->max_size) {
+        f2p_wm_add_chunk(wm);
+    }
+    return f2p_wm_alloc(wm);
+}
+
+/**
+ * make capacity of free slots at least bits.
+ * New slots also have this capacity.
+ *
+ * @param wm working memory
+ * @param bits capacity in bits
+ */
+void f2p_wm_reserve(f2p_wm_t *wm, mp_bitcnt_t bits)
+{
+    if (bits <= wm->bits) {
+        return;
+    }
+    wm->bits = bits;
+    for (int i = wm->top; i < wm->max_size; i++) {
+        mpz_realloc2(wm->chunk[i / F2P_WM_CHUNK][i % F2P_WM_CHUNK], bits);
+    }
+}
+
+static pthread_key_t f2p_wm_key;
+static pthread_once_t f2p_wm_key_once = PTHREAD_ONCE_INIT;
+
+static void f2p_wm_thread_destroy(void *p)
+{
+    f2p_wm_t *wm = p;
+    f2p_wm_clear(wm);
+    free(wm);
+}
+
+static void f2p_wm_key_create(void)
+{
+    pthread_key_create(&f2p_wm_key, f2p_wm_thread_destroy);
+}
+
+/**
+ * working memory of the calling thread.
+ *
+ * The working memory is created at the first call in each thread,
+ * and kept until the thread exits or f2p_wm_thread_cleanup is called.
+ * Users should take slots in stack discipline by f2p_wm_mark and
+ * f2p_wm_release.
+ *
+ * @return working memory of the calling thread
+ */
+f2p_wm_t * f2p_wm_thread_local(void)
+{
+    pthread_once(&f2p_wm_key_once, f2p_wm_key_create);
+    f2p_wm_t *wm = pthread_getspecific(f2p_wm_key);
+    if (wm == NULL) {
+        wm = malloc(sizeof(f2p_wm_t));
+        if (wm == NULL) {
+            f2p_wm_alloc_failure();
+        }
+        f2p_wm_init(wm, F2P_WM_CHUNK);
+        pthread_setspecific(f2p_wm_key, wm);
     }
-    free(wm->ar);
+    return wm;
+}
+
+/**
+ * free working memory of the calling thread.
+ *
+ * Working memory is freed automatically when a thread exits by
+ * pthread_exit or returning from thread function, but not for the
+ * main thread. This function frees it explicitly.
+ */
+void f2p_wm_thread_cleanup(void)
+{
+    pthread_once(&f2p_wm_key_once, f2p_wm_key_create);
+    f2p_wm_t *wm = pthread_getspecific(f2p_wm_key);
+    if (wm != NULL) {
+        pthread_setspecific(f2p_wm_key, NULL);
+        f2p_wm_thread_destroy(wm);
+    }
+}
+
+static pthread_key_t f2p_control_key;
+static pthread_once_t f2p_control_key_once = PTHREAD_ONCE_INIT;
+
+static void f2p_control_key_create(void)
+{
+    pthread_key_create(&f2p_control_key, NULL);
+}
+
+/**
+ * set control of the calling thread.
+ *
+ *@param ctl control, or NULL to remove the control
+ */
+void f2p_control_set(f2p_control_t *ctl)
+{
+    pthread_once(&f2p_control_key_once, f2p_control_key_create);
+    pthread_setspecific(f2p_control_key, ctl);
+}
+
+/**
+ * get control of the calling thread.
+ *
+ *@return control, NULL if not set
+ */
+f2p_control_t *f2p_control_get(void)
+{
+    pthread_once(&f2p_control_key_once, f2p_control_key_create);
+    return pthread_getspecific(f2p_control_key);
+}
+
+/**
+ * store progress to the control of the calling thread.
+ *
+ * called once in each step of long loops.
+ *
+ *@param progress progress of the loop
+ *@return 1 if cancel is requested, 0 otherwise
+ */
+int f2p_control_poll(long progress)
+{
+    pthread_once(&f2p_control_key_once, f2p_control_key_create);
+    f2p_control_t *ctl = pthread_getspecific(f2p_control_key);
+    if (ctl == NULL) {
+        return 0;
+    }
+    __atomic_store_n(&ctl->progress, progress, __ATOMIC_RELAXED);
+    if (!f2p_control_cancelled(ctl)) {
+        return 0;
+    }
+    __atomic_store_n(&ctl->stopped, 1, __ATOMIC_RELAXED);
+    return 1;
+}
+
+/**
+ * check cancel of the control of the calling thread.
+ *
+ * same as f2p_control_poll but the progress is not changed, called
+ * in inner loops, e.g. the gcd in the squaring loop of
+ * f2p_is_irreducible_aux.
+ *
+ *@return 1 if cancel is requested, 0 otherwise
+ */
+int f2p_control_check(void)
+{
+    f2p_control_t *ctl = f2p_control_get();
+    if (ctl == NULL || !f2p_control_cancelled(ctl)) {
+        return 0;
+    }
+    __atomic_store_n(&ctl->stopped, 1, __ATOMIC_RELAXED);
+    return 1;
 }
 
 /**
@@ -57,19 +324,23 @@ void f2p_wm_clear(f2p_wm_t *wm)
  * use 1 wm
  * @param a dividend and result
  * @param b divisor
- * @param wp pointer of wm
  * @param wm shared working memory
  */
-//void f2p_mod(mpz_t r, mpz_t a, mpz_t b, int wp, f2p_wm_t *wm)
-void f2p_mod(mpz_t a, mpz_t b, int wp, f2p_wm_t *wm)
+//void f2p_mod(mpz_t r, mpz_t a, mpz_t b, f2p_wm_t *wm)
+void f2p_mod(mpz_t a, mpz_t b, f2p_wm_t *wm)
 {
     int zcmp = mpz_cmp_ui(b, 0);
     assert(zcmp != 0); // zero divide
+#if defined(F2P_SMALL)
+    f2p_u128 sa;
+    f2p_u128 sb;
+    if (f2p_small_get(&sa, a) && f2p_small_get(&sb, b)) {
+        f2p_small_set(a, f2p_small_mod(sa, sb));
+        return;
+    }
+#endif
     int deg = f2p_degree(b);
     int diff = f2p_degree(a) - deg;
-    //mpz_t *z = &wm[wp++];
-    mpz_t *x = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
     if (mpz_cmp_ui(b, 1) == 0) {
         mpz_set_ui(a, 0);
         return;
@@ -80,20 +351,10 @@ void f2p_mod(mpz_t a, mpz_t b, int wp, f2p_wm_t *wm)
         f2p_add(a, a, b);
         return;
     }
-    //mpz_set(*wz, a);
-    mpz_set(*x, b);
-    f2p_lshift(*x, diff);
-    f2p_add(a, a, *x);
-    int zdeg = f2p_degree(a);
-    PRT("a = ", a);
-    while (zdeg >= deg) {
-        f2p_rshift(*x, f2p_degree(*x) - zdeg);
-        f2p_add(a, a, *x);
-        PRT("a = ", a);
-        PRT("x = ", *x);
-        zdeg = f2p_degree(a);
-    }
-    //mpz_set(r, *wz);
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *tmp = mpz_limbs_write(*f2p_wm_alloc(wm), mpz_size(b) + 1);
+    f2p_mod_limbs(a, b, tmp);
+    f2p_wm_release(wm, mark);
 }
 
 /**
@@ -106,10 +367,9 @@ void f2p_mod(mpz_t a, mpz_t b, int wp, f2p_wm_t *wm)
  * @param r remainder
  * @param a dividend
  * @param b divisor
- * @param wp pointer of wm
  * @param wm shared working memory
  */
-void f2p_divrem(mpz_t q, mpz_t r, mpz_t a, mpz_t b, int wp, f2p_wm_t *wm)
+void f2p_divrem(mpz_t q, mpz_t r, mpz_t a, mpz_t b, f2p_wm_t *wm)
 {
     int zcmp = mpz_cmp_ui(b, 0);
     assert(zcmp != 0); // zero divide
@@ -134,10 +394,10 @@ void f2p_divrem(mpz_t q, mpz_t r, mpz_t a, mpz_t b, int wp, f2p_wm_t *wm)
         PUTS("out 2.5 f2p_divrem");
         return;
     }
-    mpz_t *x = &(wm->ar[wp++]);
-    mpz_t *qw = &(wm->ar[wp++]);
-    //mpz_t *rw = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_t *qw = f2p_wm_alloc(wm);
+    //mpz_t *rw = f2p_wm_alloc(wm);
 
     mpz_set_ui(*qw, 0);
     mpz_set(*x, b);
@@ -162,6 +422,7 @@ void f2p_divrem(mpz_t q, mpz_t r, mpz_t a, mpz_t b, int wp, f2p_wm_t *wm)
         PRT("qw = ", *qw);
     }
     mpz_set(q, *qw);
+    f2p_wm_release(wm, mark);
     PUTS("out 3 f2p_divrem");
     //mpz_set(r, *rw);
 }
@@ -169,111 +430,412 @@ void f2p_divrem(mpz_t q, mpz_t r, mpz_t a, mpz_t b, int wp, f2p_wm_t *wm)
 /**
  * Calculate r = a * b
  *
- * use 2 wm
+ * Large operands are multiplied by Karatsuba's method, and
+ * operands of F2P_MUL_PARALLEL_THRESHOLD limbs or more are
+ * multiplied in parallel using the executor of f2p_thread.h.
+ *
+ * use 3 wm + 3 wm for each parallel level
  *
  * @param r result
  * @param a polynomial
  * @param b polynomial
- * @param wp pointer of wm
  * @param wm shared working memory
  */
-void f2p_mul(mpz_t r, mpz_t a, mpz_t b, int wp, f2p_wm_t *wm)
+void f2p_mul(mpz_t r, mpz_t a, mpz_t b, f2p_wm_t *wm)
 {
-    if (f2p_degree(a) < f2p_degree(b)) {
-        f2p_mul_aux(r, b, a, wp, wm);
+    if ((int)mpz_size(a) >= F2P_KARATSUBA_THRESHOLD
+        && (int)mpz_size(b) >= F2P_KARATSUBA_THRESHOLD) {
+        f2p_mul_karatsuba(r, a, b, wm); // 3 wm
+        return;
+    }
+    if (r == a && r != b) {
+        f2p_mul_inplace(r, b);
+    } else if (r == b && r != a) {
+        f2p_mul_inplace(r, a);
+    } else if (r == a) {
+        int mark = f2p_wm_mark(wm);
+        mpz_t *x = f2p_wm_alloc(wm);
+        mpz_set_ui(*x, 0);
+        f2p_addmul(*x, a, b);
+        mpz_swap(r, *x);
+        f2p_wm_release(wm, mark);
     } else {
-        f2p_mul_aux(r, a, b, wp, wm);
+        mpz_set_ui(r, 0);
+        f2p_addmul(r, a, b);
     }
 }
 
 /**
- * Calculate r = a * b
+ * Calculate r ^= a * b
  *
- * use 2 wm
- * @param r result
+ * The product is accumulated directly into the limbs of r, no
+ * temporary is used.
+ *
+ * @param r result, should not be a nor b
  * @param a polynomial
  * @param b polynomial
- * @param wp pointer of wm
- * @param wm shared working memory
  */
-static void f2p_mul_aux(mpz_t r, mpz_t a, mpz_t b, int wp, f2p_wm_t *wm)
+void f2p_addmul(mpz_t r, mpz_t a, mpz_t b)
 {
-    mpz_t *v = &(wm->ar[wp++]);
-    mpz_t *w = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
-    mpz_set(*v, a);
-    mpz_set(*w, b);
-    mpz_set_ui(r, 0); // r should be set 0 after a is copy to v
-    mp_bitcnt_t bposmax = f2p_degree(*w);
-    mp_bitcnt_t bpos = 0;
-    while(bpos <= bposmax) {
-        if (f2p_coefficient(*w, bpos) == 1) {
-            f2p_add(r, r, *v);
+    assert(r != a && r != b);
+    int rn = mpz_size(r);
+    int an = mpz_size(a);
+    int bn = mpz_size(b);
+    if (an == 0 || bn == 0) {
+        return;
+    }
+    int n = rn > an + bn ? rn : an + bn;
+    mp_limb_t *rp = mpz_limbs_modify(r, n);
+    for (int i = rn; i < n; i++) {
+        rp[i] = 0;
+    }
+    const mp_limb_t *ap = mpz_limbs_read(a);
+    const mp_limb_t *bp = mpz_limbs_read(b);
+    for (int i = 0; i < an; i++) {
+        if (ap[i] == 0) {
+            continue;
+        }
+        for (int j = 0; j < bn; j++) {
+            mp_limb_t hi;
+            mp_limb_t lo = f2p_limb_clmul(&hi, ap[i], bp[j]);
+            rp[i + j] ^= lo;
+            rp[i + j + 1] ^= hi;
         }
-        bpos++;
-        f2p_lshift(*v, 1); // bottle neck
     }
+    mpz_limbs_finish(r, f2p_limb_normalize(rp, n));
 }
 
 /**
- * Calculate r = (a * b) % mod
+ * Calculate r = r * b
+ *
+ * Limbs of r are consumed from the top, so that the product can be
+ * written over r without a temporary.
+ *
+ * @param r polynomial and result, should not be b
+ * @param b polynomial
+ */
+static void f2p_mul_inplace(mpz_t r, mpz_t b)
+{
+    int rn = mpz_size(r);
+    int bn = mpz_size(b);
+    if (rn == 0) {
+        return;
+    }
+    if (bn == 0) {
+        mpz_set_ui(r, 0);
+        return;
+    }
+    int n = rn + bn;
+    mp_limb_t *rp = mpz_limbs_modify(r, n);
+    for (int i = rn; i < n; i++) {
+        rp[i] = 0;
+    }
+    const mp_limb_t *bp = mpz_limbs_read(b);
+    for (int i = rn - 1; i >= 0; i--) {
+        mp_limb_t x = rp[i];
+        rp[i] = 0;
+        if (x == 0) {
+            continue;
+        }
+        for (int j = 0; j < bn; j++) {
+            mp_limb_t hi;
+            mp_limb_t lo = f2p_limb_clmul(&hi, x, bp[j]);
+            rp[i + j] ^= lo;
+            rp[i + j + 1] ^= hi;
+        }
+    }
+    mpz_limbs_finish(r, f2p_limb_normalize(rp, n));
+}
+
+/**
+ * number of limbs of work space of karatsuba_limbs
+ *
+ *@param n number of limbs of operands
+ *@return number of limbs
+ */
+static int karatsuba_space(int n)
+{
+    int space = 0;
+    while (n >= F2P_KARATSUBA_THRESHOLD) {
+        n = n - n / 2;
+        space += 4 * n;
+    }
+    return space + 1;
+}
+
+/**
+ * r = a * b by Karatsuba's method
+ *
+ * a = a0 + a1 X, b = b0 + b1 X, and in F2[t]
+ * a * b = a0 b0 + (a0 b0 + a1 b1 + (a0 + a1)(b0 + b1)) X + a1 b1 X^2.
+ *
+ *@param r result of 2 * n limbs, must not overlap a or b
+ *@param a polynomial of n limbs
+ *@param b polynomial of n limbs
+ *@param n number of limbs
+ *@param tmp work space of karatsuba_space(n) limbs
+ */
+static void karatsuba_limbs(mp_limb_t *r, const mp_limb_t *a,
+                            const mp_limb_t *b, int n, mp_limb_t *tmp)
+{
+    if (n < F2P_KARATSUBA_THRESHOLD) {
+        f2p_limb_mul_basecase(r, a, n, b, n);
+        return;
+    }
+    int h = n / 2;
+    int l = n - h;
+    mp_limb_t *sa = tmp;
+    mp_limb_t *sb = sa + l;
+    mp_limb_t *m = sb + l;
+    karatsuba_limbs(r, a, b, l, tmp);
+    karatsuba_limbs(r + 2 * l, a + l, b + l, h, tmp);
+    for (int j = 0; j < l; j++) {
+        sa[j] = j < h ? a[j] ^ a[l + j] : a[j];
+        sb[j] = j < h ? b[j] ^ b[l + j] : b[j];
+    }
+    karatsuba_limbs(m, sa, sb, l, m + 2 * l);
+    for (int j = 0; j < 2 * h; j++) {
+        m[j] ^= r[j] ^ r[2 * l + j];
+    }
+    for (int j = 2 * h; j < 2 * l; j++) {
+        m[j] ^= r[j];
+    }
+    for (int j = 0; j < 2 * l; j++) {
+        r[l + j] ^= m[j];
+    }
+}
+
+struct F2P_MUL_TASK_T {
+    mp_limb_t *r;
+    const mp_limb_t *a;
+    const mp_limb_t *b;
+    int n;
+    int depth;
+};
+
+static void karatsuba_parallel(mp_limb_t *r, const mp_limb_t *a,
+                               const mp_limb_t *b, int n, int depth,
+                               f2p_wm_t *wm);
+
+/**
+ * sub-product run by the executor, work space is taken from the
+ * working memory of the worker, which is touched first by the
+ * worker.
+ */
+static void karatsuba_task(void *p)
+{
+    struct F2P_MUL_TASK_T *t = p;
+    karatsuba_parallel(t->r, t->a, t->b, t->n, t->depth,
+                       f2p_wm_thread_local());
+}
+
+/**
+ * r = a * b by Karatsuba's method, the three sub-products of the
+ * upper depth levels are computed in parallel.
  *
  * use 3 wm
  *
+ *@param r result of 2 * n limbs, must not overlap a or b
+ *@param a polynomial of n limbs
+ *@param b polynomial of n limbs
+ *@param n number of limbs
+ *@param depth levels of parallel recursion
+ *@param wm working memory of the calling thread
+ */
+static void karatsuba_parallel(mp_limb_t *r, const mp_limb_t *a,
+                               const mp_limb_t *b, int n, int depth,
+                               f2p_wm_t *wm)
+{
+    int mark = f2p_wm_mark(wm);
+    if (depth <= 0 || n < 2 * F2P_KARATSUBA_THRESHOLD) {
+        mp_limb_t *tmp = mpz_limbs_write(*f2p_wm_alloc(wm),
+                                         karatsuba_space(n));
+        karatsuba_limbs(r, a, b, n, tmp);
+        f2p_wm_release(wm, mark);
+        return;
+    }
+    int h = n / 2;
+    int l = n - h;
+    mp_limb_t *sa = mpz_limbs_write(*f2p_wm_alloc(wm), 2 * l);
+    mp_limb_t *sb = sa + l;
+    mp_limb_t *m = mpz_limbs_write(*f2p_wm_alloc(wm), 2 * l);
+    for (int j = 0; j < l; j++) {
+        sa[j] = j < h ? a[j] ^ a[l + j] : a[j];
+        sb[j] = j < h ? b[j] ^ b[l + j] : b[j];
+    }
+    struct F2P_MUL_TASK_T task[2] = {
+        {r, a, b, l, depth - 1},
+        {r + 2 * l, a + l, b + l, h, depth - 1}
+    };
+    f2p_task_group_t group;
+    f2p_task_group_init(&group);
+    f2p_task_submit(&group, karatsuba_task, &task[0]);
+    f2p_task_submit(&group, karatsuba_task, &task[1]);
+    karatsuba_parallel(m, sa, sb, l, depth - 1, wm); // 3 wm
+    f2p_task_group_wait(&group);
+    for (int j = 0; j < 2 * h; j++) {
+        m[j] ^= r[j] ^ r[2 * l + j];
+    }
+    for (int j = 2 * h; j < 2 * l; j++) {
+        m[j] ^= r[j];
+    }
+    for (int j = 0; j < 2 * l; j++) {
+        r[l + j] ^= m[j];
+    }
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * Calculate r = a * b by Karatsuba's method
+ *
+ * The longer operand is split into pieces of the size of the shorter
+ * one. Large products use the executor of f2p_thread.h.
+ *
+ * use 3 wm + 3 wm for each parallel level
+ *
  * @param r result
  * @param a polynomial
  * @param b polynomial
- * @param mod modulus polynomial
- * @param wp pointer of wm
  * @param wm shared working memory
  */
-void f2p_mulmod(mpz_t r, mpz_t a, mpz_t b, mpz_t mod, int wp, f2p_wm_t *wm)
+static void f2p_mul_karatsuba(mpz_t r, mpz_t a, mpz_t b, f2p_wm_t *wm)
 {
-    if (f2p_degree(a) < f2p_degree(b)) {
-        f2p_mulmod_aux(r, b, a, mod, wp, wm);
-    } else {
-        f2p_mulmod_aux(r, a, b, mod, wp, wm);
+    if (mpz_size(a) < mpz_size(b)) {
+        mpz_ptr t = a;
+        a = b;
+        b = t;
+    }
+    int an = mpz_size(a);
+    int bn = mpz_size(b);
+    int depth = 0;
+    if (bn >= F2P_MUL_PARALLEL_THRESHOLD) {
+        // 3^depth sub-products for executor of size threads
+        int size = f2p_executor_size();
+        for (int t = 1; t < 2 * size && size > 1; t *= 3) {
+            depth++;
+        }
+    }
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mp_limb_t *rp = mpz_limbs_write(*x, an + bn);
+    mp_limb_t *pad = mpz_limbs_write(*f2p_wm_alloc(wm), bn);
+    mp_limb_t *prod = mpz_limbs_write(*f2p_wm_alloc(wm), 2 * bn);
+    const mp_limb_t *ap = mpz_limbs_read(a);
+    const mp_limb_t *bp = mpz_limbs_read(b);
+    for (int j = 0; j < an + bn; j++) {
+        rp[j] = 0;
+    }
+    for (int i = 0; i < an; i += bn) {
+        const mp_limb_t *piece = ap + i;
+        if (an - i < bn) {
+            for (int j = 0; j < bn; j++) {
+                pad[j] = j < an - i ? ap[i + j] : 0;
+            }
+            piece = pad;
+        }
+        karatsuba_parallel(prod, piece, bp, bn, depth, wm);
+        for (int j = 0; j < 2 * bn && i + j < an + bn; j++) {
+            rp[i + j] ^= prod[j];
+        }
+    }
+    mpz_limbs_finish(*x, f2p_limb_normalize(rp, an + bn));
+    mpz_swap(r, *x);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * Calculate a %= mod in the limbs of a
+ *
+ * @param a dividend and result
+ * @param mod nonzero modulus polynomial
+ * @param tmp work space of mpz_size(mod) + 1 limbs
+ */
+static void f2p_mod_limbs(mpz_t a, mpz_t mod, mp_limb_t *tmp)
+{
+    int an = mpz_size(a);
+    if (an == 0) {
+        return;
     }
+    mp_limb_t *ap = mpz_limbs_modify(a, an);
+    an = f2p_limb_divrem(NULL, ap, an, mpz_limbs_read(mod), mpz_size(mod),
+                         tmp);
+    mpz_limbs_finish(a, an);
 }
 
 /**
  * Calculate r = (a * b) % mod
  *
- * use 3 wm
+ * use 5 wm + 3 wm for each parallel level
  *
  * @param r result
  * @param a polynomial
  * @param b polynomial
  * @param mod modulus polynomial
- * @param wp pointer of wm
  * @param wm shared working memory
  */
-static void f2p_mulmod_aux(mpz_t r, mpz_t a, mpz_t b, mpz_t mod,
-                           int wp, f2p_wm_t *wm)
+void f2p_mulmod(mpz_t r, mpz_t a, mpz_t b, mpz_t mod, f2p_wm_t *wm)
+{
+    if (r == b) {
+        // a * b = b * a
+        b = a;
+        a = r;
+    }
+    if (r != a) {
+        mpz_set(r, a);
+    }
+    f2p_mulmod_inplace(r, b, mod, wm); // 5 wm
+}
+
+/**
+ * Calculate r = (r * b) % mod
+ *
+ * The product and its residue are computed in the limbs of r. Operands
+ * of F2P_KARATSUBA_THRESHOLD limbs or more are multiplied by f2p_mul,
+ * so that large products use Karatsuba's method and the executor.
+ *
+ * use 5 wm + 3 wm for each parallel level
+ *
+ * @param r polynomial and result
+ * @param b polynomial
+ * @param mod modulus polynomial
+ * @param wm shared working memory
+ */
+void f2p_mulmod_inplace(mpz_t r, mpz_t b, mpz_t mod, f2p_wm_t *wm)
 {
-    //mp_bitcnt_t maxbits = mpz_sizeinbase(mod, 2);
     int zcmp = mpz_cmp_ui(mod, 0);
     assert(zcmp != 0); // zero divide
-    mpz_t *v = &(wm->ar[wp++]);
-    mpz_t *w = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
-    mpz_set(*v, a);
-    mpz_set(*w, b);
-    mpz_set_ui(r, 0); // r should be set 0 after a is copy to v
-    f2p_mod(*v, mod, wp, wm); // 1 wm
-    f2p_mod(*w, mod, wp, wm);
-    mp_bitcnt_t bposmax = mpz_sizeinbase(*w, 2) - 1;
-    mp_bitcnt_t bpos = 0;
-    while(bpos <= bposmax) {
-        if (f2p_coefficient(*w, bpos) == 1) {
-            f2p_add(r, r, *v);
-        }
-        bpos++;
-        f2p_lshift(*v, 1); // bottle neck
-        if (f2p_degree(*v) == f2p_degree(mod)) {
-            f2p_add(*v, *v, mod);
-        }
+#if defined(F2P_SMALL)
+    f2p_u128 sr;
+    f2p_u128 sb;
+    f2p_u128 sm;
+    if (f2p_small_get(&sm, mod) && f2p_small_get(&sr, r)
+        && f2p_small_get(&sb, b)) {
+        sr = f2p_small_mod(sr, sm);
+        sb = f2p_small_mod(sb, sm);
+        f2p_small_set(r, f2p_small_mulmod(sr, sb, sm));
+        return;
     }
+#endif
+    int mark = f2p_wm_mark(wm);
+    int deg = f2p_degree(mod);
+    mp_limb_t *tmp = mpz_limbs_write(*f2p_wm_alloc(wm), mpz_size(mod) + 1);
+    if (r == b || (int)f2p_degree(b) >= deg) {
+        mpz_t *x = f2p_wm_alloc(wm);
+        mpz_set(*x, b);
+        f2p_mod_limbs(*x, mod, tmp);
+        b = *x;
+    }
+    if ((int)f2p_degree(r) >= deg) {
+        f2p_mod_limbs(r, mod, tmp);
+    }
+    if ((int)mpz_size(r) >= F2P_KARATSUBA_THRESHOLD
+        && (int)mpz_size(b) >= F2P_KARATSUBA_THRESHOLD) {
+        f2p_mul(r, r, b, wm); // 3 wm
+    } else {
+        f2p_mul_inplace(r, b);
+    }
+    f2p_mod_limbs(r, mod, tmp);
+    f2p_wm_release(wm, mark);
 }
 
 /**
@@ -283,21 +845,18 @@ static void f2p_mulmod_aux(mpz_t r, mpz_t a, mpz_t b, mpz_t mod,
  *
  * @param r result
  * @param a polynomial
- * @param wp pointer of wm
  * @param wm shared working memory
  */
-void f2p_square(mpz_t r, mpz_t a, int wp, f2p_wm_t *wm)
+void f2p_square(mpz_t r, mpz_t a, f2p_wm_t *wm)
 {
-    mpz_t *x = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
-    mpz_set_ui(*x, 0);
-    int deg = f2p_degree(a);
-    for (int i = 0; i <= deg; i++) {
-        if (mpz_tstbit(a, i)) {
-            mpz_setbit(*x, 2 * i);
-        }
-    }
-    mpz_set(r, *x);
+    int an = mpz_size(a);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mp_limb_t *xp = mpz_limbs_write(*x, 2 * an + 1);
+    f2p_limb_sqr_basecase(xp, mpz_limbs_read(a), an);
+    mpz_limbs_finish(*x, f2p_limb_normalize(xp, 2 * an));
+    mpz_swap(r, *x);
+    f2p_wm_release(wm, mark);
 }
 
 #if 0
@@ -309,18 +868,18 @@ void f2p_square(mpz_t r, mpz_t a, int wp, f2p_wm_t *wm)
  * @param r result
  * @param a polynomial
  * @param mod modulus polynomial
- * @param wp pointer of wm
  * @param wm shared working memory
  */
-void f2p_pow2mod(mpz_t r, mpz_t a, mpz_t mod, int wp, f2p_wm_t *wm)
+void f2p_pow2mod(mpz_t r, mpz_t a, mpz_t mod, f2p_wm_t *wm)
 {
     int zcmp = mpz_cmp_ui(mod, 0);
     assert(zcmp != 0); // zero divide
-    mpz_t *x = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
-    f2p_square(*x, a, wp, wm); // 1 wm
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    f2p_square(*x, a, wm); // 1 wm
     mpz_set(r, *x);
-    f2p_mod(r, mod, wp, wm); // 1 wm
+    f2p_mod(r, mod, wm); // 1 wm
+    f2p_wm_release(wm, mark);
 }
 #elif 1
 /**
@@ -331,17 +890,16 @@ void f2p_pow2mod(mpz_t r, mpz_t a, mpz_t mod, int wp, f2p_wm_t *wm)
  * @param r result
  * @param a polynomial
  * @param mod modulus polynomial
- * @param wp pointer of wm
  * @param wm shared working memory
  */
-void f2p_pow2mod(mpz_t r, mpz_t a, mpz_t mod, int wp, f2p_wm_t *wm)
+void f2p_pow2mod(mpz_t r, mpz_t a, mpz_t mod, f2p_wm_t *wm)
 {
     int zcmp = mpz_cmp_ui(mod, 0);
     assert(zcmp != 0); // zero divide
     mpz_set(r, a);
-    f2p_mod(r, mod, wp, wm); // 1 wm
-    f2p_square(r, r, wp, wm); // 1 wm
-    f2p_mod(r, mod, wp, wm); // 1 wm
+    f2p_mod(r, mod, wm); // 1 wm
+    f2p_square(r, r, wm); // 1 wm
+    f2p_mod(r, mod, wm); // 1 wm
 }
 #else
 /**
@@ -352,22 +910,21 @@ void f2p_pow2mod(mpz_t r, mpz_t a, mpz_t mod, int wp, f2p_wm_t *wm)
  * @param r result
  * @param a polynomial
  * @param mod modulus polynomial
- * @param wp pointer of wm
  * @param wm shared working memory
  */
-void f2p_pow2mod(mpz_t r, mpz_t a, mpz_t mod, int wp, f2p_wm_t *wm)
+void f2p_pow2mod(mpz_t r, mpz_t a, mpz_t mod, f2p_wm_t *wm)
 {
     int zcmp = mpz_cmp_ui(mod, 0);
     assert(zcmp != 0); // zero divide
     mp_bitcnt_t bpos = 0;
     mp_bitcnt_t bposmax = f2p_degree(a);
-    mpz_t *b = &(wm->ar[wp++]);
-    mpz_t *v = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *b = f2p_wm_alloc(wm);
+    mpz_t *v = f2p_wm_alloc(wm);
     mpz_set(*b, a);
     mpz_set(*v, a);
     mpz_set_ui(r, 0); // r should be set 0 after a is copied.
-    f2p_mod(*v, mod, wp, wm); // 1 wm
+    f2p_mod(*v, mod, wm); // 1 wm
     while(bpos <= bposmax) {
         if (f2p_coefficient(*b, bpos) == 1) {
             f2p_add(r, r, *v);
@@ -378,40 +935,44 @@ void f2p_pow2mod(mpz_t r, mpz_t a, mpz_t mod, int wp, f2p_wm_t *wm)
             f2p_add(*v, *v, mod);
         }
     }
+    f2p_wm_release(wm, mark);
 }
 #endif
 
 /**
  * calculate r = x^e % mod.
  *
- * use 4 wm
+ * use 6 wm + 3 wm for each parallel level
  *
  * @param r residue polynomial whose degree is less than mod polynomial
  * @param x polynomial
  * @param e exponent (big integer)
  * @param mod polynomial
- * @param wp pointer of wm
  * @param wm shared working memory
  */
-void f2p_powermod(mpz_t r, mpz_t x, mpz_t e, mpz_t mod, int wp, f2p_wm_t *wm)
+void f2p_powermod(mpz_t r, mpz_t x, mpz_t e, mpz_t mod, f2p_wm_t *wm)
 {
     int zcmp = mpz_cmp_ui(mod, 0);
     assert(zcmp != 0); // zero divide
-    mpz_t *s = &(wm->ar[wp++]);
-    //mpz_t *z = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *s = f2p_wm_alloc(wm);
+    //mpz_t *z = f2p_wm_alloc(wm);
     mpz_set(*s, x);
     //mpz_set_ui(*z, 1);
     mpz_set_ui(r, 1);
     mp_bitcnt_t bposmax = mpz_sizeinbase(e, 2) - 1;
     mp_bitcnt_t bpos = 0;
     while (bpos <= bposmax) {
+        if (f2p_control_poll((long)bpos)) {
+            break;
+        }
         if (mpz_tstbit(e, bpos) == 1) {
-            f2p_mulmod(r, r, *s, mod, wp, wm); // 3 wm
+            f2p_mulmod(r, r, *s, mod, wm); // 5 wm
         }
-        f2p_pow2mod(*s, *s, mod, wp, wm); // 1 wm
+        f2p_pow2mod(*s, *s, mod, wm); // 1 wm
         bpos++;
     }
+    f2p_wm_release(wm, mark);
     //mpz_set(r, *z);
 }
 
@@ -423,19 +984,20 @@ void f2p_powermod(mpz_t r, mpz_t x, mpz_t e, mpz_t mod, int wp, f2p_wm_t *wm)
  * @param r residue polynomial whose degree is less than mod polynomial
  * @param e exponent (big integer)
  * @param mod polynomial
- * @param wp pointer of wm
  * @param wm shared working memory
  */
-void f2p_Tpowermod(mpz_t r, mpz_t e, mpz_t mod, int wp, f2p_wm_t *wm)
+void f2p_Tpowermod(mpz_t r, mpz_t e, mpz_t mod, f2p_wm_t *wm)
 {
     int zcmp = mpz_cmp_ui(mod, 0);
     assert(zcmp != 0); // zero divide
-    mpz_t *len = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *len = f2p_wm_alloc(wm);
     mpz_set(*len, e);
     mp_bitcnt_t mdeg = f2p_degree(mod);
     if (mpz_cmp_ui(*len, mdeg) < 0) {
+        mpz_set_ui(r, 0);
         mpz_setbit(r, mpz_get_ui(*len));
+        f2p_wm_release(wm, mark);
         return;
     }
     mpz_set(r, mod);
@@ -449,6 +1011,7 @@ void f2p_Tpowermod(mpz_t r, mpz_t e, mpz_t mod, int wp, f2p_wm_t *wm)
         f2p_lshift(r, diff);
         mpz_sub_ui(*len, *len, diff);
     }
+    f2p_wm_release(wm, mark);
     // return r;
 }
 
@@ -458,37 +1021,33 @@ void f2p_Tpowermod(mpz_t r, mpz_t e, mpz_t mod, int wp, f2p_wm_t *wm)
  * calculate a, b, c for given x, y
  * where a*x + b*y = c (c = GCD(x, y))
  *
- * use 13 wm
+ * use 10 wm
  *
  *@param a result polynomial
  *@param b result polynomial
  *@param c result polynomial GCD(x, y)
  *@param x input polynomial
  *@param y input polynomial
- *@param wp
  *@param wm
  */
 void f2p_exeuclid(mpz_t a, mpz_t b, mpz_t c, mpz_t x, mpz_t y,
-                  int wp, f2p_wm_t *wm)
+                  f2p_wm_t *wm)
 {
     PUTS("f2p_exeuclid start\n");
     int zcmp = mpz_cmp_ui(x, 0);
     assert(zcmp != 0);
     zcmp = mpz_cmp_ui(y, 0);
     assert(zcmp != 0);
-    mpz_t *q1 = &(wm->ar[wp++]);
-    mpz_t *r0 = &(wm->ar[wp++]);
-    mpz_t *r1 = &(wm->ar[wp++]);
-    mpz_t *r2 = &(wm->ar[wp++]);
-    mpz_t *a0 = &(wm->ar[wp++]);
-    mpz_t *a1 = &(wm->ar[wp++]);
-    mpz_t *a2 = &(wm->ar[wp++]);
-    mpz_t *b0 = &(wm->ar[wp++]);
-    mpz_t *b1 = &(wm->ar[wp++]);
-    mpz_t *b2 = &(wm->ar[wp++]);
-    mpz_t *tmp = &(wm->ar[wp++]);
-    //mpz_t *t; 後で使う
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *q1 = f2p_wm_alloc(wm);
+    mpz_t *r0 = f2p_wm_alloc(wm);
+    mpz_t *r1 = f2p_wm_alloc(wm);
+    mpz_t *r2 = f2p_wm_alloc(wm);
+    mpz_t *a0 = f2p_wm_alloc(wm);
+    mpz_t *a1 = f2p_wm_alloc(wm);
+    mpz_t *b0 = f2p_wm_alloc(wm);
+    mpz_t *b1 = f2p_wm_alloc(wm);
+    mpz_t *t;
     PRT("x= ", x);
     PRT("y= ", y);
     mpz_set(*r0, x);
@@ -504,31 +1063,32 @@ void f2p_exeuclid(mpz_t a, mpz_t b, mpz_t c, mpz_t x, mpz_t y,
     PRT("b0 = ", *b0);
     PRT("b1 = ", *b1);
     while (mpz_cmp_ui(*r1, 0) > 0) {
+        if (f2p_control_poll(f2p_degree(*r1))) {
+            break;
+        }
         PUTS("f2p_divrem\n");
-        f2p_divrem(*q1, *r2, *r0, *r1, wp, wm); // 2 wm
-        PUTS("f2p_mul\n");
-        f2p_mul(*tmp, *q1, *a1, wp, wm); // 2 wm
-        PUTS("f2p_add\n");
-        f2p_add(*a2, *a0, *tmp);
-        PUTS("f2p_mul\n");
-        f2p_mul(*tmp, *q1, *b1, wp, wm);// 2 wm
-        PUTS("f2p_add\n");
-        f2p_add(*b2, *b0, *tmp);
+        f2p_divrem(*q1, *r2, *r0, *r1, wm); // 2 wm
+        PUTS("f2p_addmul\n");
+        f2p_addmul(*a0, *q1, *a1); // a2 = a0 + q1 * a1
+        PUTS("f2p_addmul\n");
+        f2p_addmul(*b0, *q1, *b1); // b2 = b0 + q1 * b1
         PRT("r0 = ", *r0);
         PRT("r1 = ", *r1);
         PRT("r2 = ", *r2);
-        PRT("a0 = ", *a0);
         PRT("a1 = ", *a1);
-        PRT("a2 = ", *a2);
-        PRT("b0 = ", *b0);
+        PRT("a2 = ", *a0);
         PRT("b1 = ", *b1);
-        PRT("b2 = ", *b2);
-        mpz_set(*r0, *r1);
-        mpz_set(*r1, *r2);
-        mpz_set(*a0, *a1);
-        mpz_set(*a1, *a2);
-        mpz_set(*b0, *b1);
-        mpz_set(*b1, *b2);
+        PRT("b2 = ", *b0);
+        t = r0;
+        r0 = r1;
+        r1 = r2;
+        r2 = t;
+        t = a0;
+        a0 = a1;
+        a1 = t;
+        t = b0;
+        b0 = b1;
+        b1 = t;
         PUTS("loop last\n");
     }
     PUTS("loop end\n");
@@ -538,6 +1098,7 @@ void f2p_exeuclid(mpz_t a, mpz_t b, mpz_t c, mpz_t x, mpz_t y,
     mpz_set(b, *b0);
     PRT("r0 = ", *r0);
     mpz_set(c, *r0);
+    f2p_wm_release(wm, mark);
     PUTS("f2p_exeuclid end\n");
 }
 
@@ -546,7 +1107,7 @@ void f2p_exeuclid(mpz_t a, mpz_t b, mpz_t c, mpz_t x, mpz_t y,
  * calculate a, b, c for given x, y
  * where a*x + b*y = c (c = GCD(x, y))
  *
- * use 10 wm
+ * use 8 wm
  *
  *@see https://planetmath.org/berlekampmasseyalgorithm
  *
@@ -555,13 +1116,12 @@ void f2p_exeuclid(mpz_t a, mpz_t b, mpz_t c, mpz_t x, mpz_t y,
  *@param x input polynomial
  *@param y input polynomial
  *@param m max degree
- *@param wp
  *@param wm
  */
 //void f2p_exeuclid2(mpz_t a, mpz_t b, mpz_t c, mpz_t x, mpz_t y, int m,
-//                  int wp, f2p_wm_t *wm)
+//                  f2p_wm_t *wm)
 void f2p_exeuclid2(mpz_t a, mpz_t c, mpz_t x, mpz_t y, int m,
-                   int wp, f2p_wm_t *wm)
+                   f2p_wm_t *wm)
 {
     PUTS("f2p_exeuclid2 start\n");
     //mp_bitcnt_t max_deg = m;
@@ -569,19 +1129,16 @@ void f2p_exeuclid2(mpz_t a, mpz_t c, mpz_t x, mpz_t y, int m,
     assert(zcmp != 0);
     zcmp = mpz_cmp_ui(y, 0);
     assert(zcmp != 0);
-    mpz_t *q1 = &(wm->ar[wp++]);
-    mpz_t *r0 = &(wm->ar[wp++]);
-    mpz_t *r1 = &(wm->ar[wp++]);
-    mpz_t *r2 = &(wm->ar[wp++]);
-    mpz_t *a0 = &(wm->ar[wp++]);
-    mpz_t *a1 = &(wm->ar[wp++]);
-    mpz_t *a2 = &(wm->ar[wp++]);
-    //mpz_t *b0 = &(wm->ar[wp++]);
-    //mpz_t *b1 = &(wm->ar[wp++]);
-    //mpz_t *b2 = &(wm->ar[wp++]);
-    mpz_t *tmp = &(wm->ar[wp++]);
-    //mpz_t *t; 後で使う
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *q1 = f2p_wm_alloc(wm);
+    mpz_t *r0 = f2p_wm_alloc(wm);
+    mpz_t *r1 = f2p_wm_alloc(wm);
+    mpz_t *r2 = f2p_wm_alloc(wm);
+    mpz_t *a0 = f2p_wm_alloc(wm);
+    mpz_t *a1 = f2p_wm_alloc(wm);
+    //mpz_t *b0 = f2p_wm_alloc(wm);
+    //mpz_t *b1 = f2p_wm_alloc(wm);
+    mpz_t *t;
     PRT("x= ", x);
     PRT("y= ", y);
     mpz_set(*r0, x);
@@ -600,34 +1157,30 @@ void f2p_exeuclid2(mpz_t a, mpz_t c, mpz_t x, mpz_t y, int m,
     for (;;) {
         //while (mpz_cmp_ui(*r1, 0) > 0) {
         PUTS("f2p_divrem\n");
-        f2p_divrem(*q1, *r2, *r0, *r1, wp, wm); // 2 wm
-        PUTS("f2p_mul\n");
-        f2p_mul(*tmp, *q1, *a1, wp, wm); // 2 wm
-        PUTS("f2p_add\n");
-        f2p_add(*a2, *a0, *tmp);
-        PUTS("f2p_mul\n");
-        //f2p_mul(*tmp, *q1, *b1, wp, wm);// 2 wm
-        //PUTS("f2p_add\n");
-        //f2p_add(*b2, *b0, *tmp);
+        f2p_divrem(*q1, *r2, *r0, *r1, wm); // 2 wm
+        PUTS("f2p_addmul\n");
+        f2p_addmul(*a0, *q1, *a1); // a2 = a0 + q1 * a1
+        //f2p_addmul(*b0, *q1, *b1);
         PRT("q1 = ", *q1);
-        PRT("tmp = ", *tmp);
         PRT("r0 = ", *r0);
         PRT("r1 = ", *r1);
         PRT("r2 = ", *r2);
-        PRT("a0 = ", *a0);
         PRT("a1 = ", *a1);
-        PRT("a2 = ", *a2);
+        PRT("a2 = ", *a0);
         //PRT("b0 = ", *b0);
         //PRT("b1 = ", *b1);
         //PRT("b2 = ", *b2);
         int dr = f2p_degree(*r2);
-        if (dr < m) {
+        if (dr < m || f2p_control_poll(dr)) {
             break;
         }
-        mpz_set(*r0, *r1);
-        mpz_set(*r1, *r2);
-        mpz_set(*a0, *a1);
-        mpz_set(*a1, *a2);
+        t = r0;
+        r0 = r1;
+        r1 = r2;
+        r2 = t;
+        t = a0;
+        a0 = a1;
+        a1 = t;
         //mpz_set(*b0, *b1);
         //mpz_set(*b1, *b2);
         //int da = f2p_degree(*a0);
@@ -639,12 +1192,13 @@ void f2p_exeuclid2(mpz_t a, mpz_t c, mpz_t x, mpz_t y, int m,
         PUTS("loop last\n");
     }
     PUTS("loop end\n");
-    PRT("a2 = ", *a2);
-    mpz_set(a, *a2);
+    PRT("a2 = ", *a0);
+    mpz_set(a, *a0);
     //PRT("b2 = ", *b2);
     //mpz_set(b, *b2);
     PRT("r2 = ", *r2);
     mpz_set(c, *r2);
+    f2p_wm_release(wm, mark);
     PUTS("f2p_exeuclid2 end\n");
 }
 
@@ -653,13 +1207,12 @@ void f2p_minpoly(char * minpoly, f2rng gen, int mexp)
 {
     PUTS("minpoly start\n");
     f2p_wm_t wm;
-    int wp = 0;
     f2p_wm_init(&wm, 20);
-    mpz_t *poly = &(wm.ar[wp++]);
-    mpz_t *seq = &(wm.ar[wp++]);
-    //mpz_t *b = &(wm.ar[wp++]);
-    mpz_t *c = &(wm.ar[wp++]);
-    mpz_t *x2t = &(wm.ar[wp++]);
+    mpz_t *poly = f2p_wm_alloc(&wm);
+    mpz_t *seq = f2p_wm_alloc(&wm);
+    //mpz_t *b = f2p_wm_alloc(&wm);
+    mpz_t *c = f2p_wm_alloc(&wm);
+    mpz_t *x2t = f2p_wm_alloc(&wm);
     mpz_setbit(*x2t, 2 * mexp);
     //mpz_realloc2(*seq, 2 * mexp);
     //mpz_setbit(*x2t, 0);
@@ -673,8 +1226,8 @@ void f2p_minpoly(char * minpoly, f2rng gen, int mexp)
         }
     }
     PRT("seq = ", *seq);
-    //f2p_exeuclid2(*poly, *b, *c, *seq, *x2t, mexp, wp, &wm); // 13 wm
-    f2p_exeuclid2(*poly, *c, *seq, *x2t, mexp, wp, &wm); // 13 wm
+    //f2p_exeuclid2(*poly, *b, *c, *seq, *x2t, mexp, &wm); // 13 wm
+    f2p_exeuclid2(*poly, *c, *seq, *x2t, mexp, &wm); // 13 wm
     PRT("poly = ", *poly);
     //PRT("b = ", *b);
     PRT("c = ", *c);
@@ -690,26 +1243,36 @@ void f2p_minpoly(char * minpoly, f2rng gen, int mexp)
  * gcd
  * calculate gcd(x, y)
  *
+ * The result is undefined if the loop is stopped by cancel of the
+ * control of the calling thread.
+ *
  * use 5 wm
  *
  *@param gcd result polynomial
  *@param x input polynomial
  *@param y input polynomial
- *@param wp
  *@param wm
  */
-void f2p_gcd(mpz_t gcd, mpz_t x, mpz_t y, int wp, f2p_wm_t *wm)
+void f2p_gcd(mpz_t gcd, mpz_t x, mpz_t y, f2p_wm_t *wm)
 {
     PUTS("f2p_gcd start\n");
     int zcmp = mpz_cmp_ui(x, 0);
     assert(zcmp != 0);
     zcmp = mpz_cmp_ui(y, 0);
     assert(zcmp != 0);
-    mpz_t *r0 = &(wm->ar[wp++]);
-    mpz_t *r1 = &(wm->ar[wp++]);
-    mpz_t *r2 = &(wm->ar[wp++]);
+#if defined(F2P_SMALL)
+    f2p_u128 sx;
+    f2p_u128 sy;
+    if (f2p_small_get(&sx, x) && f2p_small_get(&sy, y)) {
+        f2p_small_set(gcd, f2p_small_gcd(sx, sy));
+        return;
+    }
+#endif
+    int mark = f2p_wm_mark(wm);
+    mpz_t *r0 = f2p_wm_alloc(wm);
+    mpz_t *r1 = f2p_wm_alloc(wm);
+    mpz_t *r2 = f2p_wm_alloc(wm);
     //mpz_t *t; 後で使う
-    assert(wp <= wm->max_size);
     PRT("x= ", x);
     PRT("y= ", y);
     mpz_set(*r0, x);
@@ -717,10 +1280,13 @@ void f2p_gcd(mpz_t gcd, mpz_t x, mpz_t y, int wp, f2p_wm_t *wm)
     PRT("r0 = ", *r0);
     PRT("r1 = ", *r1);
     while (mpz_cmp_ui(*r1, 0) > 0) {
+        if (f2p_control_check()) {
+            break;
+        }
         PUTS("f2p_mod\n");
         mpz_set(*r2, *r0);
-        //f2p_mod(*r2, *r0, *r1, wp, wm); // 1 wm
-        f2p_mod(*r2, *r1, wp, wm); // 1 wm
+        //f2p_mod(*r2, *r0, *r1, wm); // 1 wm
+        f2p_mod(*r2, *r1, wm); // 1 wm
         PRT("r0 = ", *r0);
         PRT("r1 = ", *r1);
         //mpz_swap(*r0, *r1);
@@ -731,6 +1297,7 @@ void f2p_gcd(mpz_t gcd, mpz_t x, mpz_t y, int wp, f2p_wm_t *wm)
     PUTS("loop end\n");
     PRT("r0 = ", *r0);
     mpz_set(gcd, *r0);
+    f2p_wm_release(wm, mark);
     PUTS("f2p_gcd end\n");
 
 }
@@ -741,39 +1308,55 @@ void f2p_gcd(mpz_t gcd, mpz_t x, mpz_t y, int wp, f2p_wm_t *wm)
  * use 8 wm
  *
  *@param poly input polynomial
- *@param wp
  *@param wm
  *@reaturns 1 irreducible, 0 reducible
  */
-int f2p_is_irreducible_aux(mpz_t poly, int wp, f2p_wm_t * wm)
+int f2p_is_irreducible_aux(mpz_t poly, f2p_wm_t *wm)
 {
     PUTS("f2p_is_irreducible_aux start\n");
+#if defined(F2P_SMALL)
+    f2p_u128 sp;
+    if (f2p_small_get(&sp, poly)) {
+        return f2p_small_is_irreducible(sp);
+    }
+#endif
     if (mpz_cmp_ui(poly, 0) == 0) {
         return 0;
     }
     if (mpz_cmp_ui(poly, 2) == 0 || mpz_cmp_ui(poly, 3) == 0) {
         return 1;
     }
-    mpz_t *t2m = &(wm->ar[wp++]);
-    mpz_t *t1 = &(wm->ar[wp++]);
-    mpz_t *t = &(wm->ar[wp++]);
-    mpz_t *work = &(wm->ar[wp++]);
-    mpz_setbit(*t2m, 2); // t^2m
-    mpz_setbit(*t1, 1);  // t^1
+    int mark = f2p_wm_mark(wm);
+    mpz_t *t2m = f2p_wm_alloc(wm);
+    mpz_t *t1 = f2p_wm_alloc(wm);
+    mpz_t *t = f2p_wm_alloc(wm);
+    mpz_t *work = f2p_wm_alloc(wm);
+    mpz_set_ui(*t2m, 4); // t^2m
+    mpz_set_ui(*t1, 2);  // t^1
     int degpol = f2p_degree(poly);
     int result = 1;
     f2p_add(*t, *t2m, *t1);
     for (int m = 1; m <= degpol / 2; m++) {
-        f2p_gcd(*work, poly, *t, wp, wm); // 4 wm
+        if (f2p_control_poll(m)) {
+            result = 0;
+            break;
+        }
+        // t^2m - t = 0 if all factors have degree dividing m
+        if (mpz_cmp_ui(*t, 0) == 0) {
+            result = 0;
+            break;
+        }
+        f2p_gcd(*work, poly, *t, wm); // 4 wm
         if (mpz_cmp_ui(*work, 1) != 0) {
             result = 0;
             break;
         }
-        //f2p_square(*t2m, *t2m, wp, wm); // 1 wm
-        //f2p_mod(*t2m, poly, wp, wm); // 1 wm
-        f2p_pow2mod(*t2m, *t2m, poly, wp, wm); // 1 wm
+        //f2p_square(*t2m, *t2m, wm); // 1 wm
+        //f2p_mod(*t2m, poly, wm); // 1 wm
+        f2p_pow2mod(*t2m, *t2m, poly, wm); // 1 wm
         f2p_add(*t, *t2m, *t1);
     }
+    f2p_wm_release(wm, mark);
     PUTS("f2p_is_irreducible_aux end\n");
     return result;
 }
@@ -783,11 +1366,10 @@ int f2p_is_irreducible(const char * poly)
 {
     PUTS("f2p_is_irreducible start\n");
     f2p_wm_t wm;
-    int wp = 0;
     f2p_wm_init(&wm, 10);
-    mpz_t *pol = &(wm.ar[wp++]);
+    mpz_t *pol = f2p_wm_alloc(&wm);
     f2p_set_hexstr(*pol, poly);
-    int result = f2p_is_irreducible_aux(pol, wp, &wm);
+    int result = f2p_is_irreducible_aux(pol, &wm);
     f2p_wm_clear(&wm);
     PUTS("f2p_is_irreducible end\n");
     return result;
@@ -798,43 +1380,63 @@ int f2p_is_irreducible(const char * poly)
  * minimal polynomial of a linear recurrence sequence.
  *
  * sequence length len shoud be len >= 2 * maxdeg.
+ * If seq is zero sequence, minpoly is set to 1.
+ *
+ * use 13 wm
  *
  *@param minpoly
  *@param seq linear recurrence sequence
  *@param maxdeg supporsed max degree of minpoly
+ *@param wm
  */
-void f2p_minpoly(mpz_t minpoly, mpz_t seq, int maxdeg)
+void f2p_minpoly_aux(mpz_t minpoly, mpz_t seq, int maxdeg,
+                     f2p_wm_t *wm)
 {
-    PUTS("minpoly start\n");
-    f2p_wm_t wm;
-    int wp = 0;
-    f2p_wm_init(&wm, 16);
-    //mpz_t *poly = &(wm.ar[wp++]);
-    mpz_t *rseq = &(wm.ar[wp++]);
-    //mpz_t *b = &(wm.ar[wp++]);
-    mpz_t *c = &(wm.ar[wp++]);
-    mpz_t *x2t = &(wm.ar[wp++]);
+    PUTS("minpoly_aux start\n");
+    int mark = f2p_wm_mark(wm);
+    mpz_t *rseq = f2p_wm_alloc(wm);
+    mpz_t *c = f2p_wm_alloc(wm);
+    mpz_t *x2t = f2p_wm_alloc(wm);
+    mpz_set_ui(*rseq, 0);
+    mpz_set_ui(*x2t, 0);
     mpz_setbit(*x2t, 2 * maxdeg); // x^{2*maxdeg}
-    //mpz_realloc2(*seq, 2 * maxdeg);
-    //mpz_setbit(*x2t, 0);
-//    for (int i = 0; i < 2 * maxdeg; i++) {
     for (int i = 0; i < 2 * maxdeg; i++) {
         if (mpz_tstbit(seq, i)) {
             mpz_setbit(*rseq, 2 * maxdeg - 1 - i);
-        } else {
-            mpz_clrbit(*rseq, 2 * maxdeg - 1 - i);
         }
     }
     PRT("rseq = ", *rseq);
-    //f2p_exeuclid2(*poly, *b, *c, *seq, *x2t, maxdeg, wp, &wm); // 13 wm
-    f2p_exeuclid2(minpoly, *c, *rseq, *x2t, maxdeg, wp, &wm); // 13 wm
+    if (mpz_cmp_ui(*rseq, 0) == 0) {
+        mpz_set_ui(minpoly, 1);
+        f2p_wm_release(wm, mark);
+        return;
+    }
+    f2p_exeuclid2(minpoly, *c, *rseq, *x2t, maxdeg, wm); // 10 wm
     PRT("poly = ", minpoly);
-    //PRT("b = ", *b);
     PRT("c = ", *c);
     PRT("seq = ", seq);
     PRT("x2t = ", *x2t);
-    //f2p_get_hexstr(minpoly, *poly);
-    f2p_wm_clear(&wm);
+    f2p_wm_release(wm, mark);
+    PUTS("minpoly_aux end\n");
+}
+
+/**
+ * minimal polynomial of a linear recurrence sequence.
+ *
+ * sequence length len shoud be len >= 2 * maxdeg.
+ *
+ *@param minpoly
+ *@param seq linear recurrence sequence
+ *@param maxdeg supporsed max degree of minpoly
+ */
+void f2p_minpoly(mpz_t minpoly, mpz_t seq, int maxdeg)
+{
+    PUTS("minpoly start\n");
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    f2p_wm_reserve(wm, 2 * maxdeg + 2 * GMP_NUMB_BITS);
+    f2p_minpoly_aux(minpoly, seq, maxdeg, wm); // 13 wm
+    f2p_wm_release(wm, mark);
     PUTS("minpoly end\n");
 }
 
@@ -850,11 +1452,11 @@ void f2p_minpoly(mpz_t minpoly, mpz_t seq, int maxdeg)
 int f2p_is_irreducible(mpz_t poly)
 {
     PUTS("f2p_is_irreducible start\n");
-    f2p_wm_t wm;
-    int wp = 0;
-    f2p_wm_init(&wm, 10);
-    int result = f2p_is_irreducible_aux(poly, wp, &wm);
-    f2p_wm_clear(&wm);
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    f2p_wm_reserve(wm, 2 * f2p_degree(poly) + 2 * GMP_NUMB_BITS);
+    int result = f2p_is_irreducible_aux(poly, wm);
+    f2p_wm_release(wm, mark);
     PUTS("f2p_is_irreducible end\n");
     return result;
 }
@@ -869,12 +1471,12 @@ int f2p_is_irreducible(mpz_t poly)
 void f2p_calc_jump(mpz_t jump, mpz_t minpoly, mpz_t step)
 {
     PUTS("f2p_calc_jump start\n");
-    f2p_wm_t wm;
-    int wp = 0;
-    f2p_wm_init(&wm, 5);
-    mpz_t *x = &(wm.ar[wp++]);
-    f2p_set_binstr(*x, "10");
-    f2p_powermod(jump, *x, step, minpoly, wp, &wm); // 4
-    f2p_wm_clear(&wm);
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    f2p_wm_reserve(wm, 2 * f2p_degree(minpoly) + 2 * GMP_NUMB_BITS);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_set_ui(*x, 2);
+    f2p_powermod(jump, *x, step, minpoly, wm); // 4
+    f2p_wm_release(wm, mark);
     PUTS("f2p_calc_jump end\n");
 }
@@ -6,6 +6,11 @@
  *
  * @brief Simple F2 Polynomial Library for GMP (GNU Multi-Precision Library).
  *
+ * Functions are reentrant. Temporaries are taken from f2p_wm_t given
+ * by the caller, or from the working memory of the calling thread,
+ * f2p_wm_thread_local. One f2p_wm_t should not be used by two threads
+ * at the same time.
+ *
  * @author Mutsuo Saito
  * @author Makoto Matsumoto (Hiroshima University)
  *
@@ -26,13 +31,139 @@
 extern "C" {
 #endif
 
+    enum {
+        F2P_WM_CHUNK = 16   // number of slots in one chunk
+    };
+
+/**
+ * f2p_mul uses Karatsuba's method when both operands have at least
+ * F2P_KARATSUBA_THRESHOLD limbs, and computes sub-products in
+ * parallel when operands have at least F2P_MUL_PARALLEL_THRESHOLD
+ * limbs (about 100000 degree).
+ */
+    enum {
+        F2P_KARATSUBA_THRESHOLD = 32,
+        F2P_MUL_PARALLEL_THRESHOLD = 1600
+    };
+
+/**
+ * Working memory
+ *
+ * Slots are used in stack discipline, f2p_wm_mark returns current
+ * position, f2p_wm_alloc takes one slot and f2p_wm_release returns
+ * all slots taken after the mark. Slots are allocated by chunks,
+ * so working memory grows without moving slots in use.
+ */
     struct F2P_WM_T {
-        int max_size;
-        mpz_t * ar;
+        int max_size;      // number of allocated slots
+        int top;           // number of slots in use
+        int high_water;    // max of top
+        mp_bitcnt_t bits;  // initial capacity of slots
+        int num_chunks;
+        mpz_t ** chunk;
     };
 
     typedef struct F2P_WM_T f2p_wm_t;
 
+    void f2p_wm_init(f2p_wm_t *wm, int size);
+
+    void f2p_wm_init2(f2p_wm_t *wm, int size, mp_bitcnt_t bits);
+
+    void f2p_wm_clear(f2p_wm_t *wm);
+
+    mpz_t * f2p_wm_grow(f2p_wm_t *wm);
+
+    void f2p_wm_reserve(f2p_wm_t *wm, mp_bitcnt_t bits);
+
+    f2p_wm_t * f2p_wm_thread_local(void);
+
+    void f2p_wm_thread_cleanup(void);
+
+    static inline int f2p_wm_mark(f2p_wm_t *wm)
+    {
+        return wm->top;
+    }
+
+    static inline void f2p_wm_release(f2p_wm_t *wm, int mark)
+    {
+        wm->top = mark;
+    }
+
+/**
+ * take one slot of working memory.
+ *
+ * the value of the slot is undefined.
+ *@param wm working memory
+ *@return pointer to the slot
+ */
+    static inline mpz_t * f2p_wm_alloc(f2p_wm_t *wm)
+    {
+        if (wm->top >= wm->max_size) {
+            return f2p_wm_grow(wm);
+        }
+        int i = wm->top++;
+        if (wm->top > wm->high_water) {
+            wm->high_water = wm->top;
+        }
+        return &(wm->chunk[i / F2P_WM_CHUNK][i % F2P_WM_CHUNK]);
+    }
+
+/**
+ * control of long computation
+ *
+ * A thread sets its control by f2p_control_set, then the Euclid
+ * loops of f2p_exeuclid, f2p_exeuclid2 and f2p_gcd and the squaring
+ * loops of f2p_powermod and f2p_is_irreducible_aux store their
+ * progress and stop when cancel is set by other thread. Results of
+ * functions stopped by cancel are undefined; a cancel which arrives
+ * after the last step does not stop anything and the result is
+ * valid. A control with parent is cancelled also when the parent is
+ * cancelled, which is used for controls of subtasks. Members should
+ * be accessed by f2p_control_cancel, f2p_control_progress and
+ * f2p_control_stopped.
+ */
+    struct F2P_CONTROL_T {
+        int cancel;     // nonzero if cancel is requested
+        long progress;  // progress of the loop running
+        int stopped;    // nonzero if a loop stopped by cancel
+        struct F2P_CONTROL_T *parent; // cancel of parent is forwarded
+    };
+
+    typedef struct F2P_CONTROL_T f2p_control_t;
+
+    void f2p_control_set(f2p_control_t *ctl);
+
+    f2p_control_t *f2p_control_get(void);
+
+    int f2p_control_poll(long progress);
+
+    int f2p_control_check(void);
+
+    static inline void f2p_control_cancel(f2p_control_t *ctl)
+    {
+        __atomic_store_n(&ctl->cancel, 1, __ATOMIC_RELAXED);
+    }
+
+    static inline int f2p_control_cancelled(f2p_control_t *ctl)
+    {
+        for (; ctl != NULL; ctl = ctl->parent) {
+            if (__atomic_load_n(&ctl->cancel, __ATOMIC_RELAXED)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    static inline long f2p_control_progress(f2p_control_t *ctl)
+    {
+        return __atomic_load_n(&ctl->progress, __ATOMIC_RELAXED);
+    }
+
+    static inline int f2p_control_stopped(f2p_control_t *ctl)
+    {
+        return __atomic_load_n(&ctl->stopped, __ATOMIC_RELAXED);
+    }
+
 //typedef unsigned int (*f2rng)(void);
 
     static inline void f2p_set_binstr(mpz_t poly, const char * str)
@@ -92,44 +223,49 @@ extern "C" {
         return mpz_tstbit(poly, index);
     }
 
-    void f2p_wm_init(f2p_wm_t *wm, int size);
+    void f2p_mod(mpz_t a, mpz_t b, f2p_wm_t *wm);
 
-    void f2p_wm_clear(f2p_wm_t *wm);
+    void f2p_divrem(mpz_t q, mpz_t r, mpz_t a, mpz_t b, f2p_wm_t *wm);
 
-    void f2p_mod(mpz_t a, mpz_t b, int wp, f2p_wm_t *wm);
+    void f2p_mul(mpz_t r, mpz_t a, mpz_t b, f2p_wm_t *wm);
 
-    void f2p_divrem(mpz_t q, mpz_t r, mpz_t a, mpz_t b, int wp, f2p_wm_t *wm);
+    void f2p_addmul(mpz_t r, mpz_t a, mpz_t b);
 
-    void f2p_mul(mpz_t r, mpz_t a, mpz_t b, int wp, f2p_wm_t *wm);
+    void f2p_mulmod(mpz_t r, mpz_t a, mpz_t b, mpz_t mod, f2p_wm_t *wm);
 
-    void f2p_mulmod(mpz_t r, mpz_t a, mpz_t b, mpz_t mod, int wp, f2p_wm_t *wm);
+    void f2p_mulmod_inplace(mpz_t r, mpz_t b, mpz_t mod, f2p_wm_t *wm);
 
-    void f2p_pow2mod(mpz_t r, mpz_t a, mpz_t mod, int wp, f2p_wm_t *wm);
+    void f2p_pow2mod(mpz_t r, mpz_t a, mpz_t mod, f2p_wm_t *wm);
 
     void f2p_powermod(mpz_t r, mpz_t x, mpz_t e, mpz_t mod,
-                      int wp, f2p_wm_t *wm);
+                      f2p_wm_t *wm);
 
-    void f2p_Xpowermod(mpz_t r, mpz_t e, mpz_t mod, int wp, f2p_wm_t *wm);
+    void f2p_Xpowermod(mpz_t r, mpz_t e, mpz_t mod, f2p_wm_t *wm);
 
-    void f2p_square(mpz_t r, mpz_t a, int wp, f2p_wm_t *wm);
+    void f2p_square(mpz_t r, mpz_t a, f2p_wm_t *wm);
 
     void f2p_exeuclid(mpz_t a, mpz_t b, mpz_t c, mpz_t x, mpz_t y,
-                      int wp, f2p_wm_t *wm);
+                      f2p_wm_t *wm);
 
 //void f2p_exeuclid2(mpz_t a, mpz_t b, mpz_t c, mpz_t x, mpz_t y, int m,
-//                   int wp, f2p_wm_t *wm);
+//                   f2p_wm_t *wm);
     void f2p_exeuclid2(mpz_t a, mpz_t c, mpz_t x, mpz_t y, int m,
-                       int wp, f2p_wm_t *wm);
+                       f2p_wm_t *wm);
 
-    void f2p_gcd(mpz_t gcd, mpz_t a, mpz_t b, int wp, f2p_wm_t *wm);
+    void f2p_gcd(mpz_t gcd, mpz_t a, mpz_t b, f2p_wm_t *wm);
 
 //void f2p_minpoly(char * minpoly, f2rng gen, int mexp);
 
     void f2p_minpoly(mpz_t minpoly, mpz_t seq, int mexp);
 
+    void f2p_minpoly_aux(mpz_t minpoly, mpz_t seq, int maxdeg,
+                         f2p_wm_t *wm);
+
 //    int f2p_is_irreducible(const char * poly);
     int f2p_is_irreducible(mpz_t poly);
 
+    int f2p_is_irreducible_aux(mpz_t poly, f2p_wm_t *wm);
+
     void f2p_calc_jump(mpz_t jump, mpz_t minpoly, mpz_t step);
 
 #if defined(__cplusplus)
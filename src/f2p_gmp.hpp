@@ -0,0 +1,476 @@
+#pragma once
+#ifndef F2P_GMP_HPP
+#define F2P_GMP_HPP
+/**
+ * @file f2p_gmp.hpp
+ *
+ * @brief C++ wrapper of f2p_gmp.h.
+ *
+ * f2p::Poly owns one mpz_t. It can be moved but not copied, use
+ * clone() for explicit copy. Moves exchange limb pointers by
+ * mpz_swap and never reallocate limbs.
+ *
+ * a + b and a * b make lazy expressions, which are evaluated when
+ * assigned to Poly. Assignment of a + q * b is done in one pass over
+ * the limbs of q and b without temporary polynomial. Expressions
+ * refer to their operands, so they should not be kept in variables.
+ *
+ * Functions use working memory of the calling thread,
+ * f2p_wm_thread_local().
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+#include <string>
+
+namespace f2p {
+
+    class Poly;
+
+    namespace detail {
+/**
+ * working memory of the calling thread, released at end of scope.
+ */
+        class WorkScope {
+        public:
+            WorkScope() : wm(f2p_wm_thread_local()), mark(f2p_wm_mark(wm))
+            {
+            }
+            ~WorkScope()
+            {
+                f2p_wm_release(wm, mark);
+            }
+            WorkScope(const WorkScope&) = delete;
+            WorkScope& operator=(const WorkScope&) = delete;
+            f2p_wm_t *wm;
+        private:
+            int mark;
+        };
+    }
+
+/**
+ * base of expressions
+ */
+    template<typename E>
+    struct Expr {
+        const E& self() const
+        {
+            return static_cast<const E&>(*this);
+        }
+    };
+
+/**
+ * F2 polynomial owning mpz_t
+ */
+    class Poly : public Expr<Poly> {
+    public:
+        Poly()
+        {
+            mpz_init(z);
+        }
+
+        explicit Poly(unsigned long v)
+        {
+            mpz_init_set_ui(z, v);
+        }
+
+        explicit Poly(mpz_srcptr v)
+        {
+            mpz_init_set(z, v);
+        }
+
+        Poly(Poly&& other) noexcept
+        {
+            mpz_init(z);
+            mpz_swap(z, other.z);
+        }
+
+        template<typename E>
+        Poly(const Expr<E>& e)
+        {
+            mpz_init(z);
+            e.self().assign_to(*this);
+        }
+
+        ~Poly()
+        {
+            mpz_clear(z);
+        }
+
+        Poly(const Poly&) = delete;
+        Poly& operator=(const Poly&) = delete;
+
+        Poly& operator=(Poly&& other) noexcept
+        {
+            mpz_swap(z, other.z);
+            return *this;
+        }
+
+        template<typename E>
+        Poly& operator=(const Expr<E>& e)
+        {
+            e.self().assign_to(*this);
+            return *this;
+        }
+
+        template<typename E>
+        Poly& operator+=(const Expr<E>& e)
+        {
+            if (e.self().aliases(*this)) {
+                Poly t(e);
+                f2p_add(z, z, t.z);
+            } else {
+                e.self().add_to(*this);
+            }
+            return *this;
+        }
+
+        Poly clone() const
+        {
+            return Poly(z);
+        }
+
+        void swap(Poly& other) noexcept
+        {
+            mpz_swap(z, other.z);
+        }
+
+        static Poly from_hex(const std::string& str)
+        {
+            Poly r;
+            f2p_set_hexstr(r.z, str.c_str());
+            return r;
+        }
+
+        static Poly from_bin(const std::string& str)
+        {
+            Poly r;
+            f2p_set_binstr(r.z, str.c_str());
+            return r;
+        }
+
+        std::string to_string(int base) const
+        {
+            void (*free_func)(void *, size_t);
+            mp_get_memory_functions(nullptr, nullptr, &free_func);
+            char *s = mpz_get_str(nullptr, base, z);
+            std::string str(s);
+            free_func(s, str.size() + 1);
+            return str;
+        }
+
+        std::string to_hex() const
+        {
+            return to_string(16);
+        }
+
+        std::string to_bin() const
+        {
+            return to_string(2);
+        }
+
+/**
+ * degree of polynomial, -1 for the polynomial 0.
+ */
+        int degree() const
+        {
+            if (is_zero()) {
+                return -1;
+            }
+            return static_cast<int>(f2p_degree(const_cast<mpz_ptr>(z)));
+        }
+
+        bool is_zero() const
+        {
+            return mpz_sgn(z) == 0;
+        }
+
+        int coefficient(mp_bitcnt_t index) const
+        {
+            return mpz_tstbit(z, index);
+        }
+
+        void setbit(mp_bitcnt_t index)
+        {
+            mpz_setbit(z, index);
+        }
+
+        void clrbit(mp_bitcnt_t index)
+        {
+            mpz_clrbit(z, index);
+        }
+
+        Poly& operator<<=(unsigned long n)
+        {
+            f2p_lshift(z, n);
+            return *this;
+        }
+
+        Poly& operator>>=(unsigned long n)
+        {
+            f2p_rshift(z, n);
+            return *this;
+        }
+
+        Poly& operator%=(const Poly& b)
+        {
+            detail::WorkScope ws;
+            f2p_mod(z, b.mp(), ws.wm);
+            return *this;
+        }
+
+        friend bool operator==(const Poly& a, const Poly& b)
+        {
+            return mpz_cmp(a.z, b.z) == 0;
+        }
+
+        friend bool operator!=(const Poly& a, const Poly& b)
+        {
+            return mpz_cmp(a.z, b.z) != 0;
+        }
+
+        mpz_ptr mp()
+        {
+            return z;
+        }
+
+        mpz_ptr mp() const
+        {
+            return const_cast<mpz_ptr>(z);
+        }
+
+        // expression interface
+        bool aliases(const Poly& p) const
+        {
+            return this == &p;
+        }
+
+        void assign_to(Poly& dst) const
+        {
+            mpz_set(dst.z, z);
+        }
+
+        void add_to(Poly& dst) const
+        {
+            f2p_add(dst.z, dst.z, mp());
+        }
+
+    private:
+        mpz_t z;
+    };
+
+    namespace detail {
+        inline const Poly * leaf(const Poly& p)
+        {
+            return &p;
+        }
+
+        template<typename E>
+        const Poly * leaf(const E&)
+        {
+            return nullptr;
+        }
+    }
+
+/**
+ * l + r
+ */
+    template<typename L, typename R>
+    class SumExpr : public Expr<SumExpr<L, R> > {
+    public:
+        SumExpr(const L& l, const R& r) : l(l), r(r) {}
+
+        bool aliases(const Poly& p) const
+        {
+            return l.aliases(p) || r.aliases(p);
+        }
+
+        void assign_to(Poly& dst) const
+        {
+            if (detail::leaf(l) == &dst && !r.aliases(dst)) {
+                r.add_to(dst);   // dst = dst + r
+            } else if (detail::leaf(r) == &dst && !l.aliases(dst)) {
+                l.add_to(dst);   // dst = l + dst
+            } else if (aliases(dst)) {
+                Poly t;
+                assign_to(t);
+                dst.swap(t);
+            } else {
+                l.assign_to(dst);
+                r.add_to(dst);
+            }
+        }
+
+        void add_to(Poly& dst) const
+        {
+            l.add_to(dst);
+            r.add_to(dst);
+        }
+
+    private:
+        const L& l;
+        const R& r;
+    };
+
+/**
+ * l * r
+ */
+    template<typename L, typename R>
+    class MulExpr : public Expr<MulExpr<L, R> > {
+    public:
+        MulExpr(const L& l, const R& r) : l(l), r(r) {}
+
+        bool aliases(const Poly& p) const
+        {
+            return l.aliases(p) || r.aliases(p);
+        }
+
+        void assign_to(Poly& dst) const
+        {
+            if (aliases(dst)) {
+                Poly t;
+                assign_to(t);
+                dst.swap(t);
+                return;
+            }
+            mpz_set_ui(dst.mp(), 0);
+            add_to(dst);
+        }
+
+        void add_to(Poly& dst) const
+        {
+            const Poly *lp = detail::leaf(l);
+            const Poly *rp = detail::leaf(r);
+            Poly lt;
+            Poly rt;
+            if (lp == nullptr || lp == &dst) {
+                l.assign_to(lt);
+                lp = &lt;
+            }
+            if (rp == nullptr || rp == &dst) {
+                r.assign_to(rt);
+                rp = &rt;
+            }
+            f2p_addmul(dst.mp(), lp->mp(), rp->mp());
+        }
+
+    private:
+        const L& l;
+        const R& r;
+    };
+
+    template<typename L, typename R>
+    SumExpr<L, R> operator+(const Expr<L>& l, const Expr<R>& r)
+    {
+        return SumExpr<L, R>(l.self(), r.self());
+    }
+
+    template<typename L, typename R>
+    MulExpr<L, R> operator*(const Expr<L>& l, const Expr<R>& r)
+    {
+        return MulExpr<L, R>(l.self(), r.self());
+    }
+
+    inline Poly operator<<(const Poly& a, unsigned long n)
+    {
+        Poly r = a.clone();
+        r <<= n;
+        return r;
+    }
+
+    inline Poly operator>>(const Poly& a, unsigned long n)
+    {
+        Poly r = a.clone();
+        r >>= n;
+        return r;
+    }
+
+    inline Poly operator%(const Poly& a, const Poly& b)
+    {
+        Poly r = a.clone();
+        r %= b;
+        return r;
+    }
+
+/**
+ * a = q * b + r
+ */
+    inline void divrem(Poly& q, Poly& r, const Poly& a, const Poly& b)
+    {
+        detail::WorkScope ws;
+        f2p_divrem(q.mp(), r.mp(), a.mp(), b.mp(), ws.wm);
+    }
+
+    inline Poly operator/(const Poly& a, const Poly& b)
+    {
+        Poly q;
+        Poly r;
+        divrem(q, r, a, b);
+        return q;
+    }
+
+    inline Poly mulmod(const Poly& a, const Poly& b, const Poly& mod)
+    {
+        detail::WorkScope ws;
+        Poly r;
+        f2p_mulmod(r.mp(), a.mp(), b.mp(), mod.mp(), ws.wm);
+        return r;
+    }
+
+    inline Poly powermod(const Poly& x, mpz_srcptr e, const Poly& mod)
+    {
+        detail::WorkScope ws;
+        Poly r;
+        f2p_powermod(r.mp(), x.mp(), const_cast<mpz_ptr>(e), mod.mp(),
+                     ws.wm);
+        return r;
+    }
+
+    inline Poly gcd(const Poly& a, const Poly& b)
+    {
+        detail::WorkScope ws;
+        Poly r;
+        f2p_gcd(r.mp(), a.mp(), b.mp(), ws.wm);
+        return r;
+    }
+
+/**
+ * a * x + b * y = c = gcd(x, y)
+ */
+    inline void exeuclid(Poly& a, Poly& b, Poly& c, const Poly& x,
+                         const Poly& y)
+    {
+        detail::WorkScope ws;
+        f2p_exeuclid(a.mp(), b.mp(), c.mp(), x.mp(), y.mp(), ws.wm);
+    }
+
+    inline Poly minpoly(const Poly& seq, int maxdeg)
+    {
+        Poly r;
+        f2p_minpoly(r.mp(), seq.mp(), maxdeg);
+        return r;
+    }
+
+    inline bool is_irreducible(const Poly& poly)
+    {
+        return f2p_is_irreducible(poly.mp()) != 0;
+    }
+
+    inline Poly calc_jump(const Poly& minpoly, mpz_srcptr step)
+    {
+        Poly r;
+        f2p_calc_jump(r.mp(), minpoly.mp(), const_cast<mpz_ptr>(step));
+        return r;
+    }
+}
+
+#endif // F2P_GMP_HPP
@@ -0,0 +1,404 @@
+/**
+ * @file f2p_irrlist.c
+ *
+ * @brief List of all irreducible polynomials of small degree.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_irrlist.h"
+#include "f2p_limb.h"
+#include "f2p_thread.h"
+#include "debug_f2p.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * number of multiples marked by one job
+ */
+#define CHUNK_BITS 16
+
+static const char magic[8] = {'f', '2', 'p', 'i', 'r', 'r', '0', '1'};
+
+struct IRRLIST_ARG_T {
+    int degree;         // degree of multiples
+    int atomic;         // 1 if jobs run in parallel
+    uint64_t *bitmap;   // bit (f >> 1) mod t^(degree - 1) is multiple
+    uint64_t *g;        // factor of job
+    uint64_t *start;    // first index of Gray code of job
+};
+
+/**
+ * mark g * h for odd h of degree n - deg(g), where h = t^m + 1 + 2x
+ * and x is the Gray code of start, ..., start + 2^CHUNK_BITS - 1.
+ */
+static void mark_job(int index, int worker, void *p)
+{
+    (void)worker;
+    struct IRRLIST_ARG_T *arg = p;
+    uint64_t g = arg->g[index];
+    uint64_t first = arg->start[index];
+    int m = arg->degree - f2p_limb_degree((mp_limb_t)g);
+    uint64_t end = first + ((uint64_t)1 << CHUNK_BITS);
+    if (end > (uint64_t)1 << (m - 1)) {
+        end = (uint64_t)1 << (m - 1);
+    }
+    uint64_t mask = ((uint64_t)1 << (arg->degree - 1)) - 1;
+    uint64_t x = first ^ (first >> 1);
+    // g and h have degree less than 32, g * h has degree 32 or less
+    mp_limb_t hi;
+    mp_limb_t h = (mp_limb_t)(((uint64_t)1 << m) | 1 | (x << 1));
+    uint64_t prod = f2p_limb_clmul(&hi, (mp_limb_t)g, h);
+#if GMP_NUMB_BITS < 64
+    prod |= (uint64_t)hi << GMP_NUMB_BITS;
+#endif
+    uint64_t *bitmap = arg->bitmap;
+    for (uint64_t i = first; i < end; i++) {
+        if (i != first) {
+            prod ^= g << (__builtin_ctzll(i) + 1);
+        }
+        uint64_t idx = (prod >> 1) & mask;
+        uint64_t bit = (uint64_t)1 << (idx & 63);
+        if (arg->atomic) {
+            __atomic_fetch_or(&bitmap[idx >> 6], bit, __ATOMIC_RELAXED);
+        } else {
+            bitmap[idx >> 6] |= bit;
+        }
+    }
+}
+
+/**
+ * sieve irreducible polynomials of degree n, list should have all
+ * irreducible polynomials of degree n / 2 or less.
+ */
+static void sieve_degree(f2p_irrlist_t *list, int n, int num_threads)
+{
+    uint32_t *out = list->poly + list->offset[n];
+    if (n == 1) {
+        out[0] = 0; // t
+        out[1] = 1; // t + 1
+        return;
+    }
+    uint64_t size = (uint64_t)1 << (n - 1);
+    uint64_t words = (size + 63) / 64;
+    uint64_t *bitmap = calloc(words, sizeof(uint64_t));
+    assert(bitmap != NULL);
+    // jobs for odd irreducible polynomials of degree 2 to n / 2
+    long num_jobs = 0;
+    for (int k = 2; k <= n / 2; k++) {
+        long chunks = 1;
+        if (n - k - 1 > CHUNK_BITS) {
+            chunks = 1L << (n - k - 1 - CHUNK_BITS);
+        }
+        num_jobs += list->count[k] * chunks;
+    }
+    uint64_t *g = malloc((num_jobs + 1) * sizeof(uint64_t));
+    uint64_t *start = malloc((num_jobs + 1) * sizeof(uint64_t));
+    assert(g != NULL && start != NULL);
+    long j = 0;
+    for (int k = 2; k <= n / 2; k++) {
+        for (long i = 0; i < list->count[k]; i++) {
+            uint64_t f = f2p_irrlist_get(list, k, i);
+            for (uint64_t s = 0; s < (uint64_t)1 << (n - k - 1);
+                 s += (uint64_t)1 << CHUNK_BITS) {
+                g[j] = f;
+                start[j] = s;
+                j++;
+            }
+        }
+    }
+    assert(j == num_jobs);
+    if (num_jobs > 0) {
+        struct IRRLIST_ARG_T arg = {n, f2p_num_threads(num_threads) > 1,
+                                    bitmap, g, start};
+        f2p_parallel_for(num_jobs, num_threads, mark_job, &arg);
+    }
+    long c = 0;
+    for (uint64_t w = 0; w < words; w++) {
+        uint64_t rest = ~bitmap[w];
+        if (size - w * 64 < 64) {
+            rest &= ((uint64_t)1 << (size - w * 64)) - 1;
+        }
+        while (rest != 0) {
+            uint64_t low = ((w * 64 + __builtin_ctzll(rest)) << 1) | 1;
+            rest &= rest - 1;
+            // reject multiples of t + 1, the leading term is omitted
+            if (__builtin_popcountll(low) % 2 == 0) {
+                out[c++] = (uint32_t)low;
+            }
+        }
+    }
+    assert(c == list->count[n]);
+    free(start);
+    free(g);
+    free(bitmap);
+}
+
+/**
+ * enumerate all irreducible polynomials of degree max_degree or less.
+ *
+ * memory of about 2^(max_degree - 4) bytes is used for the bitmap and
+ * about 2^(max_degree + 3) / max_degree bytes for the list.
+ *
+ *@param list list, should be cleared by f2p_irrlist_clear
+ *@param max_degree max degree, 1 <= max_degree <= F2P_IRRLIST_MAX_DEGREE
+ *@param num_threads number of threads, 0 means size of the executor
+ */
+void f2p_irrlist_init(f2p_irrlist_t *list, int max_degree, int num_threads)
+{
+    PUTS("f2p_irrlist_init start\n");
+    assert(max_degree >= 1 && max_degree <= F2P_IRRLIST_MAX_DEGREE);
+    memset(list, 0, sizeof(f2p_irrlist_t));
+    list->max_degree = max_degree;
+    mpz_t count;
+    mpz_init(count);
+    long total = 0;
+    for (int d = 1; d <= max_degree; d++) {
+        f2p_irreducible_count(count, d);
+        list->count[d] = mpz_get_si(count);
+        list->offset[d] = total;
+        total += list->count[d];
+    }
+    mpz_clear(count);
+    list->poly = malloc(total * sizeof(uint32_t));
+    assert(list->poly != NULL);
+    for (int d = 1; d <= max_degree; d++) {
+        sieve_degree(list, d, num_threads);
+    }
+    PUTS("f2p_irrlist_init end\n");
+}
+
+/**
+ * clear list
+ *
+ *@param list list
+ */
+void f2p_irrlist_clear(f2p_irrlist_t *list)
+{
+    free(list->poly);
+    memset(list, 0, sizeof(f2p_irrlist_t));
+}
+
+/**
+ * get irreducible polynomial
+ *
+ *@param list list
+ *@param degree degree
+ *@param index index in the polynomials of the degree
+ *@return polynomial, bit i is the coefficient of t^i
+ */
+uint64_t f2p_irrlist_get(const f2p_irrlist_t *list, int degree, long index)
+{
+    assert(degree >= 1 && degree <= list->max_degree);
+    assert(index >= 0 && index < list->count[degree]);
+    return ((uint64_t)1 << degree) | list->poly[list->offset[degree] + index];
+}
+
+/**
+ * search polynomial in the list by binary search
+ *
+ *@param list list
+ *@param poly polynomial, bit i is the coefficient of t^i
+ *@return index in the whole list, -1 if poly is not in the list
+ */
+long f2p_irrlist_index(const f2p_irrlist_t *list, uint64_t poly)
+{
+    if (poly == 0) {
+        return -1;
+    }
+    int degree;
+    if (poly >> 32 != 0) {
+        degree = 32 + f2p_limb_degree((mp_limb_t)(poly >> 32));
+    } else {
+        degree = f2p_limb_degree((mp_limb_t)poly);
+    }
+    if (degree < 1 || degree > list->max_degree) {
+        return -1;
+    }
+    uint32_t low = (uint32_t)(poly ^ ((uint64_t)1 << degree));
+    const uint32_t *p = list->poly + list->offset[degree];
+    long lo = 0;
+    long hi = list->count[degree];
+    while (lo < hi) {
+        long mid = lo + (hi - lo) / 2;
+        if (p[mid] < low) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < list->count[degree] && p[lo] == low) {
+        return list->offset[degree] + lo;
+    }
+    return -1;
+}
+
+static int write_uint(FILE *fp, uint64_t x, int bytes)
+{
+    unsigned char buf[8];
+    for (int i = 0; i < bytes; i++) {
+        buf[i] = (unsigned char)(x >> (8 * i));
+    }
+    return fwrite(buf, 1, (size_t)bytes, fp) == (size_t)bytes ? 0 : -1;
+}
+
+static int read_uint(FILE *fp, uint64_t *x, int bytes)
+{
+    unsigned char buf[8];
+    if (fread(buf, 1, (size_t)bytes, fp) != (size_t)bytes) {
+        return -1;
+    }
+    *x = 0;
+    for (int i = 0; i < bytes; i++) {
+        *x |= (uint64_t)buf[i] << (8 * i);
+    }
+    return 0;
+}
+
+/**
+ * write list in binary format
+ *
+ * 8 bytes magic, max degree in 4 bytes, then count and offset of each
+ * degree 0 to max degree in 8 bytes each, then f - t^d of each
+ * polynomial in 4 bytes. All integers are little endian.
+ *
+ *@param fp output file opened in binary mode
+ *@param list list
+ *@return 0 if success, -1 otherwise
+ */
+int f2p_irrlist_write(FILE *fp, const f2p_irrlist_t *list)
+{
+    int r = 0;
+    r |= fwrite(magic, 1, sizeof(magic), fp) != sizeof(magic);
+    r |= write_uint(fp, (uint64_t)list->max_degree, 4);
+    for (int d = 0; d <= list->max_degree; d++) {
+        r |= write_uint(fp, (uint64_t)list->count[d], 8);
+        r |= write_uint(fp, (uint64_t)list->offset[d], 8);
+    }
+    long total = list->offset[list->max_degree]
+        + list->count[list->max_degree];
+    for (long i = 0; i < total && r == 0; i++) {
+        r |= write_uint(fp, list->poly[i], 4);
+    }
+    if (r) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * read list written by f2p_irrlist_write.
+ *
+ * The count of each degree should be the number of irreducible
+ * polynomials of the degree. If success, list should be cleared by f2p_irrlist_clear.
+ *
+ *@param fp input file opened in binary mode
+ *@param list list, not initialized
+ *@return 0 if success, -1 otherwise
+ */
+int f2p_irrlist_read(FILE *fp, f2p_irrlist_t *list)
+{
+    char buf[sizeof(magic)];
+    uint64_t x;
+    memset(list, 0, sizeof(f2p_irrlist_t));
+    if (fread(buf, 1, sizeof(magic), fp) != sizeof(magic)
+        || memcmp(buf, magic, sizeof(magic)) != 0
+        || read_uint(fp, &x, 4) != 0
+        || x < 1 || x > F2P_IRRLIST_MAX_DEGREE) {
+        return -1;
+    }
+    list->max_degree = (int)x;
+    mpz_t expected;
+    mpz_init(expected);
+    long total = 0;
+    for (int d = 0; d <= list->max_degree; d++) {
+        uint64_t count;
+        uint64_t offset;
+        f2p_irreducible_count(expected, d);
+        if (read_uint(fp, &count, 8) != 0 || read_uint(fp, &offset, 8) != 0
+            || offset != (uint64_t)total
+            || mpz_cmp_ui(expected, (unsigned long)count) != 0) {
+            mpz_clear(expected);
+            return -1;
+        }
+        list->count[d] = (long)count;
+        list->offset[d] = (long)offset;
+        total += (long)count;
+    }
+    mpz_clear(expected);
+    list->poly = malloc(total * sizeof(uint32_t) + 1);
+    if (list->poly == NULL) {
+        return -1;
+    }
+    for (long i = 0; i < total; i++) {
+        if (read_uint(fp, &x, 4) != 0) {
+            f2p_irrlist_clear(list);
+            return -1;
+        }
+        list->poly[i] = (uint32_t)x;
+    }
+    return 0;
+}
+
+/**
+ * Moebius function
+ */
+static int moebius(int n)
+{
+    int mu = 1;
+    for (int p = 2; p * p <= n; p++) {
+        if (n % p == 0) {
+            n /= p;
+            if (n % p == 0) {
+                return 0;
+            }
+            mu = -mu;
+        }
+    }
+    if (n > 1) {
+        mu = -mu;
+    }
+    return mu;
+}
+
+/**
+ * number of irreducible polynomials of degree n over F2,
+ * (1/n) sum_{d | n} mu(d) 2^(n/d)
+ *
+ *@param count result
+ *@param degree degree n
+ */
+void f2p_irreducible_count(mpz_t count, int degree)
+{
+    mpz_set_ui(count, 0);
+    if (degree < 1) {
+        return;
+    }
+    mpz_t x;
+    mpz_init(x);
+    for (int d = 1; d <= degree; d++) {
+        if (degree % d != 0) {
+            continue;
+        }
+        int mu = moebius(d);
+        if (mu == 0) {
+            continue;
+        }
+        mpz_set_ui(x, 0);
+        mpz_setbit(x, degree / d);
+        if (mu > 0) {
+            mpz_add(count, count, x);
+        } else {
+            mpz_sub(count, count, x);
+        }
+    }
+    mpz_divexact_ui(count, count, degree);
+    mpz_clear(x);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef F2P_IRRLIST_H
+#define F2P_IRRLIST_H
+/**
+ * @file f2p_irrlist.h
+ *
+ * @brief List of all irreducible polynomials of small degree.
+ *
+ * Irreducible polynomials of degree n are enumerated by a sieve on a
+ * bitmap indexed by the odd polynomials of degree n. For each
+ * irreducible polynomial g of degree 2 <= k <= n / 2, all multiples
+ * g * h are marked, where h runs over the odd polynomials of degree
+ * n - k in Gray code order, so that each product is obtained from the
+ * previous one by one shift and one xor. Multiples of t and t + 1 are
+ * rejected by the constant term and the parity of the weight. The
+ * list can be written to a compact binary file with an index of the
+ * first polynomial of each degree.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+#include <stdio.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+    enum {
+        F2P_IRRLIST_MAX_DEGREE = 32
+    };
+
+/**
+ * irreducible polynomials of degree max_degree or less.
+ *
+ * A polynomial f of degree d is kept as f - t^d in 32 bits, and
+ * polynomials of each degree are sorted in increasing order.
+ */
+    struct F2P_IRRLIST_T {
+        int max_degree;
+        long count[F2P_IRRLIST_MAX_DEGREE + 1];  // number of degree d
+        long offset[F2P_IRRLIST_MAX_DEGREE + 1]; // index of first of degree d
+        uint32_t *poly;
+    };
+
+    typedef struct F2P_IRRLIST_T f2p_irrlist_t;
+
+    void f2p_irrlist_init(f2p_irrlist_t *list, int max_degree,
+                          int num_threads);
+
+    void f2p_irrlist_clear(f2p_irrlist_t *list);
+
+    uint64_t f2p_irrlist_get(const f2p_irrlist_t *list, int degree,
+                             long index);
+
+    long f2p_irrlist_index(const f2p_irrlist_t *list, uint64_t poly);
+
+    int f2p_irrlist_write(FILE *fp, const f2p_irrlist_t *list);
+
+    int f2p_irrlist_read(FILE *fp, f2p_irrlist_t *list);
+
+    void f2p_irreducible_count(mpz_t count, int degree);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_IRRLIST_H
@@ -0,0 +1,516 @@
+/**
+ * @file f2p_jump.c
+ *
+ * @brief Jump ahead of F2-linear generators using jump polynomials.
+ *
+ * @see H. Haramoto, M. Matsumoto, T. Nishimura, F. Panneton,
+ * P. L'Ecuyer, Efficient Jump Ahead for F2-Linear Random Number
+ * Generators, INFORMS Journal on Computing, 20(3), 2008.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_jump.h"
+#include "f2p_thread.h"
+#include "debug_f2p.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    F2P_JUMP_MAX_WINDOW = 16,
+    F2P_JUMP_SERIES_BLOCK = 16 // minimum length of chain for one thread
+};
+
+static inline unsigned char * table_at(const f2p_jump_window_t *win, int i)
+{
+    return win->table + win->ops->state_size * i;
+}
+
+/**
+ * window size for jump polynomial of given degree.
+ *
+ * Horner's method with sliding window needs about
+ * degree / (w + 1) state additions and 2^(w - 1) additions for the
+ * table. This function returns w which minimizes the sum.
+ *
+ *@param degree degree of jump polynomial
+ *@return window size
+ */
+int f2p_jump_window_size(int degree)
+{
+    int best = 1;
+    long best_cost = degree;
+    for (int w = 2; w <= F2P_JUMP_MAX_WINDOW; w++) {
+        long cost = degree / (w + 1) + (1L << (w - 1));
+        if (cost < best_cost) {
+            best = w;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+/**
+ * make table of v(g)s for odd v, deg(v) < window.
+ *
+ * table[v >> 1] = v(g)s, table[0] = s.
+ *
+ *@param win window table
+ *@param ops state operations
+ *@param state base state s, not changed
+ *@param window window size, 0 means default size for the state
+ * of 8 * state_size bits
+ */
+void f2p_jump_window_init(f2p_jump_window_t *win,
+                          const f2p_state_ops_t *ops,
+                          const void *state, int window)
+{
+    size_t ss = ops->state_size;
+    if (window <= 0) {
+        window = f2p_jump_window_size((int)(ss * 8));
+    }
+    if (window > F2P_JUMP_MAX_WINDOW) {
+        window = F2P_JUMP_MAX_WINDOW;
+    }
+    win->window = window;
+    win->size = 1 << (window - 1);
+    win->ops = ops;
+    win->table = malloc(ss * win->size);
+    unsigned char *gk = malloc(ss);
+    assert(win->table != NULL && gk != NULL);
+    memcpy(table_at(win, 0), state, ss);
+    memcpy(gk, state, ss);
+    // gk = g^k s
+    for (int k = 1; k < window; k++) {
+        ops->next_state(gk);
+        int top = 1 << k;
+        for (int v = top + 1; v < 2 * top; v += 2) {
+            unsigned char *t = table_at(win, v >> 1);
+            memcpy(t, table_at(win, (v - top) >> 1), ss);
+            ops->add_state(t, gk);
+        }
+    }
+    free(gk);
+}
+
+/**
+ * calculate jump(g)s using precomputed table.
+ *
+ *@param result jump(g)s, can be the same as the base state.
+ *@param win window table of base state s
+ *@param jump jump polynomial
+ */
+void f2p_jump_window_apply(void *result, const f2p_jump_window_t *win,
+                           mpz_t jump)
+{
+    const f2p_state_ops_t *ops = win->ops;
+    memcpy(result, table_at(win, 0), ops->state_size);
+    ops->clear_state(result);
+    if (mpz_cmp_ui(jump, 0) == 0) {
+        return;
+    }
+    long i = (long)f2p_degree(jump);
+    int started = 0;
+    while (i >= 0) {
+        if (!f2p_coefficient(jump, i)) {
+            if (started) {
+                ops->next_state(result);
+            }
+            i--;
+            continue;
+        }
+        long len = win->window;
+        if (len > i + 1) {
+            len = i + 1;
+        }
+        while (!f2p_coefficient(jump, i - len + 1)) {
+            len--;
+        }
+        int v = 0;
+        for (long j = i; j > i - len; j--) {
+            v = (v << 1) | f2p_coefficient(jump, j);
+        }
+        if (started) {
+            for (long j = 0; j < len; j++) {
+                ops->next_state(result);
+            }
+        }
+        ops->add_state(result, table_at(win, v >> 1));
+        started = 1;
+        i -= len;
+    }
+}
+
+/**
+ * clear window table
+ *
+ *@param win window table
+ */
+void f2p_jump_window_clear(f2p_jump_window_t *win)
+{
+    free(win->table);
+    win->table = NULL;
+    win->size = 0;
+}
+
+/**
+ * jump state by jump polynomial.
+ *
+ * state is changed to jump(g)state where g is the transition
+ * function of the generator.
+ *
+ *@param state state of generator
+ *@param ops state operations
+ *@param jump jump polynomial calculated by f2p_calc_jump
+ *@param window window size, 0 means automatic
+ */
+void f2p_jump_apply(void *state, const f2p_state_ops_t *ops,
+                    mpz_t jump, int window)
+{
+    PUTS("f2p_jump_apply start\n");
+    if (window <= 0) {
+        window = f2p_jump_window_size((int)f2p_degree(jump) + 1);
+    }
+    f2p_jump_window_t win;
+    f2p_jump_window_init(&win, ops, state, window);
+    f2p_jump_window_apply(state, &win, jump);
+    f2p_jump_window_clear(&win);
+    PUTS("f2p_jump_apply end\n");
+}
+
+/**
+ * make table of jump polynomials.
+ *
+ * table->table[i] = x^(stride * 2^i) mod minpoly for 0 <= i < size.
+ * table should be cleared by f2p_jump_table_clear after use.
+ *
+ *@param table jump table
+ *@param minpoly minimum polynomial of PRNG
+ *@param stride jump step of table->table[0], 1 for power of two jumps
+ *@param size number of entries
+ */
+void f2p_jump_table_init(f2p_jump_table_t *table, mpz_t minpoly,
+                         mpz_t stride, int size)
+{
+    PUTS("f2p_jump_table_init start\n");
+    assert(size > 0);
+    table->size = size;
+    mpz_init_set(table->minpoly, minpoly);
+    mpz_init_set(table->stride, stride);
+    table->table = malloc(size * sizeof(mpz_t));
+    assert(table->table != NULL);
+    for (int i = 0; i < size; i++) {
+        mpz_init(table->table[i]);
+    }
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    f2p_wm_reserve(wm, 2 * f2p_degree(minpoly) + 2 * GMP_NUMB_BITS);
+    f2p_calc_jump(table->table[0], minpoly, stride);
+    for (int i = 1; i < size; i++) {
+        f2p_pow2mod(table->table[i], table->table[i - 1], minpoly,
+                    wm); // 1 wm
+    }
+    f2p_wm_release(wm, mark);
+    PUTS("f2p_jump_table_init end\n");
+}
+
+/**
+ * clear jump table
+ *
+ *@param table jump table
+ */
+void f2p_jump_table_clear(f2p_jump_table_t *table)
+{
+    for (int i = 0; i < table->size; i++) {
+        mpz_clear(table->table[i]);
+    }
+    free(table->table);
+    mpz_clears(table->minpoly, table->stride, NULL);
+    table->size = 0;
+}
+
+/**
+ * calc jump using jump table
+ *
+ * jump = x^(stride * step) mod minpoly.
+ * If step < 2^size, this needs popcount(step) - 1 mulmods and no
+ * squaring. Bits of step above the table are calculated by squaring
+ * the last entry.
+ *
+ *@param jump result jump polynomial
+ *@param table jump table
+ *@param step multiplier of stride
+ */
+void f2p_jump_table_calc(mpz_t jump, f2p_jump_table_t *table, mpz_t step)
+{
+    PUTS("f2p_jump_table_calc start\n");
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    f2p_wm_reserve(wm, 2 * f2p_degree(table->minpoly) + 2 * GMP_NUMB_BITS);
+    mpz_t *s = f2p_wm_alloc(wm);
+    int first = 1;
+    mp_bitcnt_t bposmax = mpz_sizeinbase(step, 2);
+    mpz_set_ui(jump, 1);
+    for (mp_bitcnt_t bpos = 0; bpos < bposmax; bpos++) {
+        if (bpos < (mp_bitcnt_t)table->size) {
+            mpz_set(*s, table->table[bpos]);
+        } else {
+            f2p_pow2mod(*s, *s, table->minpoly, wm); // 1 wm
+        }
+        if (mpz_tstbit(step, bpos) == 0) {
+            continue;
+        }
+        if (first) {
+            mpz_set(jump, *s);
+            first = 0;
+        } else {
+            f2p_mulmod(jump, jump, *s, table->minpoly, wm); // 5 wm
+        }
+    }
+    f2p_wm_release(wm, mark);
+    PUTS("f2p_jump_table_calc end\n");
+}
+
+/**
+ * write jump table in text format
+ *
+ * first line is header, then size, minpoly, stride and entries
+ * in hexadecimal, one line each.
+ *
+ *@param fp output file
+ *@param table jump table
+ *@return 0 if success, -1 otherwise
+ */
+int f2p_jump_table_write(FILE *fp, f2p_jump_table_t *table)
+{
+    if (fprintf(fp, "f2p_jump_table 1\n%d\n", table->size) < 0) {
+        return -1;
+    }
+    int r = 0;
+    r |= mpz_out_str(fp, 16, table->minpoly) == 0;
+    r |= fputc('\n', fp) == EOF;
+    r |= mpz_out_str(fp, 16, table->stride) == 0;
+    r |= fputc('\n', fp) == EOF;
+    for (int i = 0; i < table->size; i++) {
+        r |= mpz_out_str(fp, 16, table->table[i]) == 0;
+        r |= fputc('\n', fp) == EOF;
+    }
+    if (r) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * read jump table written by f2p_jump_table_write.
+ *
+ * If success, table should be cleared by f2p_jump_table_clear.
+ *
+ *@param fp input file
+ *@param table jump table, not initialized
+ *@return 0 if success, -1 otherwise
+ */
+int f2p_jump_table_read(FILE *fp, f2p_jump_table_t *table)
+{
+    int version = 0;
+    int size = 0;
+    if (fscanf(fp, " f2p_jump_table %d %d", &version, &size) != 2
+        || version != 1 || size <= 0) {
+        return -1;
+    }
+    mpz_inits(table->minpoly, table->stride, NULL);
+    int r = 0;
+    r |= mpz_inp_str(table->minpoly, fp, 16) == 0;
+    r |= mpz_inp_str(table->stride, fp, 16) == 0;
+    // entries above 2^64 times stride are never needed
+    if (r || (size_t)size > mpz_sizeinbase(table->stride, 2) + 64) {
+        mpz_clears(table->minpoly, table->stride, NULL);
+        return -1;
+    }
+    table->table = malloc(size * sizeof(mpz_t));
+    if (table->table == NULL) {
+        mpz_clears(table->minpoly, table->stride, NULL);
+        return -1;
+    }
+    table->size = size;
+    for (int i = 0; i < size; i++) {
+        mpz_init(table->table[i]);
+    }
+    for (int i = 0; i < size; i++) {
+        r |= mpz_inp_str(table->table[i], fp, 16) == 0;
+    }
+    if (r) {
+        f2p_jump_table_clear(table);
+        return -1;
+    }
+    return 0;
+}
+
+struct SERIES_ARG_T {
+    mpz_t *out;
+    mpz_ptr minpoly;
+    mpz_ptr jump;
+    int n;
+    int len;
+    mp_bitcnt_t bits;
+};
+
+/**
+ * calculate one block of series, out[start] should be set.
+ * use 5 wm
+ */
+static void series_job(int index, int worker, void *p)
+{
+    (void)worker;
+    struct SERIES_ARG_T *arg = p;
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    f2p_wm_reserve(wm, arg->bits);
+    int start = index * arg->len;
+    int end = start + arg->len;
+    if (end > arg->n) {
+        end = arg->n;
+    }
+    for (int i = start + 1; i < end; i++) {
+        f2p_mulmod(arg->out[i], arg->out[i - 1], arg->jump, arg->minpoly,
+                   wm); // 5 wm
+    }
+}
+
+/**
+ * calc series of jump polynomials
+ *
+ * out[i] = x^((i + 1) * step) mod minpoly for 0 <= i < n.
+ * x^step mod minpoly is calculated once, then each polynomial
+ * is calculated by one mulmod from the previous one.
+ * When n is large, the series is split into blocks, heads of blocks
+ * are calculated by x^(len * step) and blocks are calculated in
+ * parallel.
+ *
+ *@param out array of n initialized polynomials
+ *@param minpoly minimum polynomial of PRNG
+ *@param step jump step
+ *@param n length of series
+ *@param num_threads number of threads, 0 means size of the executor
+ */
+void f2p_calc_jump_series(mpz_t *out, mpz_t minpoly, mpz_t step, int n,
+                          int num_threads)
+{
+    PUTS("f2p_calc_jump_series start\n");
+    if (n <= 0) {
+        return;
+    }
+    int num = f2p_num_threads(num_threads);
+    if (num > n / F2P_JUMP_SERIES_BLOCK) {
+        num = n / F2P_JUMP_SERIES_BLOCK;
+    }
+    if (num < 1) {
+        num = 1;
+    }
+    mp_bitcnt_t bits = 2 * f2p_degree(minpoly) + 2 * GMP_NUMB_BITS;
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    f2p_wm_reserve(wm, bits);
+    mpz_t *jump = f2p_wm_alloc(wm);
+    mpz_t *head = f2p_wm_alloc(wm);
+    mpz_t *len = f2p_wm_alloc(wm);
+    struct SERIES_ARG_T arg;
+    arg.out = out;
+    arg.minpoly = minpoly;
+    arg.jump = *jump;
+    arg.n = n;
+    arg.len = (n + num - 1) / num;
+    f2p_calc_jump(*jump, minpoly, step);
+    mpz_set(out[0], *jump);
+    if (num > 1) {
+        // x^(len * step), the difference of heads of blocks
+        mpz_set_ui(*len, arg.len);
+        f2p_powermod(*head, *jump, *len, minpoly, wm); // 6 wm
+        for (int b = 1; b < num && b * arg.len < n; b++) {
+            int i = b * arg.len;
+            f2p_mulmod(out[i], out[i - arg.len], *head, minpoly,
+                       wm); // 5 wm
+        }
+    }
+    arg.bits = bits;
+    f2p_parallel_for(num, num, series_job, &arg);
+    f2p_wm_release(wm, mark);
+    PUTS("f2p_calc_jump_series end\n");
+}
+
+struct STREAMS_ARG_T {
+    unsigned char *states;
+    const f2p_jump_window_t *win;
+    mpz_t *jump;
+};
+
+/**
+ * calculate one stream
+ */
+static void streams_job(int index, int worker, void *p)
+{
+    (void)worker;
+    struct STREAMS_ARG_T *arg = p;
+    size_t ss = arg->win->ops->state_size;
+    f2p_jump_window_apply(arg->states + ss * (index + 1), arg->win,
+                          arg->jump[index]);
+}
+
+/**
+ * make states of substreams
+ *
+ * states[i] is the base state jumped by i * stride, 0 <= i < n.
+ * Jump polynomials are calculated by f2p_calc_jump_series, and all
+ * jumps share one window table of the base state, so each stream
+ * costs only one evaluation of Horner's method. Streams are
+ * calculated in parallel.
+ *
+ *@param states array of n states
+ *@param base base state, not changed
+ *@param ops state operations
+ *@param minpoly minimum polynomial of PRNG
+ *@param stride jump step between neighbouring streams
+ *@param n number of streams
+ *@param num_threads number of threads, 0 means size of the executor
+ */
+void f2p_jump_streams(void *states, const void *base,
+                      const f2p_state_ops_t *ops,
+                      mpz_t minpoly, mpz_t stride, int n,
+                      int num_threads)
+{
+    PUTS("f2p_jump_streams start\n");
+    if (n <= 0) {
+        return;
+    }
+    memcpy(states, base, ops->state_size);
+    if (n == 1) {
+        return;
+    }
+    mpz_t *jump = malloc((n - 1) * sizeof(mpz_t));
+    assert(jump != NULL);
+    for (int i = 0; i < n - 1; i++) {
+        mpz_init(jump[i]);
+    }
+    f2p_calc_jump_series(jump, minpoly, stride, n - 1, num_threads);
+    f2p_jump_window_t win;
+    f2p_jump_window_init(&win, ops, base,
+                         f2p_jump_window_size((int)f2p_degree(minpoly)));
+    struct STREAMS_ARG_T arg;
+    arg.states = states;
+    arg.win = &win;
+    arg.jump = jump;
+    f2p_parallel_for(n - 1, num_threads, streams_job, &arg);
+    f2p_jump_window_clear(&win);
+    for (int i = 0; i < n - 1; i++) {
+        mpz_clear(jump[i]);
+    }
+    free(jump);
+    PUTS("f2p_jump_streams end\n");
+}
@@ -0,0 +1,111 @@
+#pragma once
+#ifndef F2P_JUMP_H
+#define F2P_JUMP_H
+/**
+ * @file f2p_jump.h
+ *
+ * @brief Jump ahead of F2-linear generators using jump polynomials.
+ *
+ * The state of a generator is treated as an opaque byte array with
+ * three callbacks. The jump polynomial calculated by f2p_calc_jump is
+ * evaluated by Horner's method using the sliding window method of
+ * Haramoto et al. with a table of precomputed states.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * operations on the state of a F2-linear generator.
+ *
+ * clear_state should clear only linear part of the state, parameters
+ * stored in the state should be kept.
+ */
+    struct F2P_STATE_OPS_T {
+        size_t state_size;
+        void (*next_state)(void *state);
+        void (*add_state)(void *dst, const void *src);
+        void (*clear_state)(void *state);
+    };
+
+    typedef struct F2P_STATE_OPS_T f2p_state_ops_t;
+
+/**
+ * precomputed states v(g)s for all odd polynomials v of degree less
+ * than window, where g is the transition function and s is the base
+ * state.
+ */
+    struct F2P_JUMP_WINDOW_T {
+        int window;
+        int size;
+        const f2p_state_ops_t *ops;
+        unsigned char *table;
+    };
+
+    typedef struct F2P_JUMP_WINDOW_T f2p_jump_window_t;
+
+    int f2p_jump_window_size(int degree);
+
+    void f2p_jump_window_init(f2p_jump_window_t *win,
+                              const f2p_state_ops_t *ops,
+                              const void *state, int window);
+
+    void f2p_jump_window_apply(void *result, const f2p_jump_window_t *win,
+                               mpz_t jump);
+
+    void f2p_jump_window_clear(f2p_jump_window_t *win);
+
+    void f2p_jump_apply(void *state, const f2p_state_ops_t *ops,
+                        mpz_t jump, int window);
+
+/**
+ * table of jump polynomials x^(stride * 2^i) mod minpoly,
+ * 0 <= i < size.
+ */
+    struct F2P_JUMP_TABLE_T {
+        int size;
+        mpz_t minpoly;
+        mpz_t stride;
+        mpz_t *table;
+    };
+
+    typedef struct F2P_JUMP_TABLE_T f2p_jump_table_t;
+
+    void f2p_jump_table_init(f2p_jump_table_t *table, mpz_t minpoly,
+                             mpz_t stride, int size);
+
+    void f2p_jump_table_clear(f2p_jump_table_t *table);
+
+    void f2p_jump_table_calc(mpz_t jump, f2p_jump_table_t *table,
+                             mpz_t step);
+
+    int f2p_jump_table_write(FILE *fp, f2p_jump_table_t *table);
+
+    int f2p_jump_table_read(FILE *fp, f2p_jump_table_t *table);
+
+    void f2p_calc_jump_series(mpz_t *out, mpz_t minpoly, mpz_t step, int n,
+                              int num_threads);
+
+    void f2p_jump_streams(void *states, const void *base,
+                          const f2p_state_ops_t *ops,
+                          mpz_t minpoly, mpz_t stride, int n,
+                          int num_threads);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_JUMP_H
@@ -0,0 +1,444 @@
+#pragma once
+#ifndef F2P_LIMB_H
+#define F2P_LIMB_H
+/**
+ * @file f2p_limb.h
+ *
+ * @brief internal limb level functions for F2 polynomials.
+ *
+ * A polynomial is an array of limbs, coefficient of x^i is bit
+ * (i % F2P_LIMB_BITS) of limb (i / F2P_LIMB_BITS). Arrays are given
+ * by pointer and number of limbs, like mpn functions of GMP.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include <gmp.h>
+#include <string.h>
+
+#if GMP_NAIL_BITS != 0
+#error "f2p_limb.h does not support nail bits"
+#endif
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+    enum {
+        F2P_LIMB_BITS = GMP_NUMB_BITS
+    };
+
+/**
+ * degree of nonzero limb
+ *
+ *@param x nonzero limb
+ *@return position of the highest set bit
+ */
+    static inline int f2p_limb_degree(mp_limb_t x)
+    {
+#if defined(__GNUC__)
+        if (sizeof(mp_limb_t) == sizeof(unsigned long)) {
+            return (int)(sizeof(unsigned long) * 8) - 1
+                - __builtin_clzl((unsigned long)x);
+        }
+        if (sizeof(mp_limb_t) == sizeof(unsigned long long)) {
+            return (int)(sizeof(unsigned long long) * 8) - 1
+                - __builtin_clzll((unsigned long long)x);
+        }
+#endif
+        int d = 0;
+        while (x >>= 1) {
+            d++;
+        }
+        return d;
+    }
+
+/**
+ * number of limbs without leading zero limbs
+ *
+ *@param p polynomial
+ *@param n number of limbs
+ *@return normalized number of limbs
+ */
+    static inline int f2p_limb_normalize(const mp_limb_t *p, int n)
+    {
+        while (n > 0 && p[n - 1] == 0) {
+            n--;
+        }
+        return n;
+    }
+
+/**
+ * degree of polynomial
+ *
+ *@param p polynomial
+ *@param n normalized number of limbs
+ *@return degree, -1 for zero polynomial
+ */
+    static inline int f2p_limb_poly_degree(const mp_limb_t *p, int n)
+    {
+        if (n == 0) {
+            return -1;
+        }
+        return (n - 1) * F2P_LIMB_BITS + f2p_limb_degree(p[n - 1]);
+    }
+
+/**
+ * coefficients of x^pos, ..., x^(pos + F2P_LIMB_BITS - 1)
+ *
+ *@param p polynomial
+ *@param n number of limbs
+ *@param pos position of the lowest bit, can be negative
+ *@return coefficients packed in one limb
+ */
+    static inline mp_limb_t f2p_limb_get_bits(const mp_limb_t *p, int n,
+                                              int pos)
+    {
+        const int w = F2P_LIMB_BITS;
+        if (pos < 0) {
+            if (pos <= -w) {
+                return 0;
+            }
+            return n > 0 ? p[0] << -pos : 0;
+        }
+        int k = pos / w;
+        int s = pos % w;
+        mp_limb_t lo = k < n ? p[k] : 0;
+        if (s == 0) {
+            return lo;
+        }
+        mp_limb_t hi = k + 1 < n ? p[k + 1] : 0;
+        return (lo >> s) | (hi << (w - s));
+    }
+
+/**
+ * r ^= a * x^shift
+ *
+ * Limbs of r above the result are not touched, so r needs only
+ * limbs up to the degree of a * x^shift.
+ *
+ *@param r result
+ *@param a polynomial
+ *@param an number of limbs of a
+ *@param shift shift in bits
+ */
+    static inline void f2p_limb_xor_shift(mp_limb_t *r, const mp_limb_t *a,
+                                          int an, int shift)
+    {
+        const int w = F2P_LIMB_BITS;
+        int k = shift / w;
+        int s = shift % w;
+        if (s == 0) {
+            for (int i = 0; i < an; i++) {
+                r[i + k] ^= a[i];
+            }
+            return;
+        }
+        mp_limb_t carry = 0;
+        for (int i = 0; i < an; i++) {
+            r[i + k] ^= (a[i] << s) | carry;
+            carry = a[i] >> (w - s);
+        }
+        if (carry != 0) {
+            r[an + k] ^= carry;
+        }
+    }
+
+/**
+ * r = a * x^-shift, lower terms are discarded
+ *
+ *@param r result, can be a
+ *@param a polynomial
+ *@param an number of limbs of a
+ *@param shift shift in bits
+ *@return number of limbs of r
+ */
+    static inline int f2p_limb_rshift(mp_limb_t *r, const mp_limb_t *a,
+                                      int an, int shift)
+    {
+        const int w = F2P_LIMB_BITS;
+        int k = shift / w;
+        int s = shift % w;
+        if (k >= an) {
+            return 0;
+        }
+        int rn = an - k;
+        if (s == 0) {
+            memmove(r, a + k, (size_t)rn * sizeof(mp_limb_t));
+        } else {
+            for (int i = 0; i < rn - 1; i++) {
+                r[i] = (a[i + k] >> s) | (a[i + k + 1] << (w - s));
+            }
+            r[rn - 1] = a[an - 1] >> s;
+        }
+        return f2p_limb_normalize(r, rn);
+    }
+
+/**
+ * carry-less product of two limbs
+ *
+ * four bits window of b with correction of bits of a shifted out
+ * of the table.
+ *
+ *@param hi upper half of the product
+ *@param a limb
+ *@param b limb
+ *@return lower half of the product
+ */
+    static inline mp_limb_t f2p_limb_clmul(mp_limb_t *hi, mp_limb_t a,
+                                           mp_limb_t b)
+    {
+        const int w = F2P_LIMB_BITS;
+        mp_limb_t u[16];
+        u[0] = 0;
+        u[1] = a;
+        for (int i = 2; i < 16; i += 2) {
+            u[i] = u[i / 2] << 1;
+            u[i + 1] = u[i] ^ a;
+        }
+        mp_limb_t l = u[b >> (w - 4)];
+        mp_limb_t h = 0;
+        for (int i = w - 8; i >= 0; i -= 4) {
+            h = (h << 4) | (l >> (w - 4));
+            l = (l << 4) ^ u[(b >> i) & 15];
+        }
+        // bits w-1, w-2, w-3 of a are lost in u[]
+        const mp_limb_t m = ~(GMP_NUMB_MAX / 15);
+        mp_limb_t v = b;
+        for (int j = 1; j < 4; j++) {
+            v = (v & m) >> 1;
+            h ^= v & (0 - ((a >> (w - j)) & 1));
+        }
+        *hi = h;
+        return l;
+    }
+
+/**
+ * square of limb
+ *
+ *@param hi upper half of the square
+ *@param a limb
+ *@return lower half of the square
+ */
+    static inline mp_limb_t f2p_limb_sqr(mp_limb_t *hi, mp_limb_t a)
+    {
+#if GMP_NUMB_BITS == 64
+        mp_limb_t x[2] = {a & 0xffffffffu, a >> 32};
+        for (int i = 0; i < 2; i++) {
+            mp_limb_t y = x[i];
+            y = (y | (y << 16)) & 0x0000ffff0000ffffu;
+            y = (y | (y << 8)) & 0x00ff00ff00ff00ffu;
+            y = (y | (y << 4)) & 0x0f0f0f0f0f0f0f0fu;
+            y = (y | (y << 2)) & 0x3333333333333333u;
+            y = (y | (y << 1)) & 0x5555555555555555u;
+            x[i] = y;
+        }
+        *hi = x[1];
+        return x[0];
+#else
+        return f2p_limb_clmul(hi, a, a);
+#endif
+    }
+
+/**
+ * r = a * b
+ *
+ *@param r result of an + bn limbs, must not overlap a or b
+ *@param a polynomial
+ *@param an number of limbs of a
+ *@param b polynomial
+ *@param bn number of limbs of b
+ */
+    static inline void f2p_limb_mul_basecase(mp_limb_t *r,
+                                             const mp_limb_t *a, int an,
+                                             const mp_limb_t *b, int bn)
+    {
+        memset(r, 0, (size_t)(an + bn) * sizeof(mp_limb_t));
+        for (int i = 0; i < an; i++) {
+            if (a[i] == 0) {
+                continue;
+            }
+            for (int j = 0; j < bn; j++) {
+                mp_limb_t hi;
+                mp_limb_t lo = f2p_limb_clmul(&hi, a[i], b[j]);
+                r[i + j] ^= lo;
+                r[i + j + 1] ^= hi;
+            }
+        }
+    }
+
+/**
+ * r = a * a
+ *
+ *@param r result of 2 * an limbs, must not overlap a
+ *@param a polynomial
+ *@param an number of limbs of a
+ */
+    static inline void f2p_limb_sqr_basecase(mp_limb_t *r,
+                                             const mp_limb_t *a, int an)
+    {
+        for (int i = 0; i < an; i++) {
+            r[2 * i] = f2p_limb_sqr(&r[2 * i + 1], a[i]);
+        }
+    }
+
+/**
+ * table of a * k for polynomials k of degree less than four
+ *
+ *@param table result of 16 * (an + 1) limbs, entry k starts at
+ * table + k * (an + 1)
+ *@param a polynomial
+ *@param an number of limbs of a
+ */
+    static inline void f2p_limb_comb_table(mp_limb_t *table,
+                                           const mp_limb_t *a, int an)
+    {
+        const int w = F2P_LIMB_BITS;
+        int tn = an + 1;
+        for (int j = 0; j < tn; j++) {
+            table[j] = 0;
+            table[tn + j] = j < an ? a[j] : 0;
+        }
+        for (int k = 2; k < 16; k++) {
+            mp_limb_t *t = table + k * tn;
+            const mp_limb_t *h = table + (k / 2) * tn;
+            mp_limb_t carry = 0;
+            for (int j = 0; j < tn; j++) {
+                t[j] = (h[j] << 1) | carry;
+                carry = h[j] >> (w - 1);
+            }
+            if (k & 1) {
+                for (int j = 0; j < an; j++) {
+                    t[j] ^= a[j];
+                }
+            }
+        }
+    }
+
+/**
+ * r ^= limbs lo, ..., hi - 1 of a * b by the comb method
+ *
+ * Four bits of every limb of a are taken at a time from the top, the
+ * entries of the table are added to the accumulator at limb
+ * offsets, and the accumulator is shifted by four bits.  Only limbs
+ * of the accumulator which reach the requested limbs are updated.
+ *
+ *@param r result of hi - lo limbs
+ *@param lo lowest limb of the product
+ *@param hi highest limb of the product plus one
+ *@param a polynomial
+ *@param an number of limbs of a
+ *@param table table of b made by f2p_limb_comb_table
+ *@param tn number of limbs of an entry of table
+ *@param acc work space of hi - lo + 1 limbs
+ */
+    static inline void f2p_limb_comb_mul(mp_limb_t *r, int lo, int hi,
+                                         const mp_limb_t *a, int an,
+                                         const mp_limb_t *table, int tn,
+                                         mp_limb_t *acc)
+    {
+        const int w = F2P_LIMB_BITS;
+        int base = lo > 0 ? lo - 1 : 0;
+        int n = hi - base;
+        if (n <= 0) {
+            return;
+        }
+        for (int j = 0; j < n; j++) {
+            acc[j] = 0;
+        }
+        for (int s = w - 4; s >= 0; s -= 4) {
+            for (int i = 0; i < an; i++) {
+                unsigned k = (unsigned)(a[i] >> s) & 15;
+                if (k == 0) {
+                    continue;
+                }
+                const mp_limb_t *t = table + k * tn;
+                int j0 = base - i > 0 ? base - i : 0;
+                int j1 = hi - i < tn ? hi - i : tn;
+                mp_limb_t *p = acc + i - base;
+                for (int j = j0; j < j1; j++) {
+                    p[j] ^= t[j];
+                }
+            }
+            if (s > 0) {
+                for (int j = n - 1; j > 0; j--) {
+                    acc[j] = (acc[j] << 4) | (acc[j - 1] >> (w - 4));
+                }
+                acc[0] <<= 4;
+            }
+        }
+        for (int j = lo; j < hi; j++) {
+            r[j - lo] ^= acc[j - base];
+        }
+    }
+
+/**
+ * r %= b, quotient is added to q when q is not NULL
+ *
+ * Each step computes up to F2P_LIMB_BITS bits of quotient from the
+ * top limb of r and the top limb of b, and then subtracts the
+ * product of the quotient limb and b.
+ *
+ *@param q quotient, must have rn - bn + 1 limbs and be cleared by caller
+ *@param r dividend and remainder
+ *@param rn number of limbs of r
+ *@param b nonzero divisor
+ *@param bn normalized number of limbs of b
+ *@param tmp work space of bn + 1 limbs
+ *@return normalized number of limbs of remainder
+ */
+    static inline int f2p_limb_divrem(mp_limb_t *q, mp_limb_t *r, int rn,
+                                      const mp_limb_t *b, int bn,
+                                      mp_limb_t *tmp)
+    {
+        const int w = F2P_LIMB_BITS;
+        int db = f2p_limb_poly_degree(b, bn);
+        // top w coefficients of b, leading term at bit w - 1
+        mp_limb_t bt = f2p_limb_get_bits(b, bn, db - (w - 1));
+        rn = f2p_limb_normalize(r, rn);
+        int dr = f2p_limb_poly_degree(r, rn);
+        while (dr >= db) {
+            int k = dr - db + 1;
+            if (k > w) {
+                k = w;
+            }
+            mp_limb_t t = f2p_limb_get_bits(r, rn, dr - (w - 1));
+            mp_limb_t qt = 0;
+            for (int i = 0; i < k; i++) {
+                if ((t >> (w - 1 - i)) & 1) {
+                    qt |= (mp_limb_t)1 << (k - 1 - i);
+                    t ^= bt >> i;
+                }
+            }
+            int shift = dr - db - (k - 1);
+            mp_limb_t hi = 0;
+            for (int j = 0; j < bn; j++) {
+                mp_limb_t h;
+                tmp[j] = f2p_limb_clmul(&h, qt, b[j]) ^ hi;
+                hi = h;
+            }
+            tmp[bn] = hi;
+            f2p_limb_xor_shift(r, tmp, f2p_limb_normalize(tmp, bn + 1),
+                               shift);
+            if (q != NULL) {
+                f2p_limb_xor_shift(q, &qt, 1, shift);
+            }
+            rn = f2p_limb_normalize(r, rn);
+            dr = f2p_limb_poly_degree(r, rn);
+        }
+        return rn;
+    }
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_LIMB_H
@@ -0,0 +1,382 @@
+/**
+ * @file f2p_multimod.c
+ *
+ * @brief Reduction of one polynomial modulo many polynomials by
+ * product tree and remainder tree.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_multimod.h"
+#include "f2p_limb.h"
+#include "debug_f2p.h"
+#include <stdlib.h>
+
+/**
+ * division by reciprocal is used when both degrees of modulus and
+ * quotient are at least this number.
+ */
+enum {
+    NEWTON_THRESHOLD = F2P_KARATSUBA_THRESHOLD * F2P_LIMB_BITS
+};
+
+/**
+ * reverse order of bits in a limb
+ */
+static mp_limb_t limb_bitrev(mp_limb_t x)
+{
+    for (int s = F2P_LIMB_BITS / 2; s > 0; s /= 2) {
+        mp_limb_t mask = ~(mp_limb_t)0 / (((mp_limb_t)1 << s) + 1);
+        x = ((x >> s) & mask) | ((x & mask) << s);
+    }
+    return x;
+}
+
+/**
+ * r = t^d a(1/t), reverse of coefficients as a polynomial of degree d
+ *
+ * use 1 wm
+ *
+ *@param r result, can be a
+ *@param a polynomial whose degree is d or less
+ *@param d degree
+ *@param wm working memory
+ */
+static void reverse(mpz_t r, mpz_t a, int d, f2p_wm_t *wm)
+{
+    int n = d / F2P_LIMB_BITS + 1;
+    int an = mpz_size(a);
+    assert(an <= n);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mp_limb_t *xp = mpz_limbs_write(*x, n);
+    const mp_limb_t *ap = mpz_limbs_read(a);
+    for (int i = 0; i < n; i++) {
+        xp[n - 1 - i] = i < an ? limb_bitrev(ap[i]) : 0;
+    }
+    int xn = f2p_limb_rshift(xp, xp, n, n * F2P_LIMB_BITS - 1 - d);
+    mpz_limbs_finish(*x, xn);
+    mpz_swap(r, *x);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * a %= mod by limb division, for small quotients or moduli
+ *
+ * use 1 wm
+ */
+static void small_mod(mpz_t a, mpz_t mod, f2p_wm_t *wm)
+{
+    int an = mpz_size(a);
+    int bn = mpz_size(mod);
+    if (an < bn) {
+        return;
+    }
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *tmp = mpz_limbs_write(*f2p_wm_alloc(wm), bn + 1);
+    mp_limb_t *ap = mpz_limbs_modify(a, an);
+    an = f2p_limb_divrem(NULL, ap, an, mpz_limbs_read(mod), bn, tmp);
+    mpz_limbs_finish(a, an);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * reciprocal of mod for division.
+ *
+ * inv = rev(mod)^-1 mod t^prec, where rev(mod) is mod reversed as a
+ * polynomial of degree of mod. Calculated by Newton iteration
+ * g = rev(mod) * g^2 mod t^2k, which doubles the precision.
+ *
+ * use 5 wm
+ *
+ *@param inv result
+ *@param mod nonzero modulus
+ *@param prec precision, prec >= 1
+ *@param wm working memory
+ */
+void f2p_reciprocal(mpz_t inv, mpz_t mod, int prec, f2p_wm_t *wm)
+{
+    int zcmp = mpz_cmp_ui(mod, 0);
+    assert(zcmp != 0); // zero divide
+    assert(prec >= 1);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *f = f2p_wm_alloc(wm);
+    mpz_t *g = f2p_wm_alloc(wm);
+    mpz_t *ft = f2p_wm_alloc(wm);
+    reverse(*f, mod, f2p_degree(mod), wm); // 1 wm
+    // precisions from prec down to 1, at most 32 steps for int prec
+    int steps[32];
+    int num = 0;
+    for (int p = prec; p > 1; p = (p + 1) / 2) {
+        steps[num++] = p;
+    }
+    mpz_set_ui(*g, 1);
+    for (int i = num - 1; i >= 0; i--) {
+        int p = steps[i];
+        f2p_square(*g, *g, wm); // 1 wm
+        mpz_tdiv_r_2exp(*ft, *f, p);
+        f2p_mul(*g, *g, *ft, wm); // 3 wm
+        mpz_tdiv_r_2exp(*g, *g, p);
+    }
+    mpz_swap(inv, *g);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * a %= mod by reciprocal of mod.
+ *
+ * Degree of quotient, degree of a - degree of mod, should be less
+ * than prec. Small divisions are done by limb division.
+ *
+ * use 6 wm
+ *
+ *@param a dividend and result
+ *@param mod nonzero modulus
+ *@param inv f2p_reciprocal(inv, mod, prec)
+ *@param prec precision of inv
+ *@param wm working memory
+ */
+void f2p_mod_reciprocal(mpz_t a, mpz_t mod, mpz_t inv, int prec,
+                        f2p_wm_t *wm)
+{
+    int zcmp = mpz_cmp_ui(mod, 0);
+    assert(zcmp != 0); // zero divide
+    if (mpz_cmp_ui(a, 0) == 0) {
+        return;
+    }
+    int d = f2p_degree(mod);
+    int n = f2p_degree(a);
+    if (n < d) {
+        return;
+    }
+    int e = n - d;
+    if (d < NEWTON_THRESHOLD || e < NEWTON_THRESHOLD) {
+        small_mod(a, mod, wm); // 1 wm
+        return;
+    }
+    assert(e < prec);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *q = f2p_wm_alloc(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    // rev(q) = rev(a) * inv mod t^(e + 1)
+    mpz_tdiv_q_2exp(*q, a, d);
+    reverse(*q, *q, e, wm); // 1 wm
+    mpz_tdiv_r_2exp(*x, inv, e + 1);
+    f2p_mul(*q, *q, *x, wm); // 3 wm
+    mpz_tdiv_r_2exp(*q, *q, e + 1);
+    reverse(*q, *q, e, wm); // 1 wm
+    f2p_mul(*x, *q, mod, wm); // 3 wm
+    mpz_xor(a, a, *x);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * a %= mod, large divisions are done by reciprocal of mod.
+ *
+ * use 7 wm
+ *
+ *@param a dividend and result
+ *@param mod nonzero modulus
+ *@param wm working memory
+ */
+void f2p_mod_newton(mpz_t a, mpz_t mod, f2p_wm_t *wm)
+{
+    int zcmp = mpz_cmp_ui(mod, 0);
+    assert(zcmp != 0); // zero divide
+    if (mpz_cmp_ui(a, 0) == 0) {
+        return;
+    }
+    int d = f2p_degree(mod);
+    int e = f2p_degree(a) - d;
+    if (e < 0) {
+        return;
+    }
+    if (d < NEWTON_THRESHOLD || e < NEWTON_THRESHOLD) {
+        small_mod(a, mod, wm); // 1 wm
+        return;
+    }
+    int mark = f2p_wm_mark(wm);
+    mpz_t *inv = f2p_wm_alloc(wm);
+    f2p_reciprocal(*inv, mod, e + 1, wm); // 5 wm
+    f2p_mod_reciprocal(a, mod, *inv, e + 1, wm); // 6 wm
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * initialize product tree of moduli
+ *
+ *@param tree product tree
+ *@param mods nonzero moduli
+ *@param count number of moduli, count >= 1
+ */
+void f2p_prodtree_init(f2p_prodtree_t *tree, mpz_t *mods, int count)
+{
+    PUTS("f2p_prodtree_init start\n");
+    assert(count >= 1);
+    int levels = 1;
+    for (int w = count; w > 1; w = (w + 1) / 2) {
+        levels++;
+    }
+    tree->count = count;
+    tree->levels = levels;
+    tree->width = malloc(levels * sizeof(int));
+    tree->node = malloc(levels * sizeof(f2p_prodtree_node_t *));
+    assert(tree->width != NULL && tree->node != NULL);
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    int w = count;
+    for (int l = 0; l < levels; l++) {
+        tree->width[l] = w;
+        tree->node[l] = malloc(w * sizeof(f2p_prodtree_node_t));
+        assert(tree->node[l] != NULL);
+        for (int i = 0; i < w; i++) {
+            f2p_prodtree_node_t *node = &tree->node[l][i];
+            mpz_init(node->prod);
+            mpz_init(node->inv);
+            node->prec = 0;
+            if (l == 0) {
+                int zcmp = mpz_cmp_ui(mods[i], 0);
+                assert(zcmp != 0); // zero divide
+                mpz_set(node->prod, mods[i]);
+            } else if (2 * i + 1 < tree->width[l - 1]) {
+                f2p_mul(node->prod, tree->node[l - 1][2 * i].prod,
+                        tree->node[l - 1][2 * i + 1].prod, wm); // 3 wm
+            } else {
+                mpz_set(node->prod, tree->node[l - 1][2 * i].prod);
+            }
+        }
+        w = (w + 1) / 2;
+    }
+    // residues given to a node have smaller degree than its parent
+    for (int l = 0; l < levels; l++) {
+        for (int i = 0; i < tree->width[l]; i++) {
+            f2p_prodtree_node_t *node = &tree->node[l][i];
+            int d = f2p_degree(node->prod);
+            int e = d;
+            if (l + 1 < levels) {
+                e = f2p_degree(tree->node[l + 1][i / 2].prod) - d;
+            }
+            if (d >= NEWTON_THRESHOLD && e >= NEWTON_THRESHOLD) {
+                node->prec = e;
+                f2p_reciprocal(node->inv, node->prod, e, wm); // 5 wm
+            }
+        }
+    }
+    f2p_wm_release(wm, mark);
+    PUTS("f2p_prodtree_init end\n");
+}
+
+/**
+ * clear product tree
+ *
+ *@param tree product tree
+ */
+void f2p_prodtree_clear(f2p_prodtree_t *tree)
+{
+    for (int l = 0; l < tree->levels; l++) {
+        for (int i = 0; i < tree->width[l]; i++) {
+            mpz_clear(tree->node[l][i].prod);
+            mpz_clear(tree->node[l][i].inv);
+        }
+        free(tree->node[l]);
+    }
+    free(tree->node);
+    free(tree->width);
+    tree->count = 0;
+    tree->levels = 0;
+}
+
+/**
+ * reduce a residue of the parent modulo a node and its descendants
+ *
+ * use 7 wm for each level
+ */
+static void remainder_tree(mpz_t *r, mpz_t a, const f2p_prodtree_t *tree,
+                           int level, int index, f2p_wm_t *wm)
+{
+    f2p_prodtree_node_t *node = &tree->node[level][index];
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_set(*x, a);
+    if (node->prec > 0) {
+        f2p_mod_reciprocal(*x, node->prod, node->inv, node->prec,
+                           wm); // 6 wm
+    } else if (mpz_cmp_ui(*x, 0) != 0
+               && f2p_degree(*x) >= f2p_degree(node->prod)) {
+        small_mod(*x, node->prod, wm); // 1 wm
+    }
+    if (level == 0) {
+        mpz_swap(r[index], *x);
+    } else {
+        remainder_tree(r, *x, tree, level - 1, 2 * index, wm);
+        if (2 * index + 1 < tree->width[level - 1]) {
+            remainder_tree(r, *x, tree, level - 1, 2 * index + 1, wm);
+        }
+    }
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * r[i] = a % mods[i] for all moduli of product tree
+ *
+ *@param r array of tree->count results
+ *@param a polynomial
+ *@param tree product tree of moduli
+ */
+void f2p_multimod_prodtree(mpz_t *r, mpz_t a, const f2p_prodtree_t *tree)
+{
+    PUTS("f2p_multimod_prodtree start\n");
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    int top = tree->levels - 1;
+    f2p_prodtree_node_t *root = &tree->node[top][0];
+    int d = f2p_degree(root->prod);
+    f2p_wm_reserve(wm, 2 * d + 2 * GMP_NUMB_BITS);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_set(*x, a);
+    if (mpz_cmp_ui(*x, 0) != 0 && (int)f2p_degree(*x) >= d) {
+        int e = f2p_degree(*x) - d;
+        if (e < root->prec) {
+            f2p_mod_reciprocal(*x, root->prod, root->inv, root->prec,
+                               wm); // 6 wm
+        } else {
+            f2p_mod_newton(*x, root->prod, wm); // 7 wm
+        }
+    }
+    if (top == 0) {
+        mpz_swap(r[0], *x);
+    } else {
+        remainder_tree(r, *x, tree, top - 1, 0, wm);
+        if (tree->width[top - 1] > 1) {
+            remainder_tree(r, *x, tree, top - 1, 1, wm);
+        }
+    }
+    f2p_wm_release(wm, mark);
+    PUTS("f2p_multimod_prodtree end\n");
+}
+
+/**
+ * r[i] = a % mods[i] for 0 <= i < count
+ *
+ * When the same moduli are used many times, use f2p_prodtree_init
+ * and f2p_multimod_prodtree.
+ *
+ *@param r array of count results
+ *@param a polynomial
+ *@param mods nonzero moduli
+ *@param count number of moduli
+ */
+void f2p_multimod(mpz_t *r, mpz_t a, mpz_t *mods, int count)
+{
+    f2p_prodtree_t tree;
+    f2p_prodtree_init(&tree, mods, count);
+    f2p_multimod_prodtree(r, a, &tree);
+    f2p_prodtree_clear(&tree);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef F2P_MULTIMOD_H
+#define F2P_MULTIMOD_H
+/**
+ * @file f2p_multimod.h
+ *
+ * @brief Reduction of one polynomial modulo many polynomials by
+ * product tree and remainder tree.
+ *
+ * The product tree has the moduli as leaves, and each node is the
+ * product of its children. The remainder tree reduces a polynomial
+ * modulo the root, then each residue modulo a node is reduced modulo
+ * its children. Large divisions are done by multiplication with
+ * reciprocals computed by Newton iteration, so the total cost is
+ * O(M(n) log n) for the total degree n of the moduli.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * node of product tree
+ */
+    struct F2P_PRODTREE_NODE_T {
+        mpz_t prod;  // product of leaves under the node
+        mpz_t inv;   // reciprocal of prod, see f2p_reciprocal
+        int prec;    // precision of inv, 0 if limb division is used
+    };
+
+    typedef struct F2P_PRODTREE_NODE_T f2p_prodtree_node_t;
+
+/**
+ * product tree, node[0] are leaves and node[levels - 1][0] is root.
+ * A node without sibling is copied to the upper level.
+ */
+    struct F2P_PRODTREE_T {
+        int count;                   // number of moduli
+        int levels;                  // number of levels
+        int *width;                  // number of nodes of each level
+        f2p_prodtree_node_t **node;  // node[level][index]
+    };
+
+    typedef struct F2P_PRODTREE_T f2p_prodtree_t;
+
+    void f2p_reciprocal(mpz_t inv, mpz_t mod, int prec, f2p_wm_t *wm);
+
+    void f2p_mod_reciprocal(mpz_t a, mpz_t mod, mpz_t inv, int prec,
+                            f2p_wm_t *wm);
+
+    void f2p_mod_newton(mpz_t a, mpz_t mod, f2p_wm_t *wm);
+
+    void f2p_prodtree_init(f2p_prodtree_t *tree, mpz_t *mods, int count);
+
+    void f2p_prodtree_clear(f2p_prodtree_t *tree);
+
+    void f2p_multimod_prodtree(mpz_t *r, mpz_t a,
+                               const f2p_prodtree_t *tree);
+
+    void f2p_multimod(mpz_t *r, mpz_t a, mpz_t *mods, int count);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_MULTIMOD_H
@@ -0,0 +1,917 @@
+/**
+ * @file f2p_poly.c
+ *
+ * @brief F2 polynomial type independent of mpz.
+ *
+ * Work space of functions is taken from slots of f2p_wm_t as limb
+ * arrays by mpz_limbs_write, so the same working memory is shared
+ * with f2p_gmp.c.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_poly.h"
+#include "f2p_limb.h"
+#include "debug_f2p.h"
+#include <limits.h>
+#include <string.h>
+
+/**
+ * take limb array of n limbs from working memory.
+ * the value of the array is undefined.
+ *
+ * use 1 wm
+ */
+static mp_limb_t * wm_limbs(f2p_wm_t *wm, int n)
+{
+    mpz_t *slot = f2p_wm_alloc(wm);
+    return mpz_limbs_write(*slot, n > 0 ? n : 1);
+}
+
+/**
+ * set size and degree after limbs are written.
+ */
+static void poly_finish(f2p_poly_t *p, int n)
+{
+    p->size = f2p_limb_normalize(p->limb, n);
+    p->degree = f2p_limb_poly_degree(p->limb, p->size);
+}
+
+/**
+ * r = limbs
+ */
+static void poly_set_limbs(f2p_poly_t *r, const mp_limb_t *src, int n)
+{
+    n = f2p_limb_normalize(src, n);
+    f2p_poly_reserve(r, n);
+    if (n > 0) {
+        memmove(r->limb, src, (size_t)n * sizeof(mp_limb_t));
+    }
+    poly_finish(r, n);
+}
+
+/**
+ * read only polynomial of limbs
+ */
+static void poly_view(f2p_poly_t *view, mp_limb_t *src, int n)
+{
+    view->limb = src;
+    view->capacity = 0;
+    poly_finish(view, n);
+}
+
+/**
+ * Initialization of polynomial, value is 0.
+ *
+ *@param p polynomial
+ */
+void f2p_poly_init(f2p_poly_t *p)
+{
+    p->limb = NULL;
+    p->size = 0;
+    p->capacity = 0;
+    p->degree = -1;
+}
+
+/**
+ * Initialization of polynomial with space for bits coefficients.
+ *
+ *@param p polynomial
+ *@param bits number of coefficients
+ */
+void f2p_poly_init2(f2p_poly_t *p, mp_bitcnt_t bits)
+{
+    f2p_poly_init(p);
+    f2p_poly_reserve(p, (int)((bits + F2P_LIMB_BITS - 1) / F2P_LIMB_BITS));
+}
+
+/**
+ * free limbs of polynomial
+ *
+ *@param p polynomial
+ */
+void f2p_poly_clear(f2p_poly_t *p)
+{
+    if (p->capacity > 0) {
+        void (*free_func)(void *, size_t);
+        mp_get_memory_functions(NULL, NULL, &free_func);
+        free_func(p->limb, (size_t)p->capacity * sizeof(mp_limb_t));
+    }
+    f2p_poly_init(p);
+}
+
+/**
+ * make room for limbs limbs.
+ *
+ * Limbs are allocated by memory functions of GMP. If p is a view,
+ * its limbs are copied to owned limbs.
+ *
+ *@param p polynomial
+ *@param limbs number of limbs
+ */
+void f2p_poly_reserve(f2p_poly_t *p, int limbs)
+{
+    if (p->capacity >= limbs && p->capacity > 0) {
+        return;
+    }
+    if (limbs < p->size) {
+        limbs = p->size;
+    }
+    if (limbs <= 0) {
+        limbs = 1;
+    }
+    size_t bytes = (size_t)limbs * sizeof(mp_limb_t);
+    if (p->capacity == 0) {
+        void *(*alloc_func)(size_t);
+        mp_get_memory_functions(&alloc_func, NULL, NULL);
+        mp_limb_t *limb = alloc_func(bytes);
+        if (p->size > 0) {
+            memcpy(limb, p->limb, (size_t)p->size * sizeof(mp_limb_t));
+        }
+        p->limb = limb;
+    } else {
+        void *(*realloc_func)(void *, size_t, size_t);
+        mp_get_memory_functions(NULL, &realloc_func, NULL);
+        p->limb = realloc_func(p->limb,
+                               (size_t)p->capacity * sizeof(mp_limb_t),
+                               bytes);
+    }
+    p->capacity = limbs;
+}
+
+/**
+ * r = a
+ *
+ *@param r result
+ *@param a polynomial
+ */
+void f2p_poly_set(f2p_poly_t *r, const f2p_poly_t *a)
+{
+    if (r == a) {
+        return;
+    }
+    poly_set_limbs(r, a->limb, a->size);
+}
+
+/**
+ * r = v, bit i of v is coefficient of x^i
+ *
+ *@param r result
+ *@param v coefficients
+ */
+void f2p_poly_set_ui(f2p_poly_t *r, unsigned long v)
+{
+    const int ulong_bits = (int)(sizeof(unsigned long) * CHAR_BIT);
+    f2p_poly_reserve(r, (ulong_bits + F2P_LIMB_BITS - 1) / F2P_LIMB_BITS);
+    int n = 0;
+    while (v != 0) {
+        r->limb[n++] = (mp_limb_t)v;
+        v = v >> (F2P_LIMB_BITS - 1) >> 1;
+    }
+    poly_finish(r, n);
+}
+
+/**
+ * exchange a and b
+ *
+ *@param a polynomial
+ *@param b polynomial
+ */
+void f2p_poly_swap(f2p_poly_t *a, f2p_poly_t *b)
+{
+    f2p_poly_t t = *a;
+    *a = *b;
+    *b = t;
+}
+
+/**
+ * r = z, sign of z is ignored.
+ *
+ *@param r result
+ *@param z polynomial as mpz
+ */
+void f2p_poly_set_mpz(f2p_poly_t *r, mpz_srcptr z)
+{
+    poly_set_limbs(r, mpz_limbs_read(z), (int)mpz_size(z));
+}
+
+/**
+ * z = p
+ *
+ *@param z result as mpz
+ *@param p polynomial
+ */
+void f2p_poly_get_mpz(mpz_ptr z, const f2p_poly_t *p)
+{
+    if (p->size == 0) {
+        mpz_set_ui(z, 0);
+        return;
+    }
+    mp_limb_t *d = mpz_limbs_write(z, p->size);
+    memcpy(d, p->limb, (size_t)p->size * sizeof(mp_limb_t));
+    mpz_limbs_finish(z, p->size);
+}
+
+/**
+ * make read only view of z without copy.
+ *
+ * view must not be used after z is modified or cleared.
+ * Modification of view copies limbs, and z is not changed.
+ * f2p_poly_clear is not necessary for view.
+ *
+ *@param view result
+ *@param z polynomial as mpz
+ */
+void f2p_poly_view_mpz(f2p_poly_t *view, mpz_srcptr z)
+{
+    poly_view(view, (mp_limb_t *)mpz_limbs_read(z), (int)mpz_size(z));
+}
+
+/**
+ * make read only mpz view of p without copy.
+ *
+ * view must not be modified nor cleared, and must not be used after
+ * p is modified or cleared.
+ *
+ *@param view mpz to be initialized as view
+ *@param p polynomial
+ *@return view
+ */
+mpz_srcptr f2p_poly_mpz_view(mpz_ptr view, const f2p_poly_t *p)
+{
+    return mpz_roinit_n(view, p->limb, p->size);
+}
+
+/**
+ * set coefficient of x^index to 1
+ *
+ *@param p polynomial
+ *@param index degree of term
+ */
+void f2p_poly_setbit(f2p_poly_t *p, int index)
+{
+    assert(index >= 0);
+    int k = index / F2P_LIMB_BITS;
+    int n = p->size;
+    f2p_poly_reserve(p, k + 1 > n ? k + 1 : n);
+    for (; n <= k; n++) {
+        p->limb[n] = 0;
+    }
+    p->limb[k] |= (mp_limb_t)1 << (index % F2P_LIMB_BITS);
+    poly_finish(p, n);
+}
+
+/**
+ * a == b
+ *
+ *@param a polynomial
+ *@param b polynomial
+ *@return 1 if a equals b, 0 otherwise
+ */
+int f2p_poly_equal(const f2p_poly_t *a, const f2p_poly_t *b)
+{
+    if (a->size != b->size) {
+        return 0;
+    }
+    if (a->size == 0) {
+        return 1;
+    }
+    return memcmp(a->limb, b->limb,
+                  (size_t)a->size * sizeof(mp_limb_t)) == 0;
+}
+
+/**
+ * r = a + b
+ *
+ *@param r result
+ *@param a polynomial
+ *@param b polynomial
+ */
+void f2p_poly_add(f2p_poly_t *r, const f2p_poly_t *a, const f2p_poly_t *b)
+{
+    if (a->size < b->size) {
+        const f2p_poly_t *t = a;
+        a = b;
+        b = t;
+    }
+    int an = a->size;
+    int bn = b->size;
+    f2p_poly_reserve(r, an);
+    for (int i = 0; i < bn; i++) {
+        r->limb[i] = a->limb[i] ^ b->limb[i];
+    }
+    if (r != a) {
+        for (int i = bn; i < an; i++) {
+            r->limb[i] = a->limb[i];
+        }
+    }
+    poly_finish(r, an);
+}
+
+/**
+ * r = a * x^n
+ *
+ *@param r result
+ *@param a polynomial
+ *@param n shift
+ */
+void f2p_poly_lshift(f2p_poly_t *r, const f2p_poly_t *a, int n)
+{
+    assert(n >= 0);
+    int an = a->size;
+    if (an == 0) {
+        poly_finish(r, 0);
+        return;
+    }
+    const int w = F2P_LIMB_BITS;
+    int k = n / w;
+    int s = n % w;
+    int rn = an + k + 1;
+    f2p_poly_reserve(r, rn);
+    const mp_limb_t *ap = a->limb;
+    mp_limb_t *rp = r->limb;
+    // from top, a can be r
+    if (s == 0) {
+        rp[an + k] = 0;
+        for (int i = an - 1; i >= 0; i--) {
+            rp[i + k] = ap[i];
+        }
+    } else {
+        rp[an + k] = ap[an - 1] >> (w - s);
+        for (int i = an - 1; i > 0; i--) {
+            rp[i + k] = (ap[i] << s) | (ap[i - 1] >> (w - s));
+        }
+        rp[k] = ap[0] << s;
+    }
+    for (int i = 0; i < k; i++) {
+        rp[i] = 0;
+    }
+    poly_finish(r, rn);
+}
+
+/**
+ * r = a / x^n, lower terms are discarded
+ *
+ *@param r result
+ *@param a polynomial
+ *@param n shift
+ */
+void f2p_poly_rshift(f2p_poly_t *r, const f2p_poly_t *a, int n)
+{
+    assert(n >= 0);
+    int an = a->size;
+    f2p_poly_reserve(r, an);
+    poly_finish(r, f2p_limb_rshift(r->limb, a->limb, an, n));
+}
+
+/**
+ * Calculate residue of polynomial a divided by b polynomial.
+ * a %= b
+ *
+ * use 1 wm
+ * @param a dividend and result
+ * @param b divisor
+ * @param wm shared working memory
+ */
+void f2p_poly_mod(f2p_poly_t *a, const f2p_poly_t *b, f2p_wm_t *wm)
+{
+    assert(b->size != 0); // zero divide
+    if (a == b) {
+        poly_finish(a, 0);
+        return;
+    }
+    if (a->degree < b->degree) {
+        return;
+    }
+    f2p_poly_reserve(a, a->size);
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *tmp = wm_limbs(wm, b->size + 1);
+    int n = f2p_limb_divrem(NULL, a->limb, a->size, b->limb, b->size, tmp);
+    poly_finish(a, n);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * Calculate r and q such that
+ * a = q * b + r (degree(r) < degree(b))
+ *
+ * use 3 wm
+ *
+ * @param q quotient
+ * @param r remainder
+ * @param a dividend
+ * @param b divisor
+ * @param wm shared working memory
+ */
+void f2p_poly_divrem(f2p_poly_t *q, f2p_poly_t *r, const f2p_poly_t *a,
+                     const f2p_poly_t *b, f2p_wm_t *wm)
+{
+    assert(b->size != 0); // zero divide
+    assert(q != r);
+    if (a->degree < b->degree) {
+        f2p_poly_set(r, a);
+        poly_finish(q, 0);
+        return;
+    }
+    int an = a->size;
+    int bn = b->size;
+    int qn = an - bn + 1;
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *rt = wm_limbs(wm, an);
+    mp_limb_t *qt = wm_limbs(wm, qn);
+    mp_limb_t *tmp = wm_limbs(wm, bn + 1);
+    memcpy(rt, a->limb, (size_t)an * sizeof(mp_limb_t));
+    memset(qt, 0, (size_t)qn * sizeof(mp_limb_t));
+    int rn = f2p_limb_divrem(qt, rt, an, b->limb, bn, tmp);
+    poly_set_limbs(r, rt, rn);
+    poly_set_limbs(q, qt, qn);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * Calculate r = a * b
+ *
+ * use 1 wm
+ *
+ * @param r result
+ * @param a polynomial
+ * @param b polynomial
+ * @param wm shared working memory
+ */
+void f2p_poly_mul(f2p_poly_t *r, const f2p_poly_t *a, const f2p_poly_t *b,
+                  f2p_wm_t *wm)
+{
+    if (a->size == 0 || b->size == 0) {
+        poly_finish(r, 0);
+        return;
+    }
+    int n = a->size + b->size;
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *t = wm_limbs(wm, n);
+    f2p_limb_mul_basecase(t, a->limb, a->size, b->limb, b->size);
+    poly_set_limbs(r, t, n);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * Calculate r = a * a
+ *
+ * use 1 wm
+ *
+ * @param r result
+ * @param a polynomial
+ * @param wm shared working memory
+ */
+void f2p_poly_square(f2p_poly_t *r, const f2p_poly_t *a, f2p_wm_t *wm)
+{
+    if (a->size == 0) {
+        poly_finish(r, 0);
+        return;
+    }
+    int n = 2 * a->size;
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *t = wm_limbs(wm, n);
+    f2p_limb_sqr_basecase(t, a->limb, a->size);
+    poly_set_limbs(r, t, n);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * Calculate r = (a * b) % mod
+ *
+ * use 2 wm
+ *
+ * @param r result
+ * @param a polynomial
+ * @param b polynomial
+ * @param mod modulus polynomial
+ * @param wm shared working memory
+ */
+void f2p_poly_mulmod(f2p_poly_t *r, const f2p_poly_t *a,
+                     const f2p_poly_t *b, const f2p_poly_t *mod,
+                     f2p_wm_t *wm)
+{
+    assert(mod->size != 0); // zero divide
+    if (a->size == 0 || b->size == 0) {
+        poly_finish(r, 0);
+        return;
+    }
+    int n = a->size + b->size;
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *t = wm_limbs(wm, n);
+    mp_limb_t *tmp = wm_limbs(wm, mod->size + 1);
+    f2p_limb_mul_basecase(t, a->limb, a->size, b->limb, b->size);
+    n = f2p_limb_divrem(NULL, t, n, mod->limb, mod->size, tmp);
+    poly_set_limbs(r, t, n);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * Calculate r = (a * a) % mod
+ *
+ * use 2 wm
+ *
+ * @param r result
+ * @param a polynomial
+ * @param mod modulus polynomial
+ * @param wm shared working memory
+ */
+void f2p_poly_pow2mod(f2p_poly_t *r, const f2p_poly_t *a,
+                      const f2p_poly_t *mod, f2p_wm_t *wm)
+{
+    assert(mod->size != 0); // zero divide
+    if (a->size == 0) {
+        poly_finish(r, 0);
+        return;
+    }
+    int n = 2 * a->size;
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *t = wm_limbs(wm, n);
+    mp_limb_t *tmp = wm_limbs(wm, mod->size + 1);
+    f2p_limb_sqr_basecase(t, a->limb, a->size);
+    n = f2p_limb_divrem(NULL, t, n, mod->limb, mod->size, tmp);
+    poly_set_limbs(r, t, n);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * calculate r = x^e % mod.
+ *
+ * left to right binary method.
+ *
+ * use 4 wm
+ *
+ * @param r residue polynomial whose degree is less than mod polynomial
+ * @param x polynomial
+ * @param e exponent (big integer)
+ * @param mod polynomial
+ * @param wm shared working memory
+ */
+void f2p_poly_powermod(f2p_poly_t *r, const f2p_poly_t *x, mpz_srcptr e,
+                       const f2p_poly_t *mod, f2p_wm_t *wm)
+{
+    assert(mod->size != 0); // zero divide
+    if (mpz_sgn(e) == 0) {
+        f2p_poly_set_ui(r, 1);
+        return;
+    }
+    int mn = mod->size;
+    int xn = x->size > mn ? x->size : mn;
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *s = wm_limbs(wm, xn);
+    mp_limb_t *acc = wm_limbs(wm, 2 * mn);
+    mp_limb_t *prod = wm_limbs(wm, 2 * mn);
+    mp_limb_t *tmp = wm_limbs(wm, mn + 1);
+    if (x->size > 0) {
+        memcpy(s, x->limb, (size_t)x->size * sizeof(mp_limb_t));
+    }
+    int sn = f2p_limb_divrem(NULL, s, x->size, mod->limb, mn, tmp);
+    memcpy(acc, s, (size_t)sn * sizeof(mp_limb_t));
+    int an = sn;
+    for (long i = (long)mpz_sizeinbase(e, 2) - 2; i >= 0 && an > 0; i--) {
+        f2p_limb_sqr_basecase(prod, acc, an);
+        an = f2p_limb_divrem(NULL, prod, 2 * an, mod->limb, mn, tmp);
+        if (mpz_tstbit(e, (mp_bitcnt_t)i)) {
+            f2p_limb_mul_basecase(acc, prod, an, s, sn);
+            an = f2p_limb_divrem(NULL, acc, an + sn, mod->limb, mn, tmp);
+        } else {
+            memcpy(acc, prod, (size_t)an * sizeof(mp_limb_t));
+        }
+    }
+    poly_set_limbs(r, acc, an);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * gcd of limb arrays, result is in r0 or r1.
+ *
+ *@return pointer to result, its size is stored in *n
+ */
+static mp_limb_t * gcd_n(int *n, mp_limb_t *r0, int n0, mp_limb_t *r1,
+                         int n1, mp_limb_t *tmp)
+{
+    while (n1 > 0) {
+        n0 = f2p_limb_divrem(NULL, r0, n0, r1, n1, tmp);
+        mp_limb_t *t = r0;
+        r0 = r1;
+        r1 = t;
+        int tn = n0;
+        n0 = n1;
+        n1 = tn;
+    }
+    *n = n0;
+    return r0;
+}
+
+/**
+ * gcd
+ * calculate gcd(x, y)
+ *
+ * use 3 wm
+ *
+ *@param gcd result polynomial
+ *@param x input polynomial
+ *@param y input polynomial
+ *@param wm
+ */
+void f2p_poly_gcd(f2p_poly_t *gcd, const f2p_poly_t *x,
+                  const f2p_poly_t *y, f2p_wm_t *wm)
+{
+    int n = x->size > y->size ? x->size : y->size;
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *r0 = wm_limbs(wm, n);
+    mp_limb_t *r1 = wm_limbs(wm, n);
+    mp_limb_t *tmp = wm_limbs(wm, n + 1);
+    if (x->size > 0) {
+        memcpy(r0, x->limb, (size_t)x->size * sizeof(mp_limb_t));
+    }
+    if (y->size > 0) {
+        memcpy(r1, y->limb, (size_t)y->size * sizeof(mp_limb_t));
+    }
+    int gn;
+    mp_limb_t *g = gcd_n(&gn, r0, x->size, r1, y->size, tmp);
+    poly_set_limbs(gcd, g, gn);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * r ^= q * a, limbs of r above rn are zero
+ *
+ *@return normalized number of limbs of r
+ */
+static int addmul_n(mp_limb_t *r, int rn, const mp_limb_t *q, int qn,
+                    const mp_limb_t *a, int an, mp_limb_t *prod)
+{
+    if (qn == 0 || an == 0) {
+        return rn;
+    }
+    f2p_limb_mul_basecase(prod, q, qn, a, an);
+    int pn = f2p_limb_normalize(prod, qn + an);
+    for (int i = 0; i < pn; i++) {
+        r[i] ^= prod[i];
+    }
+    return f2p_limb_normalize(r, rn > pn ? rn : pn);
+}
+
+/**
+ * extended euclid, b and c can be NULL.
+ *
+ * If m < 0, calculates a*x + b*y = c = GCD(x, y).
+ * Otherwise stops when degree of remainder c becomes less than m.
+ *
+ * use 10 wm
+ */
+static void exeuclid_aux(f2p_poly_t *a, f2p_poly_t *b, f2p_poly_t *c,
+                         const f2p_poly_t *x, const f2p_poly_t *y, int m,
+                         f2p_wm_t *wm)
+{
+    int n = x->size > y->size ? x->size : y->size;
+    int ln = x->size + y->size + 1;
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *r0 = wm_limbs(wm, n);
+    mp_limb_t *r1 = wm_limbs(wm, n);
+    mp_limb_t *q = wm_limbs(wm, n);
+    mp_limb_t *a0 = wm_limbs(wm, ln);
+    mp_limb_t *a1 = wm_limbs(wm, ln);
+    mp_limb_t *b0 = wm_limbs(wm, ln);
+    mp_limb_t *b1 = wm_limbs(wm, ln);
+    mp_limb_t *prod = wm_limbs(wm, n + ln);
+    mp_limb_t *tmp = wm_limbs(wm, n + 1);
+    memcpy(r0, x->limb, (size_t)x->size * sizeof(mp_limb_t));
+    memcpy(r1, y->limb, (size_t)y->size * sizeof(mp_limb_t));
+    memset(a0, 0, (size_t)ln * sizeof(mp_limb_t));
+    memset(a1, 0, (size_t)ln * sizeof(mp_limb_t));
+    memset(b0, 0, (size_t)ln * sizeof(mp_limb_t));
+    memset(b1, 0, (size_t)ln * sizeof(mp_limb_t));
+    a0[0] = 1;
+    b1[0] = 1;
+    int n0 = x->size;
+    int n1 = y->size;
+    int an0 = 1;
+    int an1 = 0;
+    int bn0 = 0;
+    int bn1 = 1;
+    while (n1 > 0) {
+        int qn = n0 - n1 + 1;
+        if (qn > 0) {
+            memset(q, 0, (size_t)qn * sizeof(mp_limb_t));
+        } else {
+            qn = 0;
+        }
+        n0 = f2p_limb_divrem(q, r0, n0, r1, n1, tmp);
+        qn = f2p_limb_normalize(q, qn);
+        an0 = addmul_n(a0, an0, q, qn, a1, an1, prod);
+        if (b != NULL) {
+            bn0 = addmul_n(b0, bn0, q, qn, b1, bn1, prod);
+        }
+        mp_limb_t *t;
+        int tn;
+        t = r0; r0 = r1; r1 = t;
+        tn = n0; n0 = n1; n1 = tn;
+        t = a0; a0 = a1; a1 = t;
+        tn = an0; an0 = an1; an1 = tn;
+        t = b0; b0 = b1; b1 = t;
+        tn = bn0; bn0 = bn1; bn1 = tn;
+        if (m >= 0 && f2p_limb_poly_degree(r1, n1) < m) {
+            break;
+        }
+    }
+    if (m >= 0) {
+        poly_set_limbs(a, a1, an1);
+        if (b != NULL) {
+            poly_set_limbs(b, b1, bn1);
+        }
+        if (c != NULL) {
+            poly_set_limbs(c, r1, n1);
+        }
+    } else {
+        poly_set_limbs(a, a0, an0);
+        if (b != NULL) {
+            poly_set_limbs(b, b0, bn0);
+        }
+        if (c != NULL) {
+            poly_set_limbs(c, r0, n0);
+        }
+    }
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * extended euclid
+ * calculate a, b, c for given x, y
+ * where a*x + b*y = c (c = GCD(x, y))
+ *
+ * use 10 wm
+ *
+ *@param a result polynomial
+ *@param b result polynomial
+ *@param c result polynomial GCD(x, y)
+ *@param x input polynomial
+ *@param y input polynomial
+ *@param wm
+ */
+void f2p_poly_exeuclid(f2p_poly_t *a, f2p_poly_t *b, f2p_poly_t *c,
+                       const f2p_poly_t *x, const f2p_poly_t *y,
+                       f2p_wm_t *wm)
+{
+    assert(x->size != 0);
+    assert(y->size != 0);
+    exeuclid_aux(a, b, c, x, y, -1, wm);
+}
+
+/**
+ * minimal polynomial of a linear recurrence sequence.
+ *
+ * sequence length len shoud be len >= 2 * maxdeg.
+ * If seq is zero sequence, minpoly is set to 1.
+ *
+ * use 12 wm
+ *
+ *@param minpoly
+ *@param seq linear recurrence sequence, seq[i] is coefficient of x^i
+ *@param maxdeg supporsed max degree of minpoly
+ *@param wm
+ */
+void f2p_poly_minpoly_aux(f2p_poly_t *minpoly, const f2p_poly_t *seq,
+                          int maxdeg, f2p_wm_t *wm)
+{
+    PUTS("poly_minpoly_aux start\n");
+    const int w = F2P_LIMB_BITS;
+    int n = (2 * maxdeg) / w + 1;
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *rl = wm_limbs(wm, n);
+    mp_limb_t *xl = wm_limbs(wm, n);
+    memset(rl, 0, (size_t)n * sizeof(mp_limb_t));
+    memset(xl, 0, (size_t)n * sizeof(mp_limb_t));
+    xl[(2 * maxdeg) / w] = (mp_limb_t)1 << ((2 * maxdeg) % w);
+    for (int i = 0; i < 2 * maxdeg; i++) {
+        if (f2p_poly_coefficient(seq, i)) {
+            int j = 2 * maxdeg - 1 - i;
+            rl[j / w] |= (mp_limb_t)1 << (j % w);
+        }
+    }
+    f2p_poly_t rseq;
+    f2p_poly_t x2t;
+    poly_view(&rseq, rl, n);
+    poly_view(&x2t, xl, n);
+    if (rseq.size == 0) {
+        f2p_poly_set_ui(minpoly, 1);
+        f2p_wm_release(wm, mark);
+        return;
+    }
+    exeuclid_aux(minpoly, NULL, NULL, &rseq, &x2t, maxdeg, wm); // 10 wm
+    f2p_wm_release(wm, mark);
+    PUTS("poly_minpoly_aux end\n");
+}
+
+/**
+ * minimal polynomial of a linear recurrence sequence.
+ *
+ * sequence length len shoud be len >= 2 * maxdeg.
+ *
+ *@param minpoly
+ *@param seq linear recurrence sequence
+ *@param maxdeg supporsed max degree of minpoly
+ */
+void f2p_poly_minpoly(f2p_poly_t *minpoly, const f2p_poly_t *seq,
+                      int maxdeg)
+{
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    f2p_poly_minpoly_aux(minpoly, seq, maxdeg, wm); // 12 wm
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * is irreducible aux
+ *
+ * gcd(poly, x^(2^m) - x) == 1 for m = 1, ..., degree / 2.
+ *
+ * use 6 wm
+ *
+ *@param poly input polynomial
+ *@param wm
+ *@reaturns 1 irreducible, 0 reducible
+ */
+int f2p_poly_is_irreducible_aux(const f2p_poly_t *poly, f2p_wm_t *wm)
+{
+    PUTS("f2p_poly_is_irreducible_aux start\n");
+    if (poly->size == 0) {
+        return 0;
+    }
+    if (poly->degree == 1) {
+        return 1;
+    }
+    int mn = poly->size;
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t *t2m = wm_limbs(wm, 2 * mn);
+    mp_limb_t *r0 = wm_limbs(wm, mn);
+    mp_limb_t *r1 = wm_limbs(wm, mn);
+    mp_limb_t *tmp = wm_limbs(wm, mn + 1);
+    mp_limb_t *prod = wm_limbs(wm, 2 * mn);
+    const mp_limb_t *m = poly->limb;
+    t2m[0] = 4; // t^2m
+    int tn = f2p_limb_divrem(NULL, t2m, 1, m, mn, tmp);
+    int result = 1;
+    for (int i = 1; i <= poly->degree / 2; i++) {
+        // r1 = t^2m + t
+        memset(r1, 0, (size_t)mn * sizeof(mp_limb_t));
+        memcpy(r1, t2m, (size_t)tn * sizeof(mp_limb_t));
+        r1[0] ^= 2;
+        memcpy(r0, m, (size_t)mn * sizeof(mp_limb_t));
+        int gn;
+        mp_limb_t *g = gcd_n(&gn, r0, mn, r1, f2p_limb_normalize(r1, mn),
+                             tmp);
+        if (gn != 1 || g[0] != 1) {
+            result = 0;
+            break;
+        }
+        f2p_limb_sqr_basecase(prod, t2m, tn);
+        tn = f2p_limb_divrem(NULL, prod, 2 * tn, m, mn, tmp);
+        memcpy(t2m, prod, (size_t)tn * sizeof(mp_limb_t));
+    }
+    f2p_wm_release(wm, mark);
+    PUTS("f2p_poly_is_irreducible_aux end\n");
+    return result;
+}
+
+/**
+ * is irreducible
+ *
+ *@param poly input polynomial
+ *@reaturns 1 if poly is irreducible, 0 otherwise
+ */
+int f2p_poly_is_irreducible(const f2p_poly_t *poly)
+{
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    int result = f2p_poly_is_irreducible_aux(poly, wm); // 6 wm
+    f2p_wm_release(wm, mark);
+    return result;
+}
+
+/**
+ * calc jump
+ *
+ *@param jump result jump polynomial
+ *@param minpoly minimum polynomial of PRNG
+ *@param step jump step
+ */
+void f2p_poly_calc_jump(f2p_poly_t *jump, const f2p_poly_t *minpoly,
+                        mpz_srcptr step)
+{
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    mp_limb_t two = 2;
+    f2p_poly_t x;
+    poly_view(&x, &two, 1);
+    f2p_poly_powermod(jump, &x, step, minpoly, wm); // 4 wm
+    f2p_wm_release(wm, mark);
+}
@@ -0,0 +1,159 @@
+#pragma once
+#ifndef F2P_POLY_H
+#define F2P_POLY_H
+/**
+ * @file f2p_poly.h
+ *
+ * @brief F2 polynomial type independent of mpz.
+ *
+ * f2p_poly_t keeps coefficients in an array of limbs without sign,
+ * and caches the degree. Operations are the same as f2p_gmp.h, and
+ * work limb by limb instead of bit by bit.
+ *
+ * f2p_poly_view_mpz and f2p_poly_mpz_view make read only views
+ * without copy, so that callers of f2p_gmp.h can use this type one
+ * call site at a time.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * F2 polynomial
+ *
+ * coefficient of x^i is bit (i % GMP_NUMB_BITS) of
+ * limb[i / GMP_NUMB_BITS]. capacity 0 means limbs are not owned
+ * (view of mpz or empty), they are copied before modification.
+ */
+    struct F2P_POLY_T {
+        mp_limb_t *limb;  // coefficients
+        int size;         // number of limbs in use, limb[size - 1] != 0
+        int capacity;     // number of allocated limbs
+        int degree;       // cached degree, -1 for zero polynomial
+    };
+
+    typedef struct F2P_POLY_T f2p_poly_t;
+
+    void f2p_poly_init(f2p_poly_t *p);
+
+    void f2p_poly_init2(f2p_poly_t *p, mp_bitcnt_t bits);
+
+    void f2p_poly_clear(f2p_poly_t *p);
+
+    void f2p_poly_reserve(f2p_poly_t *p, int limbs);
+
+    void f2p_poly_set(f2p_poly_t *r, const f2p_poly_t *a);
+
+    void f2p_poly_set_ui(f2p_poly_t *r, unsigned long v);
+
+    void f2p_poly_swap(f2p_poly_t *a, f2p_poly_t *b);
+
+    void f2p_poly_set_mpz(f2p_poly_t *r, mpz_srcptr z);
+
+    void f2p_poly_get_mpz(mpz_ptr z, const f2p_poly_t *p);
+
+    void f2p_poly_view_mpz(f2p_poly_t *view, mpz_srcptr z);
+
+    mpz_srcptr f2p_poly_mpz_view(mpz_ptr view, const f2p_poly_t *p);
+
+/**
+ * degree of polynomial
+ *
+ * this function returns -1 for the polynomial 0.
+ *@param p polynomial
+ *@return degree of polynomial
+ */
+    static inline int f2p_poly_degree(const f2p_poly_t *p)
+    {
+        return p->degree;
+    }
+
+    static inline int f2p_poly_is_zero(const f2p_poly_t *p)
+    {
+        return p->size == 0;
+    }
+
+    static inline int f2p_poly_is_one(const f2p_poly_t *p)
+    {
+        return p->degree == 0;
+    }
+
+    static inline int f2p_poly_coefficient(const f2p_poly_t *p, int index)
+    {
+        int k = index / GMP_NUMB_BITS;
+        if (index < 0 || k >= p->size) {
+            return 0;
+        }
+        return (int)((p->limb[k] >> (index % GMP_NUMB_BITS)) & 1);
+    }
+
+    void f2p_poly_setbit(f2p_poly_t *p, int index);
+
+    int f2p_poly_equal(const f2p_poly_t *a, const f2p_poly_t *b);
+
+    void f2p_poly_add(f2p_poly_t *r, const f2p_poly_t *a,
+                      const f2p_poly_t *b);
+
+    void f2p_poly_lshift(f2p_poly_t *r, const f2p_poly_t *a, int n);
+
+    void f2p_poly_rshift(f2p_poly_t *r, const f2p_poly_t *a, int n);
+
+    void f2p_poly_mod(f2p_poly_t *a, const f2p_poly_t *b, f2p_wm_t *wm);
+
+    void f2p_poly_divrem(f2p_poly_t *q, f2p_poly_t *r, const f2p_poly_t *a,
+                         const f2p_poly_t *b, f2p_wm_t *wm);
+
+    void f2p_poly_mul(f2p_poly_t *r, const f2p_poly_t *a,
+                      const f2p_poly_t *b, f2p_wm_t *wm);
+
+    void f2p_poly_square(f2p_poly_t *r, const f2p_poly_t *a, f2p_wm_t *wm);
+
+    void f2p_poly_mulmod(f2p_poly_t *r, const f2p_poly_t *a,
+                         const f2p_poly_t *b, const f2p_poly_t *mod,
+                         f2p_wm_t *wm);
+
+    void f2p_poly_pow2mod(f2p_poly_t *r, const f2p_poly_t *a,
+                          const f2p_poly_t *mod, f2p_wm_t *wm);
+
+    void f2p_poly_powermod(f2p_poly_t *r, const f2p_poly_t *x,
+                           mpz_srcptr e, const f2p_poly_t *mod,
+                           f2p_wm_t *wm);
+
+    void f2p_poly_gcd(f2p_poly_t *gcd, const f2p_poly_t *a,
+                      const f2p_poly_t *b, f2p_wm_t *wm);
+
+    void f2p_poly_exeuclid(f2p_poly_t *a, f2p_poly_t *b, f2p_poly_t *c,
+                           const f2p_poly_t *x, const f2p_poly_t *y,
+                           f2p_wm_t *wm);
+
+    void f2p_poly_minpoly(f2p_poly_t *minpoly, const f2p_poly_t *seq,
+                          int maxdeg);
+
+    void f2p_poly_minpoly_aux(f2p_poly_t *minpoly, const f2p_poly_t *seq,
+                              int maxdeg, f2p_wm_t *wm);
+
+    int f2p_poly_is_irreducible(const f2p_poly_t *poly);
+
+    int f2p_poly_is_irreducible_aux(const f2p_poly_t *poly, f2p_wm_t *wm);
+
+    void f2p_poly_calc_jump(f2p_poly_t *jump, const f2p_poly_t *minpoly,
+                            mpz_srcptr step);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_POLY_H
@@ -0,0 +1,249 @@
+/**
+ * @file f2p_precomp.c
+ *
+ * @brief multiplication by a fixed polynomial modulo a fixed polynomial.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_precomp.h"
+#include "f2p_limb.h"
+#include <pthread.h>
+
+static pthread_mutex_t f2p_mu_table_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * allocate limbs by memory functions of GMP
+ *
+ *@param n number of limbs
+ *@return limbs
+ */
+static mp_limb_t * limb_alloc(int n)
+{
+    void *(*alloc_func)(size_t);
+    mp_get_memory_functions(&alloc_func, NULL, NULL);
+    return alloc_func((size_t)n * sizeof(mp_limb_t));
+}
+
+/**
+ * free limbs allocated by limb_alloc
+ *
+ *@param p limbs
+ *@param n number of limbs
+ */
+static void limb_free(mp_limb_t *p, int n)
+{
+    void (*free_func)(void *, size_t);
+    mp_get_memory_functions(NULL, NULL, &free_func);
+    free_func(p, (size_t)n * sizeof(mp_limb_t));
+}
+
+/**
+ * make table of multiples of z
+ *
+ *@param tsize number of limbs of an entry
+ *@param z polynomial
+ *@return table
+ */
+static mp_limb_t * make_table(int *tsize, mpz_t z)
+{
+    int n = mpz_size(z);
+    *tsize = n + 1;
+    mp_limb_t *table = limb_alloc(16 * *tsize);
+    f2p_limb_comb_table(table, mpz_limbs_read(z), n);
+    return table;
+}
+
+/**
+ * initialize modulus data
+ *
+ *@param ctx modulus data
+ *@param mod nonzero modulus polynomial
+ */
+void f2p_modctx_init(f2p_modctx_t *ctx, mpz_t mod)
+{
+    int zcmp = mpz_cmp_ui(mod, 0);
+    assert(zcmp != 0); // zero divide
+    mpz_init_set(ctx->mod, mod);
+    ctx->degree = f2p_degree(mod);
+    ctx->size = (ctx->degree + F2P_LIMB_BITS - 1) / F2P_LIMB_BITS;
+    ctx->table = make_table(&ctx->tsize, ctx->mod);
+    ctx->mtsize = 0;
+    ctx->mtable = NULL;
+}
+
+/**
+ * free modulus data
+ *
+ *@param ctx modulus data
+ */
+void f2p_modctx_clear(f2p_modctx_t *ctx)
+{
+    limb_free(ctx->table, 16 * ctx->tsize);
+    if (ctx->mtable != NULL) {
+        limb_free(ctx->mtable, 16 * ctx->mtsize);
+    }
+    mpz_clear(ctx->mod);
+}
+
+/**
+ * table of multiples of mu = t^(2n) / mod for Barrett reduction
+ *
+ * The table is made by the first call and kept in ctx, ctx->mtsize
+ * is valid after the call. Can be called from many threads.
+ *
+ *@param ctx modulus data
+ *@return ctx->mtable
+ */
+const mp_limb_t * f2p_modctx_mu_table(const f2p_modctx_t *ctx)
+{
+    f2p_modctx_t *c = (f2p_modctx_t *)ctx;
+    mp_limb_t *table = __atomic_load_n(&c->mtable, __ATOMIC_ACQUIRE);
+    if (table != NULL) {
+        return table;
+    }
+    pthread_mutex_lock(&f2p_mu_table_mutex);
+    table = c->mtable;
+    if (table == NULL) {
+        f2p_wm_t *wm = f2p_wm_thread_local();
+        int mark = f2p_wm_mark(wm);
+        mpz_t *x = f2p_wm_alloc(wm);
+        mpz_t *mu = f2p_wm_alloc(wm);
+        mpz_t *r = f2p_wm_alloc(wm);
+        mpz_set_ui(*x, 0);
+        mpz_setbit(*x, 2 * c->degree);
+        f2p_divrem(*mu, *r, *x, c->mod, wm);
+        table = make_table(&c->mtsize, *mu);
+        f2p_wm_release(wm, mark);
+        __atomic_store_n(&c->mtable, table, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&f2p_mu_table_mutex);
+    return table;
+}
+
+/**
+ * initialize multiplier
+ *
+ * b % mod and b' = (b % mod) * t^n / mod are kept with their
+ * tables. ctx should not be cleared before pre.
+ *
+ *@param pre multiplier data
+ *@param b multiplier
+ *@param ctx modulus data
+ */
+void f2p_mulmod_precomp_init(f2p_mulmod_precomp_t *pre, mpz_t b,
+                             const f2p_modctx_t *ctx)
+{
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_t *q = f2p_wm_alloc(wm);
+    mpz_t *r = f2p_wm_alloc(wm);
+    mpz_ptr mod = (mpz_ptr)ctx->mod;
+    pre->ctx = ctx;
+    mpz_init_set(pre->b, b);
+    f2p_mod(pre->b, mod, wm);
+    mpz_set(*x, pre->b);
+    f2p_lshift(*x, ctx->degree);
+    f2p_divrem(*q, *r, *x, mod, wm);
+    pre->btable = make_table(&pre->btsize, pre->b);
+    pre->qtable = make_table(&pre->qtsize, *q);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * free multiplier data
+ *
+ *@param pre multiplier data
+ */
+void f2p_mulmod_precomp_clear(f2p_mulmod_precomp_t *pre)
+{
+    limb_free(pre->btable, 16 * pre->btsize);
+    limb_free(pre->qtable, 16 * pre->qtsize);
+    mpz_clear(pre->b);
+}
+
+/**
+ * Calculate r = (a * b) % mod, b and mod are given by pre.
+ *
+ * use 5 wm
+ *
+ * @param r result
+ * @param a polynomial
+ * @param pre multiplier data
+ * @param wm shared working memory
+ */
+void f2p_mulmod_precomp_aux(mpz_t r, mpz_t a,
+                            const f2p_mulmod_precomp_t *pre,
+                            f2p_wm_t *wm)
+{
+    const f2p_modctx_t *ctx = pre->ctx;
+    const int w = F2P_LIMB_BITS;
+    int n = ctx->degree;
+    int nl = ctx->size;
+    if (n == 0) {
+        mpz_set_ui(r, 0);
+        return;
+    }
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    if ((int)f2p_degree(a) >= n) {
+        mpz_set(*x, a);
+        f2p_mod(*x, (mpz_ptr)ctx->mod, wm); // 1 wm
+        a = *x;
+    }
+    int an = mpz_size(a);
+    if (an == 0) {
+        mpz_set_ui(r, 0);
+        f2p_wm_release(wm, mark);
+        return;
+    }
+    const mp_limb_t *ap = mpz_limbs_read(a);
+    // quotient: limbs n / w and above of a * b'
+    int lo = n / w;
+    int hi = an + pre->qtsize;
+    mp_limb_t *acc = mpz_limbs_write(*f2p_wm_alloc(wm), hi + 1);
+    mp_limb_t *h = mpz_limbs_write(*f2p_wm_alloc(wm), hi - lo);
+    mp_limb_t *low = mpz_limbs_write(*f2p_wm_alloc(wm), nl);
+    for (int j = 0; j < hi - lo; j++) {
+        h[j] = 0;
+    }
+    f2p_limb_comb_mul(h, lo, hi, ap, an, pre->qtable, pre->qtsize, acc);
+    int qn = f2p_limb_rshift(h, h, hi - lo, n - lo * w);
+    // low n bits of a * b + q * mod
+    for (int j = 0; j < nl; j++) {
+        low[j] = 0;
+    }
+    f2p_limb_comb_mul(low, 0, nl, ap, an, pre->btable, pre->btsize, acc);
+    f2p_limb_comb_mul(low, 0, nl, h, qn, ctx->table, ctx->tsize, acc);
+    if (n % w != 0) {
+        low[nl - 1] &= ((mp_limb_t)1 << (n % w)) - 1;
+    }
+    mp_limb_t *rp = mpz_limbs_write(r, nl);
+    for (int j = 0; j < nl; j++) {
+        rp[j] = low[j];
+    }
+    mpz_limbs_finish(r, f2p_limb_normalize(rp, nl));
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * Calculate r = (a * b) % mod, b and mod are given by pre.
+ *
+ * working memory of the calling thread is used.
+ *
+ * @param r result
+ * @param a polynomial
+ * @param pre multiplier data
+ */
+void f2p_mulmod_precomp(mpz_t r, mpz_t a, const f2p_mulmod_precomp_t *pre)
+{
+    f2p_mulmod_precomp_aux(r, a, pre, f2p_wm_thread_local());
+}
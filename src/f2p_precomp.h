@@ -0,0 +1,90 @@
+#pragma once
+#ifndef F2P_PRECOMP_H
+#define F2P_PRECOMP_H
+/**
+ * @file f2p_precomp.h
+ *
+ * @brief multiplication by a fixed polynomial modulo a fixed polynomial.
+ *
+ * f2p_modctx_t keeps data of a modulus shared by many operations.
+ * The table of mu = t^(2n) / mod for Barrett reduction of products of
+ * two residues is made by the first batch operation, so users of
+ * f2p_mulmod_precomp only do not pay for it.
+ * f2p_mulmod_precomp_t keeps, in addition, a fixed multiplier b and
+ * its scaled quotient b' = (b * t^n) / mod, where n is the degree of
+ * mod (Shoup's method). For a of degree less than n, the quotient of
+ * a * b divided by mod is exactly the upper half of a * b', so
+ * (a * b) % mod is obtained by half products only, without division.
+ *
+ * Products are computed by the comb method with tables of the sixteen
+ * multiples of b, b' and mod by polynomials of degree less than four.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * modulus data
+ */
+    struct F2P_MODCTX_T {
+        mpz_t mod;         // modulus polynomial
+        int degree;        // degree of mod
+        int size;          // number of limbs of residues
+        int tsize;         // number of limbs of an entry of table
+        mp_limb_t *table;  // mod * k for 0 <= k < 16
+        int mtsize;        // number of limbs of an entry of mtable
+        mp_limb_t *mtable; // mu * k for 0 <= k < 16, NULL until used
+    };
+
+    typedef struct F2P_MODCTX_T f2p_modctx_t;
+
+/**
+ * fixed multiplier b modulo modctx
+ */
+    struct F2P_MULMOD_PRECOMP_T {
+        const f2p_modctx_t *ctx;  // modulus, should live longer
+        mpz_t b;                  // b % mod
+        int btsize;               // number of limbs of an entry of btable
+        int qtsize;               // number of limbs of an entry of qtable
+        mp_limb_t *btable;        // b * k for 0 <= k < 16
+        mp_limb_t *qtable;        // b' * k for 0 <= k < 16
+    };
+
+    typedef struct F2P_MULMOD_PRECOMP_T f2p_mulmod_precomp_t;
+
+    void f2p_modctx_init(f2p_modctx_t *ctx, mpz_t mod);
+
+    void f2p_modctx_clear(f2p_modctx_t *ctx);
+
+    const mp_limb_t * f2p_modctx_mu_table(const f2p_modctx_t *ctx);
+
+    void f2p_mulmod_precomp_init(f2p_mulmod_precomp_t *pre, mpz_t b,
+                                 const f2p_modctx_t *ctx);
+
+    void f2p_mulmod_precomp_clear(f2p_mulmod_precomp_t *pre);
+
+    void f2p_mulmod_precomp(mpz_t r, mpz_t a,
+                            const f2p_mulmod_precomp_t *pre);
+
+    void f2p_mulmod_precomp_aux(mpz_t r, mpz_t a,
+                                const f2p_mulmod_precomp_t *pre,
+                                f2p_wm_t *wm);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_PRECOMP_H
@@ -0,0 +1,181 @@
+/**
+ * @file f2p_profile.c
+ *
+ * @brief Linear complexity profile of output bits of a generator.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_profile.h"
+#include "f2p_thread.h"
+#include "debug_f2p.h"
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+struct PROFILE_ARG_T {
+    f2p_profile_t *report;
+    f2p_generator_t gen;
+    const void *state;
+    size_t state_size;
+    mp_bitcnt_t bits;    // initial capacity of wm
+    unsigned char *work; // one state for one worker
+};
+
+static int parity64(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_parityll(x);
+#else
+    x ^= x >> 32;
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    return (int)(x & 1);
+#endif
+}
+
+/**
+ * calculate minimal polynomial of one mask.
+ * use 14 wm
+ */
+static void profile_job(int index, int worker, void *p)
+{
+    struct PROFILE_ARG_T *arg = p;
+    f2p_profile_t *report = arg->report;
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    void *state = arg->work + arg->state_size * worker;
+    uint64_t mask = report->mask[index];
+    f2p_wm_reserve(wm, arg->bits);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *seq = f2p_wm_alloc(wm);
+    memcpy(state, arg->state, arg->state_size);
+    mpz_set_ui(*seq, 0);
+    for (int i = 0; i < 2 * report->maxdeg; i++) {
+        if (parity64(arg->gen(state) & mask)) {
+            mpz_setbit(*seq, i);
+        }
+    }
+    f2p_minpoly_aux(report->minpoly[index], *seq, report->maxdeg,
+                    wm); // 13 wm
+    report->degree[index] = (int)f2p_degree(report->minpoly[index]);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * linear complexity profile
+ *
+ * For each mask in masks, the minimal polynomial of the sequence
+ * parity(gen(state) & mask) is calculated. Each mask is calculated
+ * from the copy of the given state. Minimal polynomials are
+ * classified by equality, class_id[i] is the least index j such that
+ * minpoly[j] == minpoly[i].
+ *
+ * report should be cleared by f2p_profile_clear after use.
+ *
+ *@param report result
+ *@param gen generator
+ *@param state initial state of generator, not changed
+ *@param state_size size of state in bytes
+ *@param masks array of masks
+ *@param size number of masks
+ *@param maxdeg supposed max degree of minimal polynomials
+ *@param num_threads number of threads, 0 means size of the executor
+ */
+void f2p_profile_bits(f2p_profile_t *report,
+                      f2p_generator_t gen,
+                      const void *state, size_t state_size,
+                      const uint64_t *masks, int size,
+                      int maxdeg, int num_threads)
+{
+    PUTS("f2p_profile_bits start\n");
+    report->size = size;
+    report->maxdeg = maxdeg;
+    report->mask = malloc(size * sizeof(uint64_t));
+    report->degree = malloc(size * sizeof(int));
+    report->class_id = malloc(size * sizeof(int));
+    report->minpoly = malloc(size * sizeof(mpz_t));
+    assert(report->mask != NULL && report->degree != NULL
+           && report->class_id != NULL && report->minpoly != NULL);
+    memcpy(report->mask, masks, size * sizeof(uint64_t));
+    for (int i = 0; i < size; i++) {
+        mpz_init(report->minpoly[i]);
+    }
+    int num = f2p_num_threads(num_threads);
+    if (num > size) {
+        num = size;
+    }
+    struct PROFILE_ARG_T arg;
+    arg.report = report;
+    arg.gen = gen;
+    arg.state = state;
+    arg.state_size = state_size;
+    arg.bits = 2 * maxdeg + 2 * GMP_NUMB_BITS;
+    arg.work = malloc(num * state_size);
+    assert(arg.work != NULL);
+    f2p_parallel_for(size, num, profile_job, &arg);
+    free(arg.work);
+    report->num_classes = 0;
+    for (int i = 0; i < size; i++) {
+        report->class_id[i] = i;
+        for (int j = 0; j < i; j++) {
+            if (report->class_id[j] == j
+                && mpz_cmp(report->minpoly[i], report->minpoly[j]) == 0) {
+                report->class_id[i] = j;
+                break;
+            }
+        }
+        if (report->class_id[i] == i) {
+            report->num_classes++;
+        }
+    }
+    PUTS("f2p_profile_bits end\n");
+}
+
+/**
+ * clear profile report
+ *
+ *@param report profile report
+ */
+void f2p_profile_clear(f2p_profile_t *report)
+{
+    for (int i = 0; i < report->size; i++) {
+        mpz_clear(report->minpoly[i]);
+    }
+    free(report->minpoly);
+    free(report->class_id);
+    free(report->degree);
+    free(report->mask);
+    report->size = 0;
+}
+
+/**
+ * print profile report
+ *
+ * one line for one mask, mask, degree, class and minimal polynomial
+ * in hexadecimal.
+ *
+ *@param fp output file
+ *@param report profile report
+ */
+void f2p_profile_fprint(FILE *fp, f2p_profile_t *report)
+{
+    fprintf(fp, "# mask, degree, class, minpoly\n");
+    for (int i = 0; i < report->size; i++) {
+        fprintf(fp, "%016" PRIx64 ",%d,%d,", report->mask[i],
+                report->degree[i], report->class_id[i]);
+        mpz_out_str(fp, 16, report->minpoly[i]);
+        fprintf(fp, "\n");
+    }
+    fprintf(fp, "# %d classes\n", report->num_classes);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef F2P_PROFILE_H
+#define F2P_PROFILE_H
+/**
+ * @file f2p_profile.h
+ *
+ * @brief Linear complexity profile of output bits of a generator.
+ *
+ * For each mask, the minimal polynomial of the sequence of
+ * parity(output & mask) is calculated in parallel.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * generator callback, changes state and returns output.
+ */
+    typedef uint64_t (*f2p_generator_t)(void *state);
+
+    struct F2P_PROFILE_T {
+        int size;          // number of masks
+        int maxdeg;        // supposed max degree of minimal polynomials
+        int num_classes;   // number of distinct minimal polynomials
+        uint64_t *mask;    // masks
+        int *degree;       // degree of minimal polynomial of each mask
+        int *class_id;     // first mask index which has the same minpoly
+        mpz_t *minpoly;    // minimal polynomial of each mask
+    };
+
+    typedef struct F2P_PROFILE_T f2p_profile_t;
+
+    void f2p_profile_bits(f2p_profile_t *report,
+                          f2p_generator_t gen,
+                          const void *state, size_t state_size,
+                          const uint64_t *masks, int size,
+                          int maxdeg, int num_threads);
+
+    void f2p_profile_clear(f2p_profile_t *report);
+
+    void f2p_profile_fprint(FILE *fp, f2p_profile_t *report);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_PROFILE_H
@@ -0,0 +1,349 @@
+/**
+ * @file f2p_random.c
+ *
+ * @brief Random irreducible and primitive polynomials.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_random.h"
+#include "f2p_thread.h"
+#include "debug_f2p.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct RANDOM_ARG_T {
+    const f2p_sieve_t *sieve;
+    mpz_t *cand;
+    int *index;              // index of survivor j in cand
+    f2p_control_t *control;  // control of survivor j
+    f2p_control_t *caller;   // control of the caller, may be NULL
+    int best;                // smallest successful survivor
+    int primitive;           // 1 if primitivity is tested
+    int degree;
+    mpz_t *factors;
+    int num_factors;
+};
+
+/**
+ * random polynomial of the degree with constant term 1 and odd weight
+ */
+static void random_candidate(mpz_t r, int degree, f2p_generator_t rng,
+                             void *state)
+{
+    int size = degree / 64 + 1;
+    uint64_t *w = malloc(size * sizeof(uint64_t));
+    assert(w != NULL);
+    for (int i = 0; i < size; i++) {
+        w[i] = rng(state);
+    }
+    mpz_import(r, size, -1, sizeof(uint64_t), 0, 0, w);
+    free(w);
+    mpz_tdiv_r_2exp(r, r, degree);
+    mpz_setbit(r, degree);
+    mpz_setbit(r, 0);
+    if (mpz_popcount(r) % 2 == 0) {
+        mpz_combit(r, 1);
+    }
+}
+
+/**
+ * t^((2^degree - 1) / p) != 1 for all prime factors p, poly should be
+ * irreducible.
+ *
+ * use 7 wm
+ */
+static int check_order(mpz_t poly, struct RANDOM_ARG_T *arg, f2p_wm_t *wm)
+{
+    int mark = f2p_wm_mark(wm);
+    mpz_t *order = f2p_wm_alloc(wm);
+    mpz_t *e = f2p_wm_alloc(wm);
+    mpz_t *t = f2p_wm_alloc(wm);
+    mpz_t *r = f2p_wm_alloc(wm);
+    mpz_set_ui(*order, 0);
+    mpz_setbit(*order, arg->degree);
+    mpz_sub_ui(*order, *order, 1);
+    mpz_set_ui(*t, 2);
+    int result = 1;
+    for (int i = 0; i < arg->num_factors && result; i++) {
+        assert(mpz_divisible_p(*order, arg->factors[i]));
+        mpz_divexact(*e, *order, arg->factors[i]);
+        f2p_powermod(*r, *t, *e, poly, wm); // 6 wm
+        if (mpz_cmp_ui(*r, 1) == 0) {
+            result = 0;
+        }
+    }
+    f2p_wm_release(wm, mark);
+    return result;
+}
+
+/**
+ * test survivor j, and cancel the later survivors if success.
+ */
+static void test_job(int j, int worker, void *p)
+{
+    (void)worker;
+    struct RANDOM_ARG_T *arg = p;
+    if (j > __atomic_load_n(&arg->best, __ATOMIC_RELAXED)
+        || f2p_control_cancelled(&arg->control[j])) {
+        return;
+    }
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    f2p_control_t *saved = f2p_control_get();
+    f2p_control_set(&arg->control[j]);
+    mpz_ptr poly = arg->cand[arg->index[j]];
+    int result = f2p_is_irreducible_sieve(arg->sieve, poly);
+    if (result && arg->primitive) {
+        result = check_order(poly, arg, wm); // 7 wm
+    }
+    // results of cancelled functions are undefined, control[j] is
+    // cancelled also by cancel of the caller
+    if (f2p_control_cancelled(&arg->control[j])) {
+        result = 0;
+    }
+    f2p_control_set(saved);
+    if (!result) {
+        return;
+    }
+    int best = __atomic_load_n(&arg->best, __ATOMIC_RELAXED);
+    while (j < best
+           && !__atomic_compare_exchange_n(&arg->best, &best, j, 0,
+                                           __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED)) {
+    }
+    for (int k = j + 1; k < F2P_RANDOM_BATCH; k++) {
+        f2p_control_cancel(&arg->control[k]);
+    }
+}
+
+/**
+ * max degree of irreducible polynomials of the sieve for candidates
+ * of the degree
+ *
+ * The product of the sieve has degree about the degree of
+ * candidates.
+ *
+ *@param degree degree of candidates
+ *@return degree of sieve
+ */
+int f2p_random_sieve_degree(int degree)
+{
+    int sieve_degree = -1;
+    for (int d = degree; d > 1; d /= 2) {
+        sieve_degree++;
+    }
+    if (sieve_degree < 1) {
+        sieve_degree = 1;
+    } else if (sieve_degree > 16) {
+        sieve_degree = 16;
+    }
+    return sieve_degree;
+}
+
+/**
+ * search loop of f2p_random_irreducible and f2p_random_primitive
+ */
+static int random_search(mpz_t poly, struct RANDOM_ARG_T *arg,
+                         const f2p_sieve_t *sieve, f2p_generator_t rng,
+                         void *state, int num_threads)
+{
+    int degree = arg->degree;
+    mpz_t cand[F2P_RANDOM_BATCH];
+    int result[F2P_RANDOM_BATCH];
+    int index[F2P_RANDOM_BATCH];
+    f2p_control_t control[F2P_RANDOM_BATCH];
+    for (int i = 0; i < F2P_RANDOM_BATCH; i++) {
+        mpz_init(cand[i]);
+    }
+    arg->sieve = sieve;
+    arg->cand = cand;
+    arg->index = index;
+    arg->control = control;
+    arg->caller = f2p_control_get();
+    int found = 0;
+    for (long round = 0; !found; round++) {
+        if (f2p_control_poll(round)) {
+            break;
+        }
+        for (int i = 0; i < F2P_RANDOM_BATCH; i++) {
+            random_candidate(cand[i], degree, rng, state);
+        }
+        f2p_sieve_check_batch(result, sieve, cand, F2P_RANDOM_BATCH,
+                              num_threads);
+        int num = 0;
+        for (int i = 0; i < F2P_RANDOM_BATCH; i++) {
+            if (result[i]) {
+                index[num++] = i;
+            }
+        }
+        if (num == 0) {
+            continue;
+        }
+        memset(control, 0, sizeof(control));
+        for (int i = 0; i < num; i++) {
+            control[i].parent = arg->caller;
+        }
+        arg->best = num;
+        f2p_parallel_for(num, num_threads, test_job, arg);
+        if (arg->best < num) {
+            mpz_set(poly, cand[index[arg->best]]);
+            found = 1;
+        }
+    }
+    for (int i = 0; i < F2P_RANDOM_BATCH; i++) {
+        mpz_clear(cand[i]);
+    }
+    return found;
+}
+
+/**
+ * random irreducible polynomial
+ *
+ * Irreducible polynomials of the degree are chosen uniformly if the
+ * generator is uniform. The search stops if the control of the
+ * calling thread is cancelled. A sieve of degree
+ * f2p_random_sieve_degree(degree) is built for each call.
+ *
+ *@param poly result
+ *@param degree degree of poly, degree >= 1
+ *@param rng generator of uniform 64-bit integers
+ *@param state state of rng
+ *@param num_threads number of threads, 0 means size of the executor
+ *@return 1 if found, 0 if cancelled
+ */
+int f2p_random_irreducible(mpz_t poly, int degree, f2p_generator_t rng,
+                           void *state, int num_threads)
+{
+    assert(degree >= 1);
+    if (degree == 1) {
+        return f2p_random_irreducible_sieve(poly, degree, NULL, rng, state,
+                                            num_threads);
+    }
+    f2p_sieve_t sieve;
+    f2p_sieve_init(&sieve, f2p_random_sieve_degree(degree));
+    int found = f2p_random_irreducible_sieve(poly, degree, &sieve, rng,
+                                             state, num_threads);
+    f2p_sieve_clear(&sieve);
+    return found;
+}
+
+/**
+ * random irreducible polynomial with the sieve of the caller
+ *
+ * Same as f2p_random_irreducible, but candidates are filtered by the
+ * sieve, which can be shared by many calls and threads.
+ *
+ *@param poly result
+ *@param degree degree of poly, degree >= 1
+ *@param sieve sieve of degree less than degree, can be NULL if
+ * degree is 1
+ *@param rng generator of uniform 64-bit integers
+ *@param state state of rng
+ *@param num_threads number of threads, 0 means size of the executor
+ *@return 1 if found, 0 if cancelled
+ */
+int f2p_random_irreducible_sieve(mpz_t poly, int degree,
+                                 const f2p_sieve_t *sieve,
+                                 f2p_generator_t rng, void *state,
+                                 int num_threads)
+{
+    PUTS("f2p_random_irreducible_sieve start\n");
+    assert(degree >= 1);
+    if (degree == 1) {
+        mpz_set_ui(poly, 2 | (rng(state) & 1)); // t or t + 1
+        return 1;
+    }
+    // irreducible polynomials in the sieve are rejected
+    assert(sieve->degree < degree);
+    struct RANDOM_ARG_T arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.degree = degree;
+    int found = random_search(poly, &arg, sieve, rng, state, num_threads);
+    PUTS("f2p_random_irreducible_sieve end\n");
+    return found;
+}
+
+/**
+ * random primitive polynomial
+ *
+ * A random irreducible polynomial f is primitive if
+ * t^((2^degree - 1) / p) mod f is not 1 for all prime factors p of
+ * 2^degree - 1. If 2^degree - 1 is a Mersenne prime, all irreducible
+ * polynomials are primitive and num_factors can be 0. A sieve of
+ * degree f2p_random_sieve_degree(degree) is built for each call.
+ *
+ *@param poly result
+ *@param degree degree of poly, degree >= 1
+ *@param factors distinct prime factors of 2^degree - 1
+ *@param num_factors number of factors
+ *@param rng generator of uniform 64-bit integers
+ *@param state state of rng
+ *@param num_threads number of threads, 0 means size of the executor
+ *@return 1 if found, 0 if cancelled
+ */
+int f2p_random_primitive(mpz_t poly, int degree, mpz_t *factors,
+                         int num_factors, f2p_generator_t rng, void *state,
+                         int num_threads)
+{
+    assert(degree >= 1);
+    if (degree == 1) {
+        return f2p_random_primitive_sieve(poly, degree, factors,
+                                          num_factors, NULL, rng, state,
+                                          num_threads);
+    }
+    f2p_sieve_t sieve;
+    f2p_sieve_init(&sieve, f2p_random_sieve_degree(degree));
+    int found = f2p_random_primitive_sieve(poly, degree, factors,
+                                           num_factors, &sieve, rng, state,
+                                           num_threads);
+    f2p_sieve_clear(&sieve);
+    return found;
+}
+
+/**
+ * random primitive polynomial with the sieve of the caller
+ *
+ * Same as f2p_random_primitive, but candidates are filtered by the
+ * sieve, which can be shared by many calls and threads.
+ *
+ *@param poly result
+ *@param degree degree of poly, degree >= 1
+ *@param factors distinct prime factors of 2^degree - 1
+ *@param num_factors number of factors
+ *@param sieve sieve of degree less than degree, can be NULL if
+ * degree is 1
+ *@param rng generator of uniform 64-bit integers
+ *@param state state of rng
+ *@param num_threads number of threads, 0 means size of the executor
+ *@return 1 if found, 0 if cancelled
+ */
+int f2p_random_primitive_sieve(mpz_t poly, int degree, mpz_t *factors,
+                               int num_factors, const f2p_sieve_t *sieve,
+                               f2p_generator_t rng, void *state,
+                               int num_threads)
+{
+    PUTS("f2p_random_primitive_sieve start\n");
+    assert(degree >= 1);
+    if (degree == 1) {
+        mpz_set_ui(poly, 3); // t + 1
+        return 1;
+    }
+    // irreducible polynomials in the sieve are rejected
+    assert(sieve->degree < degree);
+    struct RANDOM_ARG_T arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.degree = degree;
+    arg.primitive = 1;
+    arg.factors = factors;
+    arg.num_factors = num_factors;
+    int found = random_search(poly, &arg, sieve, rng, state, num_threads);
+    PUTS("f2p_random_primitive_sieve end\n");
+    return found;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#ifndef F2P_RANDOM_H
+#define F2P_RANDOM_H
+/**
+ * @file f2p_random.h
+ *
+ * @brief Random irreducible and primitive polynomials.
+ *
+ * Candidates are random polynomials with constant term 1 and odd
+ * weight, so they have no factor t or t + 1. A batch of candidates is
+ * filtered by f2p_sieve_check_batch, then the survivors are tested
+ * concurrently. When a survivor is found irreducible (or primitive),
+ * the tests of the later survivors of the batch are cancelled. The
+ * first successful survivor of the batch is returned, so the result
+ * depends only on the generator, not on the number of threads.
+ *
+ * Building the sieve costs as much as several searches of small
+ * degree, so callers generating many polynomials should build one by
+ * f2p_sieve_init(&sieve, f2p_random_sieve_degree(degree)) and pass it
+ * to the _sieve variants.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+#include "f2p_profile.h"
+#include "f2p_sieve.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * F2P_RANDOM_BATCH: number of candidates generated at once
+ */
+    enum {
+        F2P_RANDOM_BATCH = 32
+    };
+
+    int f2p_random_sieve_degree(int degree);
+
+    int f2p_random_irreducible(mpz_t poly, int degree, f2p_generator_t rng,
+                               void *state, int num_threads);
+
+    int f2p_random_irreducible_sieve(mpz_t poly, int degree,
+                                     const f2p_sieve_t *sieve,
+                                     f2p_generator_t rng, void *state,
+                                     int num_threads);
+
+    int f2p_random_primitive(mpz_t poly, int degree, mpz_t *factors,
+                             int num_factors, f2p_generator_t rng,
+                             void *state, int num_threads);
+
+    int f2p_random_primitive_sieve(mpz_t poly, int degree, mpz_t *factors,
+                                   int num_factors, const f2p_sieve_t *sieve,
+                                   f2p_generator_t rng, void *state,
+                                   int num_threads);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_RANDOM_H
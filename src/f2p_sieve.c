@@ -0,0 +1,323 @@
+/**
+ * @file f2p_sieve.c
+ *
+ * @brief Trial division sieve by all irreducible polynomials of small
+ * degree.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_sieve.h"
+#include "f2p_irrlist.h"
+#include "f2p_thread.h"
+#include "debug_f2p.h"
+#include <stdlib.h>
+
+/**
+ * number of steps of f2p_is_irreducible_sieve sharing one gcd
+ */
+#define GCD_BLOCK 16
+
+/**
+ * initialize sieve by irreducible polynomials of degree or less
+ *
+ * The degree of the product is about 2^(degree + 1).
+ *
+ *@param sieve sieve
+ *@param degree max degree of irreducible polynomials,
+ * 1 <= degree <= F2P_SIEVE_MAX_DEGREE
+ */
+void f2p_sieve_init(f2p_sieve_t *sieve, int degree)
+{
+    PUTS("f2p_sieve_init start\n");
+    assert(degree >= 1 && degree <= F2P_SIEVE_MAX_DEGREE);
+    f2p_irrlist_t list;
+    f2p_irrlist_init(&list, degree, 0);
+    int count = (int)(list.offset[degree] + list.count[degree]);
+    mpz_t *irr = malloc(count * sizeof(mpz_t));
+    assert(irr != NULL);
+    for (int d = 1; d <= degree; d++) {
+        for (long i = 0; i < list.count[d]; i++) {
+            uint64_t f = f2p_irrlist_get(&list, d, i);
+            mpz_init(irr[list.offset[d] + i]);
+            mpz_import(irr[list.offset[d] + i], 1, -1, sizeof(uint64_t), 0,
+                       0, &f);
+        }
+    }
+    f2p_irrlist_clear(&list);
+    sieve->degree = degree;
+    sieve->count = count;
+    f2p_prodtree_init(&sieve->tree, irr, count);
+    sieve->product_degree
+        = f2p_degree(sieve->tree.node[sieve->tree.levels - 1][0].prod);
+    for (int i = 0; i < count; i++) {
+        mpz_clear(irr[i]);
+    }
+    free(irr);
+    PUTS("f2p_sieve_init end\n");
+}
+
+/**
+ * clear sieve
+ *
+ *@param sieve sieve
+ */
+void f2p_sieve_clear(f2p_sieve_t *sieve)
+{
+    f2p_prodtree_clear(&sieve->tree);
+    sieve->degree = 0;
+    sieve->count = 0;
+    sieve->product_degree = 0;
+}
+
+/**
+ * product of irreducible polynomials
+ */
+static mpz_ptr sieve_product(const f2p_sieve_t *sieve)
+{
+    return sieve->tree.node[sieve->tree.levels - 1][0].prod;
+}
+
+/**
+ * check by gcd(poly, rem), rem = product % poly
+ *
+ * use 4 wm
+ */
+static int check_residue(mpz_t poly, mpz_t rem, f2p_wm_t *wm)
+{
+    if (mpz_cmp_ui(rem, 0) == 0) {
+        return 0;
+    }
+    int mark = f2p_wm_mark(wm);
+    mpz_t *g = f2p_wm_alloc(wm);
+    f2p_gcd(*g, poly, rem, wm); // 3 wm
+    int result = mpz_cmp_ui(*g, 1) == 0;
+    f2p_wm_release(wm, mark);
+    return result;
+}
+
+/**
+ * check if poly has no irreducible factor of degree sieve->degree or
+ * less.
+ *
+ * poly of degree sieve->degree or less is checked by
+ * f2p_is_irreducible.
+ *
+ *@param sieve sieve
+ *@param poly polynomial
+ *@return 0 if poly is reducible, 1 if poly has no small factor
+ */
+int f2p_sieve_check(const f2p_sieve_t *sieve, mpz_t poly)
+{
+    if (mpz_cmp_ui(poly, 0) == 0) {
+        return 0;
+    }
+    int deg = f2p_degree(poly);
+    if (deg <= sieve->degree) {
+        return f2p_is_irreducible(poly);
+    }
+    // factor t or t + 1
+    if (mpz_tstbit(poly, 0) == 0 || mpz_popcount(poly) % 2 == 0) {
+        return 0;
+    }
+    int result = 1;
+    if (deg < sieve->product_degree) {
+        f2p_wm_t *wm = f2p_wm_thread_local();
+        int mark = f2p_wm_mark(wm);
+        mpz_t *rem = f2p_wm_alloc(wm);
+        mpz_set(*rem, sieve_product(sieve));
+        f2p_mod_newton(*rem, poly, wm); // 7 wm
+        result = check_residue(poly, *rem, wm); // 4 wm
+        f2p_wm_release(wm, mark);
+    } else {
+        mpz_t *res = malloc(sieve->count * sizeof(mpz_t));
+        assert(res != NULL);
+        for (int i = 0; i < sieve->count; i++) {
+            mpz_init(res[i]);
+        }
+        f2p_multimod_prodtree(res, poly, &sieve->tree);
+        for (int i = 0; i < sieve->count; i++) {
+            if (mpz_cmp_ui(res[i], 0) == 0) {
+                result = 0;
+            }
+            mpz_clear(res[i]);
+        }
+        free(res);
+    }
+    return result;
+}
+
+struct F2P_SIEVE_ARG_T {
+    const f2p_sieve_t *sieve;
+    int *result;
+    int *index;   // index of mods[i] in polys
+    int *group;   // mods[group[j]] to mods[group[j + 1] - 1] is group j
+    int num_tree; // groups 0 to num_tree - 1 use remainder tree
+    mpz_t *mods;
+    mpz_t *rem;
+};
+
+static void group_job(int j, int worker, void *p)
+{
+    (void)worker;
+    struct F2P_SIEVE_ARG_T *arg = p;
+    int start = arg->group[j];
+    int n = arg->group[j + 1] - start;
+    if (j >= arg->num_tree) {
+        arg->result[arg->index[start]]
+            = f2p_sieve_check(arg->sieve, arg->mods[start]);
+        return;
+    }
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    f2p_multimod(arg->rem + start, sieve_product(arg->sieve),
+                 arg->mods + start, n);
+    for (int i = start; i < start + n; i++) {
+        arg->result[arg->index[i]]
+            = check_residue(arg->mods[i], arg->rem[i], wm); // 4 wm
+    }
+}
+
+/**
+ * f2p_sieve_check for many polynomials
+ *
+ * Polynomials of degree F2P_SIEVE_TREE_DEGREE or more are divided into
+ * groups whose product has about the degree of the product of the
+ * sieve. For each group, the product of the sieve is reduced modulo
+ * the polynomials by a remainder tree, and then gcds are calculated.
+ * Other polynomials are checked by f2p_sieve_check. Groups and
+ * polynomials are processed in parallel.
+ *
+ *@param result array of count results of f2p_sieve_check
+ *@param sieve sieve
+ *@param polys polynomials
+ *@param count number of polynomials
+ *@param num_threads number of threads, 0 means size of the executor
+ */
+void f2p_sieve_check_batch(int *result, const f2p_sieve_t *sieve,
+                           mpz_t *polys, int count, int num_threads)
+{
+    PUTS("f2p_sieve_check_batch start\n");
+    int *index = malloc(count * sizeof(int));
+    int *group = malloc((count + 1) * sizeof(int));
+    mpz_t *mods = malloc(count * sizeof(mpz_t));
+    mpz_t *rem = malloc(count * sizeof(mpz_t));
+    assert(index != NULL && group != NULL && mods != NULL && rem != NULL);
+    int m = 0;
+    int num_groups = 0;
+    int num_tree = 0;
+    long group_degree = 0;
+    // groups of remainder tree first, then single polynomials
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < count; i++) {
+            int deg = -1;
+            if (mpz_cmp_ui(polys[i], 0) != 0) {
+                deg = f2p_degree(polys[i]);
+            }
+            int tree = deg >= F2P_SIEVE_TREE_DEGREE
+                && deg > sieve->degree && deg < sieve->product_degree;
+            if (tree != (pass == 0)) {
+                continue;
+            }
+            if (!tree || num_groups == 0
+                || group_degree + deg > sieve->product_degree) {
+                group[num_groups++] = m;
+                group_degree = 0;
+            }
+            group_degree += deg;
+            index[m] = i;
+            mpz_init_set(mods[m], polys[i]);
+            mpz_init(rem[m]);
+            m++;
+        }
+        if (pass == 0) {
+            num_tree = num_groups;
+        }
+    }
+    group[num_groups] = m;
+    if (num_groups > 0) {
+        struct F2P_SIEVE_ARG_T arg = {sieve, result, index, group, num_tree,
+                                      mods, rem};
+        f2p_parallel_for(num_groups, num_threads, group_job, &arg);
+    }
+    for (int i = 0; i < m; i++) {
+        mpz_clear(rem[i]);
+        mpz_clear(mods[i]);
+    }
+    free(rem);
+    free(mods);
+    free(group);
+    free(index);
+    PUTS("f2p_sieve_check_batch end\n");
+}
+
+/**
+ * is irreducible with sieve
+ *
+ * Polynomials with small factors are rejected by the sieve before
+ * the squarings of f2p_is_irreducible. Polynomials of degree
+ * 2 * sieve->degree + 1 or less which pass the sieve are irreducible.
+ * For other polynomials, t^(2^m) - t for m > sieve->degree are
+ * multiplied modulo poly, and gcd with poly is calculated once for
+ * GCD_BLOCK values of m.
+ *
+ *@param sieve sieve
+ *@param poly input polynomial
+ *@return 1 if poly is irreducible, 0 otherwise
+ */
+int f2p_is_irreducible_sieve(const f2p_sieve_t *sieve, mpz_t poly)
+{
+    if (!f2p_sieve_check(sieve, poly)) {
+        return 0;
+    }
+    int degpol = f2p_degree(poly);
+    if (degpol <= 2 * sieve->degree + 1) {
+        return 1;
+    }
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    f2p_wm_reserve(wm, 2 * degpol + 2 * GMP_NUMB_BITS);
+    mpz_t *t2m = f2p_wm_alloc(wm);
+    mpz_t *t = f2p_wm_alloc(wm);
+    mpz_t *acc = f2p_wm_alloc(wm);
+    mpz_t *work = f2p_wm_alloc(wm);
+    mpz_set_ui(*t2m, 4); // t^2m
+    mpz_set_ui(*acc, 1);
+    int pending = 0;
+    int result = 1;
+    for (int m = 1; m <= degpol / 2; m++) {
+        if (f2p_control_poll(m)) {
+            result = 0;
+            break;
+        }
+        if (m > sieve->degree) {
+            mpz_set(*t, *t2m);
+            mpz_combit(*t, 1);
+            f2p_mulmod(*acc, *acc, *t, poly, wm); // 5 wm
+            pending++;
+        }
+        if (pending == GCD_BLOCK || (pending > 0 && m == degpol / 2)) {
+            // acc = 0 if all factors have degree dividing some m
+            if (mpz_cmp_ui(*acc, 0) == 0) {
+                result = 0;
+                break;
+            }
+            f2p_gcd(*work, poly, *acc, wm); // 4 wm
+            if (mpz_cmp_ui(*work, 1) != 0) {
+                result = 0;
+                break;
+            }
+            mpz_set_ui(*acc, 1);
+            pending = 0;
+        }
+        f2p_pow2mod(*t2m, *t2m, poly, wm); // 1 wm
+    }
+    f2p_wm_release(wm, mark);
+    return result;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef F2P_SIEVE_H
+#define F2P_SIEVE_H
+/**
+ * @file f2p_sieve.h
+ *
+ * @brief Trial division sieve by all irreducible polynomials of small
+ * degree.
+ *
+ * The sieve keeps the product tree of all irreducible polynomials of
+ * degree d or less. A candidate of degree less than the product P is
+ * rejected if gcd(candidate, P % candidate) is not 1, and a larger
+ * candidate is rejected if one of its residues modulo the leaves is
+ * 0. Batch mode reduces P modulo thousands of candidates at once by a
+ * remainder tree over the product tree of the candidates.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+#include "f2p_multimod.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * F2P_SIEVE_MAX_DEGREE: max degree of irreducible polynomials of sieve
+ * F2P_SIEVE_TREE_DEGREE: batch mode uses remainder tree for
+ * polynomials of this degree or more
+ */
+    enum {
+        F2P_SIEVE_MAX_DEGREE = 24,
+        F2P_SIEVE_TREE_DEGREE = F2P_KARATSUBA_THRESHOLD * GMP_NUMB_BITS
+    };
+
+/**
+ * product of irreducible polynomials of small degree
+ */
+    struct F2P_SIEVE_T {
+        int degree;           // max degree of irreducible polynomials
+        int count;            // number of irreducible polynomials
+        int product_degree;   // degree of product
+        f2p_prodtree_t tree;  // product tree of irreducible polynomials
+    };
+
+    typedef struct F2P_SIEVE_T f2p_sieve_t;
+
+    void f2p_sieve_init(f2p_sieve_t *sieve, int degree);
+
+    void f2p_sieve_clear(f2p_sieve_t *sieve);
+
+    int f2p_sieve_check(const f2p_sieve_t *sieve, mpz_t poly);
+
+    void f2p_sieve_check_batch(int *result, const f2p_sieve_t *sieve,
+                               mpz_t *polys, int count, int num_threads);
+
+    int f2p_is_irreducible_sieve(const f2p_sieve_t *sieve, mpz_t poly);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_SIEVE_H
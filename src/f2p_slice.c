@@ -0,0 +1,513 @@
+/**
+ * @file f2p_slice.c
+ *
+ * @brief bit sliced arithmetic of 64 small F2 polynomials.
+ *
+ * Lanes have moduli of different degrees, and shifts by different
+ * amounts are done by a bit sliced barrel shifter: shift amounts are
+ * also bit sliced, word b of an amount holds bit b of the amounts of
+ * all lanes.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_slice.h"
+
+#define SIZE F2P_SLICE_SIZE
+#define MAXDEG F2P_SLICE_MAX_DEGREE
+// number of bits of shift amounts
+#define AMT_BITS 8
+
+/**
+ * transpose 64 x 64 bit matrix
+ *
+ * after transpose, bit l of a[k] is bit k of a[l] before.
+ *
+ *@param a matrix
+ */
+static void transpose64(uint64_t a[64])
+{
+    uint64_t m = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j != 0; j >>= 1, m ^= m << j) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+/**
+ * lanes which are not zero
+ */
+static uint64_t nonzero(const f2p_slice_t *a, int n)
+{
+    uint64_t z = 0;
+    for (int k = 0; k < n; k++) {
+        z |= a->c[k];
+    }
+    return z;
+}
+
+/**
+ * r = a in lanes of mask
+ */
+static void select_lanes(f2p_slice_t *r, const f2p_slice_t *a,
+                         uint64_t mask)
+{
+    for (int k = 0; k < SIZE; k++) {
+        r->c[k] = (a->c[k] & mask) | (r->c[k] & ~mask);
+    }
+}
+
+/**
+ * swap a and b in lanes of mask
+ */
+static void swap_lanes(f2p_slice_t *a, f2p_slice_t *b, uint64_t mask,
+                       int n)
+{
+    for (int k = 0; k < n; k++) {
+        uint64_t t = (a->c[k] ^ b->c[k]) & mask;
+        a->c[k] ^= t;
+        b->c[k] ^= t;
+    }
+}
+
+/**
+ * a = a * t^amt, amounts differ by lanes
+ *
+ *@param a polynomials
+ *@param amt bit sliced shift amounts
+ */
+static void barrel_lshift(f2p_slice_t *a, const uint64_t amt[AMT_BITS])
+{
+    for (int b = 0; b < AMT_BITS; b++) {
+        uint64_t sel = amt[b];
+        int s = 1 << b;
+        if (sel == 0 || s >= SIZE) {
+            continue;
+        }
+        for (int k = SIZE - 1; k >= s; k--) {
+            a->c[k] = (a->c[k] & ~sel) | (a->c[k - s] & sel);
+        }
+        for (int k = 0; k < s; k++) {
+            a->c[k] &= ~sel;
+        }
+    }
+}
+
+/**
+ * a = a * t^-amt, lower terms are discarded, amounts differ by lanes
+ *
+ *@param a polynomials
+ *@param amt bit sliced shift amounts
+ */
+static void barrel_rshift(f2p_slice_t *a, const uint64_t amt[AMT_BITS])
+{
+    for (int b = 0; b < AMT_BITS; b++) {
+        uint64_t sel = amt[b];
+        int s = 1 << b;
+        if (sel == 0 || s >= SIZE) {
+            continue;
+        }
+        for (int k = 0; k < SIZE - s; k++) {
+            a->c[k] = (a->c[k] & ~sel) | (a->c[k + s] & sel);
+        }
+        for (int k = SIZE - s; k < SIZE; k++) {
+            a->c[k] &= ~sel;
+        }
+    }
+}
+
+/**
+ * bit sliced MAXDEG - degree of mod
+ *
+ *@param amt result
+ *@param mod polynomials of degree at most MAXDEG
+ */
+static void align_amount(uint64_t amt[AMT_BITS], const f2p_slice_t *mod)
+{
+    uint64_t found = 0;
+    for (int b = 0; b < AMT_BITS; b++) {
+        amt[b] = 0;
+    }
+    for (int k = MAXDEG; k >= 0; k--) {
+        uint64_t now = mod->c[k] & ~found;
+        found |= now;
+        for (int b = 0; b < AMT_BITS; b++) {
+            if (((MAXDEG - k) >> b) & 1) {
+                amt[b] |= now;
+            }
+        }
+    }
+}
+
+/**
+ * r = 0
+ *
+ *@param r polynomials
+ */
+void f2p_slice_zero(f2p_slice_t *r)
+{
+    for (int k = 0; k < SIZE; k++) {
+        r->c[k] = 0;
+    }
+}
+
+/**
+ * lane l of r = p[l], polynomials of degree less than 64
+ *
+ *@param r result
+ *@param p polynomials, bit k of p[l] is the coefficient of t^k
+ */
+void f2p_slice_set_u64(f2p_slice_t *r, const uint64_t p[64])
+{
+    for (int k = 0; k < 64; k++) {
+        r->c[k] = p[k];
+    }
+    transpose64(r->c);
+    for (int k = 64; k < SIZE; k++) {
+        r->c[k] = 0;
+    }
+}
+
+/**
+ * p[l] = lane l of a, lower 64 coefficients
+ *
+ *@param p result
+ *@param a polynomials
+ */
+void f2p_slice_get_u64(uint64_t p[64], const f2p_slice_t *a)
+{
+    for (int k = 0; k < 64; k++) {
+        p[k] = a->c[k];
+    }
+    transpose64(p);
+}
+
+/**
+ * lane of r = z
+ *
+ *@param r polynomials
+ *@param lane lane number
+ *@param z polynomial of degree less than F2P_SLICE_SIZE
+ */
+void f2p_slice_set_lane(f2p_slice_t *r, int lane, mpz_t z)
+{
+    assert(0 <= lane && lane < F2P_SLICE_LANES);
+    assert(mpz_sizeinbase(z, 2) <= SIZE);
+    uint64_t bit = (uint64_t)1 << lane;
+    for (int k = 0; k < SIZE; k++) {
+        if (mpz_tstbit(z, k)) {
+            r->c[k] |= bit;
+        } else {
+            r->c[k] &= ~bit;
+        }
+    }
+}
+
+/**
+ * z = lane of a
+ *
+ *@param z result
+ *@param a polynomials
+ *@param lane lane number
+ */
+void f2p_slice_get_lane(mpz_t z, const f2p_slice_t *a, int lane)
+{
+    assert(0 <= lane && lane < F2P_SLICE_LANES);
+    mpz_set_ui(z, 0);
+    for (int k = 0; k < SIZE; k++) {
+        if ((a->c[k] >> lane) & 1) {
+            mpz_setbit(z, k);
+        }
+    }
+}
+
+/**
+ * degrees of lanes
+ *
+ *@param deg result, -1 for the polynomial 0
+ *@param a polynomials
+ */
+void f2p_slice_degree(int deg[64], const f2p_slice_t *a)
+{
+    uint64_t found = 0;
+    for (int l = 0; l < 64; l++) {
+        deg[l] = -1;
+    }
+    for (int k = SIZE - 1; k >= 0 && found != UINT64_MAX; k--) {
+        uint64_t now = a->c[k] & ~found;
+        found |= now;
+        while (now != 0) {
+            int l = __builtin_ctzll(now);
+            deg[l] = k;
+            now &= now - 1;
+        }
+    }
+}
+
+/**
+ * r = a + b in lanes of mask
+ *
+ *@param r result
+ *@param a polynomials
+ *@param b polynomials
+ *@param mask lanes to be calculated
+ */
+void f2p_slice_add(f2p_slice_t *r, const f2p_slice_t *a,
+                   const f2p_slice_t *b, uint64_t mask)
+{
+    for (int k = 0; k < SIZE; k++) {
+        r->c[k] = ((a->c[k] ^ b->c[k]) & mask) | (r->c[k] & ~mask);
+    }
+}
+
+/**
+ * r = a * t^n in lanes of mask, terms of degree F2P_SLICE_SIZE or
+ * more are discarded.
+ *
+ *@param r result
+ *@param a polynomials
+ *@param n shift amount
+ *@param mask lanes to be calculated
+ */
+void f2p_slice_lshift(f2p_slice_t *r, const f2p_slice_t *a, int n,
+                      uint64_t mask)
+{
+    assert(n >= 0);
+    for (int k = SIZE - 1; k >= 0; k--) {
+        uint64_t x = k >= n ? a->c[k - n] : 0;
+        r->c[k] = (x & mask) | (r->c[k] & ~mask);
+    }
+}
+
+/**
+ * r = a * t^-n in lanes of mask, lower terms are discarded.
+ *
+ *@param r result
+ *@param a polynomials
+ *@param n shift amount
+ *@param mask lanes to be calculated
+ */
+void f2p_slice_rshift(f2p_slice_t *r, const f2p_slice_t *a, int n,
+                      uint64_t mask)
+{
+    assert(n >= 0);
+    for (int k = 0; k < SIZE; k++) {
+        uint64_t x = k + n < SIZE ? a->c[k + n] : 0;
+        r->c[k] = (x & mask) | (r->c[k] & ~mask);
+    }
+}
+
+/**
+ * r = a % mod in lanes of mask
+ *
+ * mod of each lane is shifted so that its leading term is at
+ * t^MAXDEG, and a is shifted by the same amount. Then the shifted
+ * dividends are reduced by common word operations, and the residues
+ * are shifted back.
+ *
+ *@param r result
+ *@param a polynomials of degree less than 2 * F2P_SLICE_MAX_DEGREE
+ *@param mod nonzero polynomials of degree at most F2P_SLICE_MAX_DEGREE
+ *@param mask lanes to be calculated
+ */
+void f2p_slice_mod(f2p_slice_t *r, const f2p_slice_t *a,
+                   const f2p_slice_t *mod, uint64_t mask)
+{
+    assert((nonzero(mod, MAXDEG + 1) & mask) == mask); // zero divide
+    uint64_t amt[AMT_BITS];
+    f2p_slice_t m = *mod;
+    f2p_slice_t x = *a;
+    align_amount(amt, mod);
+    barrel_lshift(&m, amt);
+    barrel_lshift(&x, amt);
+    for (int k = SIZE - 1; k >= MAXDEG; k--) {
+        uint64_t t = x.c[k] & mask;
+        if (t == 0) {
+            continue;
+        }
+        uint64_t *p = x.c + k - MAXDEG;
+        for (int j = 0; j <= MAXDEG; j++) {
+            p[j] ^= t & m.c[j];
+        }
+    }
+    barrel_rshift(&x, amt);
+    select_lanes(r, &x, mask);
+}
+
+/**
+ * r = gcd(a, b) in lanes of mask
+ *
+ * binary gcd: common factors t are removed, and then, while b is not
+ * zero, b is divided by t if b(0) = 0, otherwise a and b are swapped
+ * if b < a as integers and b is set b + a.
+ *
+ *@param r result
+ *@param a polynomials of degree less than F2P_SLICE_SIZE
+ *@param b polynomials of degree less than F2P_SLICE_SIZE
+ *@param mask lanes to be calculated
+ */
+void f2p_slice_gcd(f2p_slice_t *r, const f2p_slice_t *a,
+                   const f2p_slice_t *b, uint64_t mask)
+{
+    f2p_slice_t x = *a;
+    f2p_slice_t y = *b;
+    uint64_t cnt[AMT_BITS] = {0};
+    int n = SIZE;
+    while (n > 0 && ((x.c[n - 1] | y.c[n - 1]) & mask) == 0) {
+        n--;
+    }
+    // gcd(0, y) = y
+    swap_lanes(&x, &y, mask & ~nonzero(&x, n), n);
+    uint64_t live = mask & nonzero(&y, n);
+    // common factors t
+    for (;;) {
+        uint64_t sel = live & ~x.c[0] & ~y.c[0];
+        if (sel == 0) {
+            break;
+        }
+        for (int k = 0; k < n - 1; k++) {
+            x.c[k] = (x.c[k] & ~sel) | (x.c[k + 1] & sel);
+            y.c[k] = (y.c[k] & ~sel) | (y.c[k + 1] & sel);
+        }
+        x.c[n - 1] &= ~sel;
+        y.c[n - 1] &= ~sel;
+        uint64_t carry = sel;
+        for (int bit = 0; bit < AMT_BITS; bit++) {
+            uint64_t t = cnt[bit] & carry;
+            cnt[bit] ^= carry;
+            carry = t;
+        }
+    }
+    // make x(0) = 1
+    swap_lanes(&x, &y, live & ~x.c[0], n);
+    while (live != 0) {
+        // y(0) = 0
+        uint64_t sel = live & ~y.c[0];
+        for (int k = 0; k < n - 1; k++) {
+            y.c[k] = (y.c[k] & ~sel) | (y.c[k + 1] & sel);
+        }
+        y.c[n - 1] &= ~sel;
+        // y(0) = 1
+        sel = live & y.c[0];
+        uint64_t eq = ~(uint64_t)0;
+        uint64_t lt = 0;
+        for (int k = n - 1; k >= 0; k--) {
+            uint64_t d = x.c[k] ^ y.c[k];
+            lt |= eq & d & x.c[k];
+            eq &= ~d;
+        }
+        swap_lanes(&x, &y, sel & lt, n);
+        for (int k = 0; k < n; k++) {
+            y.c[k] ^= x.c[k] & sel;
+        }
+        live &= nonzero(&y, n);
+        while (n > 0 && ((x.c[n - 1] | y.c[n - 1]) & mask) == 0) {
+            n--;
+        }
+    }
+    barrel_lshift(&x, cnt);
+    select_lanes(r, &x, mask);
+}
+
+/**
+ * r = a^2 % mod in lanes of mask
+ *
+ *@param r result
+ *@param a polynomials of degree less than F2P_SLICE_MAX_DEGREE
+ *@param mod nonzero polynomials of degree at most F2P_SLICE_MAX_DEGREE
+ *@param mask lanes to be calculated
+ */
+void f2p_slice_pow2mod(f2p_slice_t *r, const f2p_slice_t *a,
+                       const f2p_slice_t *mod, uint64_t mask)
+{
+    f2p_slice_t x;
+    for (int k = 0; k < SIZE / 2; k++) {
+        x.c[2 * k] = a->c[k];
+        x.c[2 * k + 1] = 0;
+    }
+    f2p_slice_mod(r, &x, mod, mask);
+}
+
+/**
+ * irreducibility test of lanes of mask
+ *
+ * Rabin's test, f of degree n is irreducible if and only if
+ * t^(2^n) = t mod f and gcd(t^(2^(n/p)) - t, f) = 1 for all prime
+ * factors p of n. The squarings of all lanes are done together, and
+ * gcd is calculated for lanes which need it at the step.
+ *
+ *@param f polynomials of degree at most F2P_SLICE_MAX_DEGREE
+ *@param mask lanes to be tested
+ *@return mask of irreducible lanes
+ */
+uint64_t f2p_slice_is_irreducible(const f2p_slice_t *f, uint64_t mask)
+{
+    int deg[64];
+    f2p_slice_degree(deg, f);
+    // need[i]: lanes which need gcd after i squarings
+    uint64_t need[MAXDEG + 1] = {0};
+    uint64_t last[MAXDEG + 1] = {0};
+    uint64_t result = 0;
+    int maxdeg = 0;
+    for (int l = 0; l < 64; l++) {
+        uint64_t bit = (uint64_t)1 << l;
+        int n = deg[l];
+        if (!(mask & bit) || n < 1) {
+            continue;
+        }
+        assert(n <= MAXDEG);
+        result |= bit;
+        last[n] |= bit;
+        if (n > maxdeg) {
+            maxdeg = n;
+        }
+        int m = n;
+        for (int p = 2; p <= m; p++) {
+            if (m % p == 0) {
+                need[n / p] |= bit;
+                while (m % p == 0) {
+                    m /= p;
+                }
+            }
+        }
+    }
+    f2p_slice_t h;
+    f2p_slice_t g;
+    f2p_slice_zero(&h);
+    h.c[1] = result;
+    // polynomials of degree 1 are irreducible
+    uint64_t active = result & ~last[1];
+    for (int i = 1; i <= maxdeg && active != 0; i++) {
+        f2p_slice_pow2mod(&h, &h, f, active);
+        // h = t^(2^i) - t
+        h.c[1] ^= active;
+        uint64_t sel = need[i] & active;
+        if (sel != 0) {
+            f2p_slice_gcd(&g, &h, f, sel);
+            uint64_t one = g.c[0];
+            for (int k = 1; k < SIZE; k++) {
+                one &= ~g.c[k];
+            }
+            result &= ~(sel & ~one);
+            active &= result;
+        }
+        sel = last[i] & active;
+        if (sel != 0) {
+            uint64_t zero = ~nonzero(&h, MAXDEG);
+            result &= ~(sel & ~zero);
+            active &= ~sel;
+        }
+        h.c[1] ^= active;
+    }
+    return result;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#ifndef F2P_SLICE_H
+#define F2P_SLICE_H
+/**
+ * @file f2p_slice.h
+ *
+ * @brief bit sliced arithmetic of 64 small F2 polynomials.
+ *
+ * f2p_slice_t holds 64 independent polynomials, one polynomial in
+ * one bit lane: bit l of c[k] is the coefficient of t^k of lane l.
+ * An operation on f2p_slice_t is applied to all lanes by word
+ * operations, and lanes whose bit of mask is 0 are left unchanged.
+ *
+ * Moduli should have degree at most F2P_SLICE_MAX_DEGREE, and
+ * dividends degree less than 2 * F2P_SLICE_MAX_DEGREE.  Lanes may
+ * have moduli of different degrees.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define F2P_SLICE_LANES 64
+#define F2P_SLICE_MAX_DEGREE 64
+#define F2P_SLICE_SIZE (3 * F2P_SLICE_MAX_DEGREE)
+
+/**
+ * 64 polynomials
+ *
+ * bit l of c[k] is the coefficient of t^k of lane l.
+ */
+    struct F2P_SLICE_T {
+        uint64_t c[F2P_SLICE_SIZE];
+    };
+
+    typedef struct F2P_SLICE_T f2p_slice_t;
+
+    void f2p_slice_zero(f2p_slice_t *r);
+
+    void f2p_slice_set_u64(f2p_slice_t *r, const uint64_t p[64]);
+
+    void f2p_slice_get_u64(uint64_t p[64], const f2p_slice_t *a);
+
+    void f2p_slice_set_lane(f2p_slice_t *r, int lane, mpz_t z);
+
+    void f2p_slice_get_lane(mpz_t z, const f2p_slice_t *a, int lane);
+
+    void f2p_slice_degree(int deg[64], const f2p_slice_t *a);
+
+    void f2p_slice_add(f2p_slice_t *r, const f2p_slice_t *a,
+                       const f2p_slice_t *b, uint64_t mask);
+
+    void f2p_slice_lshift(f2p_slice_t *r, const f2p_slice_t *a, int n,
+                          uint64_t mask);
+
+    void f2p_slice_rshift(f2p_slice_t *r, const f2p_slice_t *a, int n,
+                          uint64_t mask);
+
+    void f2p_slice_mod(f2p_slice_t *r, const f2p_slice_t *a,
+                       const f2p_slice_t *mod, uint64_t mask);
+
+    void f2p_slice_gcd(f2p_slice_t *r, const f2p_slice_t *a,
+                       const f2p_slice_t *b, uint64_t mask);
+
+    void f2p_slice_pow2mod(f2p_slice_t *r, const f2p_slice_t *a,
+                           const f2p_slice_t *mod, uint64_t mask);
+
+    uint64_t f2p_slice_is_irreducible(const f2p_slice_t *f, uint64_t mask);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_SLICE_H
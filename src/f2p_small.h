@@ -0,0 +1,301 @@
+#pragma once
+#ifndef F2P_SMALL_H
+#define F2P_SMALL_H
+/**
+ * @file f2p_small.h
+ *
+ * @brief internal functions for F2 polynomials of degree less than 128.
+ *
+ * Polynomials are kept in unsigned __int128, coefficient of x^i is
+ * bit i. f2p_gmp.c dispatches to these functions when operands fit
+ * in two limbs. Carry-less multiplication uses PCLMULQDQ when
+ * compiled with it (for example -mpclmul or -march=native), and
+ * f2p_limb_clmul otherwise.
+ *
+ * F2P_SMALL is defined when these functions are available.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_limb.h"
+#include <stdint.h>
+
+#if defined(__SIZEOF_INT128__) && GMP_NUMB_BITS == 64
+#define F2P_SMALL 1
+#endif
+
+#if defined(F2P_SMALL)
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#endif
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+    typedef unsigned __int128 f2p_u128;
+
+/**
+ * Barrett reduction context for modulus m of degree d,
+ * mu = floor(x^(2d) / m).
+ */
+    struct F2P_SMALL_MOD_T {
+        f2p_u128 m;
+        f2p_u128 mu;
+        int d;
+    };
+
+    typedef struct F2P_SMALL_MOD_T f2p_small_mod_t;
+
+/**
+ * degree of polynomial, -1 for zero polynomial
+ */
+    static inline int f2p_small_degree(f2p_u128 a)
+    {
+        uint64_t hi = (uint64_t)(a >> 64);
+        if (hi != 0) {
+            return 64 + f2p_limb_degree(hi);
+        }
+        if ((uint64_t)a != 0) {
+            return f2p_limb_degree((uint64_t)a);
+        }
+        return -1;
+    }
+
+/**
+ * carry-less product of 64 bit polynomials
+ */
+    static inline f2p_u128 f2p_small_clmul(uint64_t a, uint64_t b)
+    {
+#if defined(__PCLMUL__)
+        __m128i x = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)a),
+                                         _mm_cvtsi64_si128((long long)b),
+                                         0);
+        uint64_t lo = (uint64_t)_mm_cvtsi128_si64(x);
+        uint64_t hi = (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(x, x));
+#else
+        mp_limb_t hi;
+        mp_limb_t lo = f2p_limb_clmul(&hi, a, b);
+#endif
+        return ((f2p_u128)hi << 64) | lo;
+    }
+
+/**
+ * carry-less product of 128 bit polynomials
+ *
+ *@param hi upper half of the product
+ *@return lower half of the product
+ */
+    static inline f2p_u128 f2p_small_clmul128(f2p_u128 *hi, f2p_u128 a,
+                                              f2p_u128 b)
+    {
+        uint64_t a0 = (uint64_t)a;
+        uint64_t a1 = (uint64_t)(a >> 64);
+        uint64_t b0 = (uint64_t)b;
+        uint64_t b1 = (uint64_t)(b >> 64);
+        f2p_u128 lo = f2p_small_clmul(a0, b0);
+        f2p_u128 mid = f2p_small_clmul(a0, b1) ^ f2p_small_clmul(a1, b0);
+        f2p_u128 h = f2p_small_clmul(a1, b1);
+        *hi = h ^ (mid >> 64);
+        return lo ^ (mid << 64);
+    }
+
+/**
+ * a % b, shift and add.
+ */
+    static inline f2p_u128 f2p_small_mod(f2p_u128 a, f2p_u128 b)
+    {
+        int db = f2p_small_degree(b);
+        int da = f2p_small_degree(a);
+        while (da >= db) {
+            a ^= b << (da - db);
+            da = f2p_small_degree(a);
+        }
+        return a;
+    }
+
+/**
+ * gcd(a, b)
+ */
+    static inline f2p_u128 f2p_small_gcd(f2p_u128 a, f2p_u128 b)
+    {
+        while (b != 0) {
+            f2p_u128 r = f2p_small_mod(a, b);
+            a = b;
+            b = r;
+        }
+        return a;
+    }
+
+/**
+ * (a * b) % m, a and b should be reduced.
+ */
+    static inline f2p_u128 f2p_small_mulmod(f2p_u128 a, f2p_u128 b,
+                                            f2p_u128 m)
+    {
+        int d = f2p_small_degree(m);
+        if (d < 64) {
+            return f2p_small_mod(f2p_small_clmul((uint64_t)a, (uint64_t)b),
+                                 m);
+        }
+        // degree of r is less than d after each step
+        f2p_u128 r = 0;
+        for (int i = f2p_small_degree(b); i >= 0; i--) {
+            r <<= 1;
+            if ((r >> d) & 1) {
+                r ^= m;
+            }
+            if ((b >> i) & 1) {
+                r ^= a;
+            }
+        }
+        return r;
+    }
+
+/**
+ * initialize Barrett reduction context, degree of m should be positive.
+ */
+    static inline void f2p_small_mod_init(f2p_small_mod_t *ctx, f2p_u128 m)
+    {
+        int d = f2p_small_degree(m);
+        f2p_u128 q = 0;
+        if (d < 64) {
+            // x^(2d) fits in 128 bits
+            f2p_u128 r = (f2p_u128)1 << (2 * d);
+            int dr = 2 * d;
+            while (dr >= d) {
+                r ^= m << (dr - d);
+                q |= (f2p_u128)1 << (dr - d);
+                dr = f2p_small_degree(r);
+            }
+        } else {
+            f2p_u128 r = 0;
+            for (int i = 2 * d; i >= 0; i--) {
+                r = (r << 1) | (i == 2 * d);
+                if ((r >> d) & 1) {
+                    r ^= m;
+                    q |= (f2p_u128)1 << i;
+                }
+            }
+        }
+        ctx->m = m;
+        ctx->mu = q;
+        ctx->d = d;
+    }
+
+/**
+ * square of 64 bit polynomial
+ */
+    static inline f2p_u128 f2p_small_sqr(uint64_t a)
+    {
+        mp_limb_t hi;
+        mp_limb_t lo = f2p_limb_sqr(&hi, a);
+        return ((f2p_u128)hi << 64) | lo;
+    }
+
+/**
+ * p % m by Barrett reduction, degree of p should be less than 2d.
+ */
+    static inline f2p_u128 f2p_small_reduce_ctx(f2p_u128 p,
+                                                const f2p_small_mod_t *ctx)
+    {
+        int d = ctx->d;
+        f2p_u128 mask = ((f2p_u128)1 << d) - 1;
+        uint64_t t = (uint64_t)(p >> d);
+        uint64_t q = (uint64_t)(f2p_small_clmul(t, (uint64_t)ctx->mu) >> d);
+        return (p ^ f2p_small_clmul(q, (uint64_t)ctx->m)) & mask;
+    }
+
+/**
+ * (a * b) % m by Barrett reduction, a and b should be reduced.
+ */
+    static inline f2p_u128 f2p_small_mulmod_ctx(f2p_u128 a, f2p_u128 b,
+                                                const f2p_small_mod_t *ctx)
+    {
+        int d = ctx->d;
+        f2p_u128 mask = ((f2p_u128)1 << d) - 1;
+        if (d < 64) {
+            f2p_u128 p = f2p_small_clmul((uint64_t)a, (uint64_t)b);
+            uint64_t t = (uint64_t)(p >> d);
+            uint64_t q = (uint64_t)(f2p_small_clmul(t, (uint64_t)ctx->mu)
+                                    >> d);
+            return (p ^ f2p_small_clmul(q, (uint64_t)ctx->m)) & mask;
+        }
+        f2p_u128 ph;
+        f2p_u128 pl = f2p_small_clmul128(&ph, a, b);
+        f2p_u128 t = (pl >> d) | (ph << (128 - d));
+        f2p_u128 uh;
+        f2p_u128 ul = f2p_small_clmul128(&uh, t, ctx->mu);
+        f2p_u128 q = (ul >> d) | (uh << (128 - d));
+        f2p_u128 qh;
+        f2p_u128 ql = f2p_small_clmul128(&qh, q, ctx->m);
+        return (pl ^ ql) & mask;
+    }
+
+/**
+ * irreducibility by Rabin's test
+ *
+ * f of degree d is irreducible if and only if x^(2^d) = x mod f and
+ * gcd(x^(2^(d/p)) - x, f) = 1 for each prime p dividing d.
+ *
+ *@param f polynomial
+ *@return 1 if irreducible, 0 otherwise, same as f2p_is_irreducible
+ * for degree 0 and 1.
+ */
+    static inline int f2p_small_is_irreducible(f2p_u128 f)
+    {
+        int d = f2p_small_degree(f);
+        if (d < 0) {
+            return 0;
+        }
+        if (d <= 1) {
+            return 1;
+        }
+        if ((f & 1) == 0) {
+            return 0;
+        }
+        // steps k = d / p for prime p dividing d
+        uint8_t check[128] = {0};
+        int n = d;
+        for (int p = 2; p <= n; p++) {
+            if (n % p == 0) {
+                check[d / p] = 1;
+                while (n % p == 0) {
+                    n /= p;
+                }
+            }
+        }
+        f2p_small_mod_t ctx;
+        f2p_small_mod_init(&ctx, f);
+        f2p_u128 x = 2;
+        f2p_u128 s = x;
+        for (int k = 1; k <= d; k++) {
+            if (d < 64) {
+                s = f2p_small_reduce_ctx(f2p_small_sqr((uint64_t)s), &ctx);
+            } else {
+                s = f2p_small_mulmod_ctx(s, s, &ctx);
+            }
+            if (k < d && check[k]) {
+                if (f2p_small_gcd(f, s ^ x) != 1) {
+                    return 0;
+                }
+            }
+        }
+        return s == x;
+    }
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_SMALL
+
+#endif // F2P_SMALL_H
@@ -0,0 +1,286 @@
+/**
+ * @file f2p_sparse.c
+ *
+ * @brief sparse F2 polynomials.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_sparse.h"
+#include "f2p_limb.h"
+#include "debug_f2p.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void f2p_sparse_alloc_failure(void)
+{
+    fprintf(stderr, "f2p_sparse: cannot allocate exponents\n");
+    abort();
+}
+
+static void f2p_sparse_reserve(f2p_sparse_t *s, int n)
+{
+    if (s->capacity >= n) {
+        return;
+    }
+    int *exp = realloc(s->exp, (size_t)n * sizeof(int));
+    if (exp == NULL) {
+        f2p_sparse_alloc_failure();
+    }
+    s->exp = exp;
+    s->capacity = n;
+}
+
+static int compare_decreasing(const void *a, const void *b)
+{
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x < y) - (x > y);
+}
+
+/**
+ * Initialization of sparse polynomial, value is 0.
+ *
+ *@param s polynomial
+ */
+void f2p_sparse_init(f2p_sparse_t *s)
+{
+    s->size = 0;
+    s->capacity = 0;
+    s->exp = NULL;
+}
+
+/**
+ * free exponents
+ *
+ *@param s polynomial
+ */
+void f2p_sparse_clear(f2p_sparse_t *s)
+{
+    free(s->exp);
+    f2p_sparse_init(s);
+}
+
+/**
+ * s = x^exps[0] + x^exps[1] + ... + x^exps[n - 1]
+ *
+ * exponents can be in any order, equal exponents cancel in pairs.
+ *
+ *@param s result
+ *@param exps exponents
+ *@param n number of exponents
+ */
+void f2p_sparse_set_exps(f2p_sparse_t *s, const int *exps, int n)
+{
+    f2p_sparse_reserve(s, n);
+    memcpy(s->exp, exps, (size_t)n * sizeof(int));
+    qsort(s->exp, (size_t)n, sizeof(int), compare_decreasing);
+    int size = 0;
+    for (int i = 0; i < n; i++) {
+        assert(s->exp[i] >= 0);
+        if (size > 0 && s->exp[size - 1] == s->exp[i]) {
+            size--;
+        } else {
+            s->exp[size++] = s->exp[i];
+        }
+    }
+    s->size = size;
+}
+
+/**
+ * s = z
+ *
+ *@param s result
+ *@param z dense polynomial
+ */
+void f2p_sparse_set_mpz(f2p_sparse_t *s, mpz_t z)
+{
+    int n = (int)mpz_popcount(z);
+    f2p_sparse_reserve(s, n);
+    mp_bitcnt_t pos = mpz_scan1(z, 0);
+    for (int i = n - 1; i >= 0; i--) {
+        s->exp[i] = (int)pos;
+        pos = mpz_scan1(z, pos + 1);
+    }
+    s->size = n;
+}
+
+/**
+ * z = s
+ *
+ *@param z result
+ *@param s sparse polynomial
+ */
+void f2p_sparse_get_mpz(mpz_t z, const f2p_sparse_t *s)
+{
+    if (s->size == 0) {
+        mpz_set_ui(z, 0);
+        return;
+    }
+    int n = s->exp[0] / F2P_LIMB_BITS + 1;
+    mp_limb_t *d = mpz_limbs_write(z, n);
+    memset(d, 0, (size_t)n * sizeof(mp_limb_t));
+    for (int i = 0; i < s->size; i++) {
+        d[s->exp[i] / F2P_LIMB_BITS]
+            |= (mp_limb_t)1 << (s->exp[i] % F2P_LIMB_BITS);
+    }
+    mpz_limbs_finish(z, n);
+}
+
+/**
+ * a %= mod, limb array version
+ *
+ * Let n be degree of mod, and gap be n minus second largest exponent.
+ * Coefficients of a above n are taken by min(gap, F2P_LIMB_BITS) bits
+ * from the top. x^i for i >= n is replaced by
+ * x^(i - n) * (mod - x^n), which lands below the taken bits.
+ *
+ *@return normalized number of limbs
+ */
+static int sparse_mod_limbs(mp_limb_t *a, int an, const f2p_sparse_t *mod)
+{
+    const int w = F2P_LIMB_BITS;
+    int n = mod->exp[0];
+    int width = w;
+    if (mod->size > 1 && n - mod->exp[1] < width) {
+        width = n - mod->exp[1];
+    }
+    an = f2p_limb_normalize(a, an);
+    int top = f2p_limb_poly_degree(a, an);
+    while (top >= n) {
+        int j = top - width + 1;
+        if (j < n) {
+            j = n;
+        }
+        int bits = top - j + 1;
+        mp_limb_t word = f2p_limb_get_bits(a, an, j);
+        if (bits < w) {
+            word &= ((mp_limb_t)1 << bits) - 1;
+        }
+        f2p_limb_xor_shift(a, &word, 1, j);
+        for (int k = 1; k < mod->size; k++) {
+            f2p_limb_xor_shift(a, &word, 1, j - n + mod->exp[k]);
+        }
+        an = f2p_limb_normalize(a, an);
+        top = f2p_limb_poly_degree(a, an);
+    }
+    return an;
+}
+
+/**
+ * a %= mod
+ *
+ * Time is linear in degree of a times number of terms of mod.
+ *
+ *@param a dividend and result
+ *@param mod sparse divisor
+ */
+void f2p_sparse_mod(mpz_t a, const f2p_sparse_t *mod)
+{
+    assert(mod->size > 0); // zero divide
+    int an = (int)mpz_size(a);
+    if (an == 0 || (int)f2p_degree(a) < mod->exp[0]) {
+        return;
+    }
+    mp_limb_t *d = mpz_limbs_modify(a, an);
+    mpz_limbs_finish(a, sparse_mod_limbs(d, an, mod));
+}
+
+/**
+ * r = a * b
+ *
+ * use 1 wm
+ *
+ *@param r result
+ *@param a sparse polynomial
+ *@param b dense polynomial
+ *@param wm shared working memory
+ */
+void f2p_sparse_mul(mpz_t r, const f2p_sparse_t *a, mpz_t b, f2p_wm_t *wm)
+{
+    int bn = (int)mpz_size(b);
+    if (a->size == 0 || bn == 0) {
+        mpz_set_ui(r, 0);
+        return;
+    }
+    int n = bn + a->exp[0] / F2P_LIMB_BITS + 1;
+    int mark = f2p_wm_mark(wm);
+    mpz_t *t = f2p_wm_alloc(wm);
+    mp_limb_t *d = mpz_limbs_write(*t, n);
+    memset(d, 0, (size_t)n * sizeof(mp_limb_t));
+    const mp_limb_t *bp = mpz_limbs_read(b);
+    for (int i = 0; i < a->size; i++) {
+        f2p_limb_xor_shift(d, bp, bn, a->exp[i]);
+    }
+    mpz_limbs_finish(*t, f2p_limb_normalize(d, n));
+    mpz_swap(r, *t);
+    f2p_wm_release(wm, mark);
+}
+
+/**
+ * calculate r = x^e % mod.
+ *
+ * Squares are computed by spreading bits, and reduced by the sparse
+ * modulus, so each step is linear in degree of mod when x is the
+ * polynomial x or of small degree.
+ *
+ * use 3 wm
+ *
+ *@param r residue polynomial whose degree is less than mod polynomial
+ *@param x polynomial
+ *@param e exponent (big integer)
+ *@param mod sparse polynomial
+ *@param wm shared working memory
+ */
+void f2p_sparse_powermod(mpz_t r, mpz_t x, mpz_t e, const f2p_sparse_t *mod,
+                         f2p_wm_t *wm)
+{
+    assert(mod->size > 0); // zero divide
+    if (mpz_sgn(e) == 0) {
+        mpz_set_ui(r, 1);
+        return;
+    }
+    int mn = mod->exp[0] / F2P_LIMB_BITS + 1;
+    int mark = f2p_wm_mark(wm);
+    mpz_t *s = f2p_wm_alloc(wm);
+    mpz_t *acc = f2p_wm_alloc(wm);
+    mpz_t *prod = f2p_wm_alloc(wm);
+    mpz_set(*s, x);
+    f2p_sparse_mod(*s, mod);
+    int sn = (int)mpz_size(*s);
+    const mp_limb_t *sp = mpz_limbs_read(*s);
+    mp_limb_t *ap = mpz_limbs_write(*acc, 2 * mn);
+    mp_limb_t *pp = mpz_limbs_write(*prod, 2 * mn);
+    if (sn > 0) {
+        memcpy(ap, sp, (size_t)sn * sizeof(mp_limb_t));
+    }
+    int an = sn;
+    for (long i = (long)mpz_sizeinbase(e, 2) - 2; i >= 0 && an > 0; i--) {
+        f2p_limb_sqr_basecase(pp, ap, an);
+        an = sparse_mod_limbs(pp, 2 * an, mod);
+        mp_limb_t *t = ap;
+        ap = pp;
+        pp = t;
+        if (mpz_tstbit(e, (mp_bitcnt_t)i)) {
+            f2p_limb_mul_basecase(pp, ap, an, sp, sn);
+            an = sparse_mod_limbs(pp, an + sn, mod);
+            t = ap;
+            ap = pp;
+            pp = t;
+        }
+    }
+    mpz_set_ui(r, 0);
+    if (an > 0) {
+        mp_limb_t *d = mpz_limbs_write(r, an);
+        memcpy(d, ap, (size_t)an * sizeof(mp_limb_t));
+        mpz_limbs_finish(r, an);
+    }
+    f2p_wm_release(wm, mark);
+}
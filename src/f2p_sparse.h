@@ -0,0 +1,80 @@
+#pragma once
+#ifndef F2P_SPARSE_H
+#define F2P_SPARSE_H
+/**
+ * @file f2p_sparse.h
+ *
+ * @brief sparse F2 polynomials.
+ *
+ * f2p_sparse_t keeps exponents of nonzero terms in decreasing order.
+ * Minimal polynomials of LFSR type generators and field moduli are
+ * often trinomials or pentanomials, and reduction by such polynomial
+ * takes time linear in degree of dividend.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * sparse F2 polynomial
+ *
+ * exp[0] > exp[1] > ... > exp[size - 1] >= 0
+ */
+    struct F2P_SPARSE_T {
+        int size;      // number of terms
+        int capacity;  // allocated length of exp
+        int *exp;      // exponents in decreasing order
+    };
+
+    typedef struct F2P_SPARSE_T f2p_sparse_t;
+
+    void f2p_sparse_init(f2p_sparse_t *s);
+
+    void f2p_sparse_clear(f2p_sparse_t *s);
+
+    void f2p_sparse_set_exps(f2p_sparse_t *s, const int *exps, int n);
+
+    void f2p_sparse_set_mpz(f2p_sparse_t *s, mpz_t z);
+
+    void f2p_sparse_get_mpz(mpz_t z, const f2p_sparse_t *s);
+
+/**
+ * degree of polynomial
+ *
+ *@param s polynomial
+ *@return degree, -1 for the polynomial 0
+ */
+    static inline int f2p_sparse_degree(const f2p_sparse_t *s)
+    {
+        if (s->size == 0) {
+            return -1;
+        }
+        return s->exp[0];
+    }
+
+    void f2p_sparse_mul(mpz_t r, const f2p_sparse_t *a, mpz_t b,
+                        f2p_wm_t *wm);
+
+    void f2p_sparse_mod(mpz_t a, const f2p_sparse_t *mod);
+
+    void f2p_sparse_powermod(mpz_t r, mpz_t x, mpz_t e,
+                             const f2p_sparse_t *mod, f2p_wm_t *wm);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_SPARSE_H
@@ -0,0 +1,427 @@
+/**
+ * @file f2p_thread.c
+ *
+ * @brief Simple thread helper for F2 Polynomial Library.
+ *
+ * The executor keeps one deque of tasks for one worker, and all
+ * deques are protected by one mutex; tasks are expected to be
+ * polynomial operations, which are much longer than locking.
+ *
+ * Parallel for splits jobs into contiguous ranges, one range for one
+ * participant. The calling thread is participant 0 and other
+ * participants are tasks of the executor. A participant takes jobs
+ * from the front of its own range, and when its range is empty, it
+ * steals jobs from the back of other ranges.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "f2p_thread.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+struct F2P_TASK_T {
+    f2p_task_func_t func;
+    void * arg;
+    f2p_task_group_t * group;
+    struct F2P_TASK_T * prev;
+    struct F2P_TASK_T * next;
+};
+
+struct F2P_DEQUE_T {
+    struct F2P_TASK_T * front;
+    struct F2P_TASK_T * back;
+};
+
+struct F2P_EXECUTOR_T {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int size;                    // number of workers
+    int next;                    // deque for tasks from other threads
+    long submitted;              // number of submitted tasks
+    struct F2P_DEQUE_T * deque;  // one deque for one worker
+};
+
+static struct F2P_EXECUTOR_T executor;
+static pthread_once_t executor_once = PTHREAD_ONCE_INIT;
+static pthread_key_t worker_key;
+
+/**
+ * number of threads given by environment variable F2P_NUM_THREADS
+ * or number of online processors.
+ */
+static int default_threads(void)
+{
+    const char * env = getenv("F2P_NUM_THREADS");
+    if (env != NULL) {
+        int n = atoi(env);
+        if (n > 0) {
+            return n;
+        }
+    }
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n <= 0) {
+        return 1;
+    }
+    return (int)n;
+}
+
+static void push_back(struct F2P_DEQUE_T * d, struct F2P_TASK_T * t)
+{
+    t->next = NULL;
+    t->prev = d->back;
+    if (d->back != NULL) {
+        d->back->next = t;
+    } else {
+        d->front = t;
+    }
+    d->back = t;
+}
+
+static struct F2P_TASK_T * pop_back(struct F2P_DEQUE_T * d)
+{
+    struct F2P_TASK_T * t = d->back;
+    if (t != NULL) {
+        d->back = t->prev;
+        if (d->back != NULL) {
+            d->back->next = NULL;
+        } else {
+            d->front = NULL;
+        }
+    }
+    return t;
+}
+
+static struct F2P_TASK_T * pop_front(struct F2P_DEQUE_T * d)
+{
+    struct F2P_TASK_T * t = d->front;
+    if (t != NULL) {
+        d->front = t->next;
+        if (d->front != NULL) {
+            d->front->prev = NULL;
+        } else {
+            d->back = NULL;
+        }
+    }
+    return t;
+}
+
+/**
+ * take a task, executor.mutex should be locked.
+ *
+ *@param self worker number of calling thread, -1 if not a worker
+ *@return task, NULL if no task
+ */
+static struct F2P_TASK_T * take_task(int self)
+{
+    struct F2P_TASK_T * t = NULL;
+    int size = executor.size;
+    if (self >= 0) {
+        t = pop_back(&executor.deque[self]);
+    }
+    for (int i = 1; t == NULL && i <= size; i++) {
+        t = pop_front(&executor.deque[(self + i + size) % size]);
+    }
+    return t;
+}
+
+/**
+ * run a task, executor.mutex should be locked.
+ */
+static void run_task(struct F2P_TASK_T * t)
+{
+    pthread_mutex_unlock(&executor.mutex);
+    t->func(t->arg);
+    pthread_mutex_lock(&executor.mutex);
+    if (--t->group->count == 0) {
+        pthread_cond_broadcast(&executor.cond);
+    }
+    free(t);
+}
+
+static void * executor_main(void * p)
+{
+    int self = (int)(intptr_t)p;
+    pthread_setspecific(worker_key, (void *)(intptr_t)(self + 1));
+    pthread_mutex_lock(&executor.mutex);
+    for (;;) {
+        struct F2P_TASK_T * t = take_task(self);
+        if (t != NULL) {
+            run_task(t);
+        } else {
+            pthread_cond_wait(&executor.cond, &executor.mutex);
+        }
+    }
+    return NULL;
+}
+
+static void executor_init(void)
+{
+    pthread_key_create(&worker_key, NULL);
+    pthread_mutex_init(&executor.mutex, NULL);
+    pthread_cond_init(&executor.cond, NULL);
+    executor.size = default_threads();
+    executor.next = 0;
+    executor.deque = calloc(executor.size, sizeof(struct F2P_DEQUE_T));
+    assert(executor.deque != NULL);
+    // if a worker can not be created, its tasks are stolen by others
+    // or run by waiting threads.
+    for (int i = 0; i < executor.size; i++) {
+        pthread_t th;
+        if (pthread_create(&th, NULL, executor_main,
+                           (void *)(intptr_t)i) == 0) {
+            pthread_detach(th);
+        }
+    }
+}
+
+/**
+ * number of workers of the executor.
+ *
+ *@return number of workers
+ */
+int f2p_executor_size(void)
+{
+    pthread_once(&executor_once, executor_init);
+    return executor.size;
+}
+
+/**
+ * number of tasks submitted to the executor so far.
+ *
+ *@return number of tasks
+ */
+long f2p_executor_tasks(void)
+{
+    pthread_once(&executor_once, executor_init);
+    pthread_mutex_lock(&executor.mutex);
+    long n = executor.submitted;
+    pthread_mutex_unlock(&executor.mutex);
+    return n;
+}
+
+/**
+ * worker number of the calling thread.
+ *
+ *@return worker number, -1 if the calling thread is not a worker
+ */
+int f2p_executor_worker(void)
+{
+    pthread_once(&executor_once, executor_init);
+    return (int)(intptr_t)pthread_getspecific(worker_key) - 1;
+}
+
+/**
+ * initialize task group
+ *
+ *@param group task group
+ */
+void f2p_task_group_init(f2p_task_group_t *group)
+{
+    group->count = 0;
+}
+
+/**
+ * submit a task to the executor.
+ *
+ * func(arg) is called by a worker, or by a thread waiting for some
+ * task group.
+ *
+ *@param group task group of the task
+ *@param func task function
+ *@param arg argument of task function
+ */
+void f2p_task_submit(f2p_task_group_t *group, f2p_task_func_t func,
+                     void *arg)
+{
+    int self = f2p_executor_worker();
+    struct F2P_TASK_T * t = malloc(sizeof(struct F2P_TASK_T));
+    assert(t != NULL);
+    t->func = func;
+    t->arg = arg;
+    t->group = group;
+    pthread_mutex_lock(&executor.mutex);
+    group->count++;
+    executor.submitted++;
+    if (self < 0) {
+        self = executor.next;
+        executor.next = (executor.next + 1) % executor.size;
+    }
+    push_back(&executor.deque[self], t);
+    pthread_cond_signal(&executor.cond);
+    pthread_mutex_unlock(&executor.mutex);
+}
+
+/**
+ * wait for all tasks of group.
+ *
+ * The calling thread runs pending tasks while it waits.
+ *
+ *@param group task group
+ */
+void f2p_task_group_wait(f2p_task_group_t *group)
+{
+    int self = f2p_executor_worker();
+    pthread_mutex_lock(&executor.mutex);
+    while (group->count > 0) {
+        struct F2P_TASK_T * t = take_task(self);
+        if (t != NULL) {
+            run_task(t);
+        } else {
+            pthread_cond_wait(&executor.cond, &executor.mutex);
+        }
+    }
+    pthread_mutex_unlock(&executor.mutex);
+}
+
+struct F2P_RANGE_T {
+    pthread_mutex_t mutex;
+    int lo;
+    int hi;
+};
+
+struct F2P_PFOR_T {
+    int num_threads;
+    struct F2P_RANGE_T * range;
+    f2p_job_func_t func;
+    void * arg;
+};
+
+struct F2P_WORKER_T {
+    int worker;
+    struct F2P_PFOR_T * pfor;
+};
+
+/**
+ * take a job from the front of own range.
+ *
+ *@param range range of the worker
+ *@return job index, -1 if range is empty
+ */
+static int take_front(struct F2P_RANGE_T * range)
+{
+    int index = -1;
+    pthread_mutex_lock(&range->mutex);
+    if (range->lo < range->hi) {
+        index = range->lo++;
+    }
+    pthread_mutex_unlock(&range->mutex);
+    return index;
+}
+
+/**
+ * steal a job from the back of other range.
+ *
+ *@param range range of the victim
+ *@return job index, -1 if range is empty
+ */
+static int take_back(struct F2P_RANGE_T * range)
+{
+    int index = -1;
+    pthread_mutex_lock(&range->mutex);
+    if (range->lo < range->hi) {
+        index = --range->hi;
+    }
+    pthread_mutex_unlock(&range->mutex);
+    return index;
+}
+
+static void participant_main(void * p)
+{
+    struct F2P_WORKER_T * w = p;
+    struct F2P_PFOR_T * pfor = w->pfor;
+    int num = pfor->num_threads;
+    for (;;) {
+        int index = take_front(&pfor->range[w->worker]);
+        for (int i = 1; index < 0 && i < num; i++) {
+            index = take_back(&pfor->range[(w->worker + i) % num]);
+        }
+        if (index < 0) {
+            break;
+        }
+        pfor->func(index, w->worker, pfor->arg);
+    }
+}
+
+/**
+ * number of threads.
+ *
+ *@param num_threads requested number of threads, 0 or negative means
+ * F2P_NUM_THREADS or number of online processors.
+ *@return number of threads
+ */
+int f2p_num_threads(int num_threads)
+{
+    if (num_threads > 0) {
+        return num_threads;
+    }
+    return f2p_executor_size();
+}
+
+/**
+ * parallel for
+ *
+ * call func(index, worker, arg) for each 0 <= index < num_jobs.
+ * worker 0 is the calling thread, other workers are tasks of the
+ * executor.
+ *
+ *@param num_jobs number of jobs
+ *@param num_threads number of threads, 0 means F2P_NUM_THREADS or
+ * number of processors
+ *@param func job function
+ *@param arg argument of job function
+ */
+void f2p_parallel_for(int num_jobs, int num_threads,
+                      f2p_job_func_t func, void *arg)
+{
+    int num = f2p_num_threads(num_threads);
+    if (num > num_jobs) {
+        num = num_jobs;
+    }
+    if (num <= 1) {
+        for (int i = 0; i < num_jobs; i++) {
+            func(i, 0, arg);
+        }
+        return;
+    }
+    struct F2P_PFOR_T pfor;
+    pfor.num_threads = num;
+    pfor.func = func;
+    pfor.arg = arg;
+    pfor.range = malloc(num * sizeof(struct F2P_RANGE_T));
+    struct F2P_WORKER_T * w = malloc(num * sizeof(struct F2P_WORKER_T));
+    assert(pfor.range != NULL && w != NULL);
+    for (int i = 0; i < num; i++) {
+        pthread_mutex_init(&pfor.range[i].mutex, NULL);
+        pfor.range[i].lo = (int)((long)num_jobs * i / num);
+        pfor.range[i].hi = (int)((long)num_jobs * (i + 1) / num);
+        w[i].worker = i;
+        w[i].pfor = &pfor;
+    }
+    // a participant which starts late finds all ranges empty.
+    f2p_task_group_t group;
+    f2p_task_group_init(&group);
+    for (int i = 1; i < num; i++) {
+        f2p_task_submit(&group, participant_main, &w[i]);
+    }
+    participant_main(&w[0]);
+    f2p_task_group_wait(&group);
+    for (int i = 0; i < num; i++) {
+        pthread_mutex_destroy(&pfor.range[i].mutex);
+    }
+    free(w);
+    free(pfor.range);
+}
@@ -0,0 +1,88 @@
+#pragma once
+#ifndef F2P_THREAD_H
+#define F2P_THREAD_H
+/**
+ * @file f2p_thread.h
+ *
+ * @brief Simple thread helper for F2 Polynomial Library.
+ *
+ * The library has one executor, a set of worker threads created at
+ * first use and kept until the process exits. The number of workers
+ * is the value of environment variable F2P_NUM_THREADS, or the number
+ * of online processors if it is not set. Each worker has its own
+ * deque of tasks; it takes tasks from the back of its own deque and
+ * steals tasks from the front of other deques. A thread waiting for a
+ * task group runs pending tasks while it waits, so tasks can submit
+ * tasks and wait for them.
+ *
+ * Each worker uses its own thread local working memory
+ * (f2p_wm_thread_local), which is kept among tasks.
+ *
+ * Functions of this library are reentrant: they have no static
+ * state except the executor and thread local working memories, and
+ * can be called from multiple threads if each thread uses its own
+ * f2p_wm_t and output variables.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * job function called by parallel for.
+ *
+ *@param index job index 0 <= index < num_jobs
+ *@param worker worker number 0 <= worker < num_threads
+ *@param arg user argument
+ */
+    typedef void (*f2p_job_func_t)(int index, int worker, void *arg);
+
+/**
+ * task function run by the executor.
+ *
+ *@param arg user argument
+ */
+    typedef void (*f2p_task_func_t)(void *arg);
+
+/**
+ * group of tasks to be waited together
+ */
+    struct F2P_TASK_GROUP_T {
+        int count;  // number of unfinished tasks
+    };
+
+    typedef struct F2P_TASK_GROUP_T f2p_task_group_t;
+
+    int f2p_num_threads(int num_threads);
+
+    int f2p_executor_size(void);
+
+    int f2p_executor_worker(void);
+
+    long f2p_executor_tasks(void);
+
+    void f2p_task_group_init(f2p_task_group_t *group);
+
+    void f2p_task_submit(f2p_task_group_t *group, f2p_task_func_t func,
+                         void *arg);
+
+    void f2p_task_group_wait(f2p_task_group_t *group);
+
+    void f2p_parallel_for(int num_jobs, int num_threads,
+                          f2p_job_func_t func, void *arg);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_THREAD_H
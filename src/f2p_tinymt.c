@@ -0,0 +1,212 @@
+/**
+ * @file f2p_tinymt.c
+ *
+ * @brief Parameter search of TinyMT32 (dynamic creator).
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_tinymt.h"
+#include "f2p_thread.h"
+#include "debug_f2p.h"
+#include <inttypes.h>
+#include <stdlib.h>
+
+#define TINYMT32_SH0 1
+#define TINYMT32_SH1 10
+#define TINYMT32_SH8 8
+#define TINYMT32_MASK UINT32_C(0x7fffffff)
+
+/**
+ * bijective mixing of 64-bit integers (finalizer of MurmurHash3)
+ */
+static uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= UINT64_C(0xff51afd7ed558ccd);
+    x ^= x >> 33;
+    x *= UINT64_C(0xc4ceb9fe1a85ec53);
+    x ^= x >> 33;
+    return x;
+}
+
+/**
+ * initialize parameter set
+ *
+ *@param param parameter set
+ */
+void f2p_tinymt32_param_init(f2p_tinymt32_param_t *param)
+{
+    param->id = 0;
+    param->mat1 = 0;
+    param->mat2 = 0;
+    param->tmat = 0;
+    param->weight = 0;
+    mpz_init(param->charpoly);
+}
+
+/**
+ * clear parameter set
+ *
+ *@param param parameter set
+ */
+void f2p_tinymt32_param_clear(f2p_tinymt32_param_t *param)
+{
+    mpz_clear(param->charpoly);
+}
+
+/**
+ * set candidate of the id
+ *
+ *@param param parameter set, mat1, mat2, tmat and id are set
+ *@param seed seed of search
+ *@param id id of candidate
+ */
+void f2p_tinymt32_candidate(f2p_tinymt32_param_t *param, uint64_t seed,
+                            uint64_t id)
+{
+    uint64_t x = mix64(id ^ seed);
+    param->id = id;
+    param->mat1 = (uint32_t)(x >> 32);
+    param->mat2 = (uint32_t)x;
+    param->tmat = (uint32_t)(mix64(x ^ UINT64_C(0x9e3779b97f4a7c15)) >> 32);
+}
+
+/**
+ * check candidate, mat1, mat2 and tmat should be set.
+ *
+ * The least significant bit of the output of TinyMT32 is linear, so
+ * the characteristic polynomial is the minimal polynomial of the bits.
+ *
+ *@param param parameter set, charpoly and weight are set
+ *@return 1 if charpoly is irreducible of degree 127, 0 otherwise
+ */
+int f2p_tinymt32_check(f2p_tinymt32_param_t *param)
+{
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    int mark = f2p_wm_mark(wm);
+    mpz_t *seq = f2p_wm_alloc(wm);
+    mpz_set_ui(*seq, 0);
+    uint32_t st[4] = {1, 0, 0, 0};
+    for (int i = 0; i < 2 * F2P_TINYMT32_MEXP; i++) {
+        // tinymt32_next_state
+        uint32_t y = st[3];
+        uint32_t x = (st[0] & TINYMT32_MASK) ^ st[1] ^ st[2];
+        x ^= (x << TINYMT32_SH0);
+        y ^= (y >> TINYMT32_SH0) ^ x;
+        st[0] = st[1];
+        st[1] = st[2];
+        st[2] = x ^ (y << TINYMT32_SH1);
+        st[3] = y;
+        if (y & 1) {
+            st[1] ^= param->mat1;
+            st[2] ^= param->mat2;
+        }
+        // least significant bit of tinymt32_temper
+        uint32_t t1 = st[0] ^ (st[2] >> TINYMT32_SH8);
+        uint32_t t0 = st[3] ^ t1;
+        if (t1 & 1) {
+            t0 ^= param->tmat;
+        }
+        if (t0 & 1) {
+            mpz_setbit(*seq, i);
+        }
+    }
+    f2p_minpoly(param->charpoly, *seq, F2P_TINYMT32_MEXP);
+    f2p_wm_release(wm, mark);
+    param->weight = (int)mpz_popcount(param->charpoly);
+    if (f2p_degree(param->charpoly) != F2P_TINYMT32_MEXP) {
+        return 0;
+    }
+    return f2p_is_irreducible(param->charpoly);
+}
+
+struct SEARCH_ARG_T {
+    uint64_t seed;
+    uint64_t base;
+    unsigned char *accepted;
+};
+
+static void search_job(int index, int worker, void *p)
+{
+    (void)worker;
+    struct SEARCH_ARG_T *arg = p;
+    f2p_tinymt32_param_t param;
+    f2p_tinymt32_param_init(&param);
+    for (int i = index * F2P_TINYMT32_BLOCK;
+         i < (index + 1) * F2P_TINYMT32_BLOCK; i++) {
+        f2p_tinymt32_candidate(&param, arg->seed, arg->base + (uint64_t)i);
+        arg->accepted[i] = (unsigned char)f2p_tinymt32_check(&param);
+    }
+    f2p_tinymt32_param_clear(&param);
+}
+
+/**
+ * search parameter sets
+ *
+ * Candidates of id, id + 1, ... are checked and the first count
+ * accepted sets are stored. The search stops if the control of the
+ * calling thread is cancelled.
+ *
+ *@param params array of count initialized parameter sets
+ *@param count number of parameter sets
+ *@param seed seed of search
+ *@param id first id to check, next id to check is stored
+ *@param num_threads number of threads, 0 means size of the executor
+ *@return number of stored parameter sets
+ */
+long f2p_tinymt32_search(f2p_tinymt32_param_t *params, long count,
+                         uint64_t seed, uint64_t *id, int num_threads)
+{
+    PUTS("f2p_tinymt32_search start\n");
+    int num_jobs = f2p_num_threads(num_threads) * 4;
+    unsigned char *accepted = malloc((size_t)num_jobs * F2P_TINYMT32_BLOCK);
+    assert(accepted != NULL);
+    struct SEARCH_ARG_T arg = {seed, *id, accepted};
+    long found = 0;
+    while (found < count && !f2p_control_poll(found)) {
+        arg.base = *id;
+        f2p_parallel_for(num_jobs, num_threads, search_job, &arg);
+        int n = num_jobs * F2P_TINYMT32_BLOCK;
+        for (int i = 0; i < n && found < count; i++) {
+            *id = arg.base + (uint64_t)i + 1;
+            if (accepted[i]) {
+                f2p_tinymt32_candidate(&params[found], seed,
+                                       arg.base + (uint64_t)i);
+                f2p_tinymt32_check(&params[found]);
+                found++;
+            }
+        }
+    }
+    free(accepted);
+    PUTS("f2p_tinymt32_search end\n");
+    return found;
+}
+
+/**
+ * print parameter set in the format of TinyMTDC:
+ * characteristic, type, id, mat1, mat2, tmat, weight
+ *
+ *@param fp output file
+ *@param param parameter set
+ *@return 0 if success, -1 otherwise
+ */
+int f2p_tinymt32_param_fprint(FILE *fp, const f2p_tinymt32_param_t *param)
+{
+    if (mpz_out_str(fp, 16, param->charpoly) == 0) {
+        return -1;
+    }
+    if (fprintf(fp, ",32,%" PRIu64 ",%08" PRIx32 ",%08" PRIx32 ",%08"
+                PRIx32 ",%d\n", param->id, param->mat1, param->mat2,
+                param->tmat, param->weight) < 0) {
+        return -1;
+    }
+    return 0;
+}
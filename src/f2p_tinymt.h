@@ -0,0 +1,82 @@
+#pragma once
+#ifndef F2P_TINYMT_H
+#define F2P_TINYMT_H
+/**
+ * @file f2p_tinymt.h
+ *
+ * @brief Parameter search of TinyMT32 (dynamic creator).
+ *
+ * A parameter set (mat1, mat2, tmat) of TinyMT32 is accepted if the
+ * characteristic polynomial of its state transition is irreducible of
+ * degree 127. Since 2^127 - 1 is prime, the period is then 2^127 - 1.
+ * The characteristic polynomial is the minimal polynomial of the
+ * least significant bits of 254 outputs, calculated by f2p_minpoly.
+ *
+ * Candidates are numbered by 64-bit ids. (mat1, mat2) is a bijective
+ * mixing of the id and the seed, so candidates of distinct ids under
+ * the same seed are distinct. A search checks consecutive ids in
+ * parallel and returns accepted sets in the order of ids, so the
+ * result does not depend on the number of threads, and a search can
+ * be continued from the next id.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "f2p_gmp.h"
+#include <stdio.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * F2P_TINYMT32_MEXP: degree of characteristic polynomial
+ * F2P_TINYMT32_BLOCK: number of ids checked by one job of search
+ */
+    enum {
+        F2P_TINYMT32_MEXP = 127,
+        F2P_TINYMT32_BLOCK = 256
+    };
+
+/**
+ * parameter set of TinyMT32
+ */
+    struct F2P_TINYMT32_PARAM_T {
+        uint64_t id;       // id of candidate
+        uint32_t mat1;
+        uint32_t mat2;
+        uint32_t tmat;
+        int weight;        // number of nonzero terms of charpoly
+        mpz_t charpoly;    // characteristic polynomial
+    };
+
+    typedef struct F2P_TINYMT32_PARAM_T f2p_tinymt32_param_t;
+
+    void f2p_tinymt32_param_init(f2p_tinymt32_param_t *param);
+
+    void f2p_tinymt32_param_clear(f2p_tinymt32_param_t *param);
+
+    void f2p_tinymt32_candidate(f2p_tinymt32_param_t *param, uint64_t seed,
+                                uint64_t id);
+
+    int f2p_tinymt32_check(f2p_tinymt32_param_t *param);
+
+    long f2p_tinymt32_search(f2p_tinymt32_param_t *params, long count,
+                             uint64_t seed, uint64_t *id, int num_threads);
+
+    int f2p_tinymt32_param_fprint(FILE *fp,
+                                  const f2p_tinymt32_param_t *param);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // F2P_TINYMT_H
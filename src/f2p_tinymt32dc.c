@@ -0,0 +1,107 @@
+/**
+ * @file f2p_tinymt32dc.c
+ *
+ * @brief Parameter search tool of TinyMT32.
+ *
+ * usage: f2p_tinymt32dc [-s seed] [-i id] [-c count] [-t threads]
+ *        [-o file]
+ *
+ * Accepted parameter sets are printed in the format of TinyMTDC, one
+ * line each. The next id is printed to stderr, so the search can be
+ * continued by -i with the same seed.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "f2p_tinymt.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-s seed] [-i id] [-c count] [-t threads]"
+            " [-o file]\n", name);
+}
+
+int main(int argc, char * argv[])
+{
+    uint64_t seed = 1;
+    uint64_t id = 0;
+    long count = 1000;
+    int num_threads = 0;
+    const char *file = NULL;
+    int c;
+    while ((c = getopt(argc, argv, "s:i:c:t:o:")) != -1) {
+        switch (c) {
+        case 's':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+        case 'i':
+            id = strtoull(optarg, NULL, 0);
+            break;
+        case 'c':
+            count = strtol(optarg, NULL, 0);
+            break;
+        case 't':
+            num_threads = (int)strtol(optarg, NULL, 0);
+            break;
+        case 'o':
+            file = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (count <= 0 || num_threads < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    FILE *fp = stdout;
+    if (file != NULL) {
+        fp = fopen(file, "w");
+        if (fp == NULL) {
+            perror(file);
+            return 1;
+        }
+    }
+    f2p_tinymt32_param_t *params = malloc(count
+                                          * sizeof(f2p_tinymt32_param_t));
+    if (params == NULL) {
+        fprintf(stderr, "can't allocate %ld parameter sets\n", count);
+        return 1;
+    }
+    for (long i = 0; i < count; i++) {
+        f2p_tinymt32_param_init(&params[i]);
+    }
+    long found = f2p_tinymt32_search(params, count, seed, &id, num_threads);
+    int r = 0;
+    fprintf(fp, "# characteristic, type, id, mat1, mat2, tmat, weight\n");
+    for (long i = 0; i < found && r == 0; i++) {
+        r = f2p_tinymt32_param_fprint(fp, &params[i]);
+    }
+    if (fp != stdout) {
+        r |= fclose(fp) != 0;
+    }
+    if (r != 0) {
+        fprintf(stderr, "write error\n");
+    }
+    fprintf(stderr, "seed = %" PRIu64 " next id = %" PRIu64 "\n", seed, id);
+    for (long i = 0; i < count; i++) {
+        f2p_tinymt32_param_clear(&params[i]);
+    }
+    free(params);
+    return r == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file test_alloc.c
+ *
+ * @brief test program for f2p_alloc.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_alloc.h"
+#include "f2p_gmp.h"
+#include <stdio.h>
+
+/**
+ * count of irreducible t^200 + f for odd f of degree less than 8,
+ * degree 128 or more is calculated by GMP, not by f2p_small.h.
+ * Polynomials and working memory are allocated for each candidate.
+ */
+static int irreducible_count(void)
+{
+    int count = 0;
+    for (unsigned long i = 0; i < 128; i++) {
+        mpz_t poly;
+        mpz_init_set_ui(poly, 2 * i + 1);
+        mpz_setbit(poly, 200);
+        f2p_wm_t wm;
+        f2p_wm_init(&wm, 10);
+        if (f2p_is_irreducible_aux(poly, &wm)) {
+            count++;
+        }
+        f2p_wm_clear(&wm);
+        mpz_clear(poly);
+    }
+    return count;
+}
+
+int test_alloc(int verbose)
+{
+    if (verbose) {
+        printf("start test_alloc\n");
+    }
+    int ok = 1;
+    void *(*alloc0)(size_t);
+    void *(*realloc0)(void *, size_t, size_t);
+    void (*free0)(void *, size_t);
+    void *(*alloc1)(size_t);
+    void *(*realloc1)(void *, size_t, size_t);
+    void (*free1)(void *, size_t);
+    mp_get_memory_functions(&alloc0, &realloc0, &free0);
+    int expected = irreducible_count();
+    f2p_alloc_scope_begin();
+    f2p_alloc_reset_stats();
+    mpz_t escape;
+    mpz_init(escape);
+    f2p_alloc_scope_begin();
+    int count = irreducible_count();
+    mpz_set_ui(escape, 1);
+    mpz_mul_2exp(escape, escape, 1000);
+    f2p_alloc_scope_end();
+    f2p_alloc_scope_end();
+    f2p_alloc_stats_t stats;
+    f2p_alloc_get_stats(&stats);
+    if (verbose) {
+        printf("alloc %lu (cached %lu) realloc %lu (cached %lu)"
+               " free %lu (cached %lu)\n",
+               stats.alloc, stats.alloc_cached,
+               stats.realloc, stats.realloc_cached,
+               stats.free, stats.free_cached);
+    }
+    if (count != expected) {
+        printf("count = %d expected = %d\n", count, expected);
+        ok = 0;
+    }
+    if (stats.alloc + stats.realloc < 128 || stats.free_cached == 0
+        || stats.alloc_cached + stats.realloc_cached == 0) {
+        printf("no allocation was served from cache\n");
+        ok = 0;
+    }
+    // memory functions are kept, threads out of scope are forwarded
+    mp_get_memory_functions(&alloc1, &realloc1, &free1);
+    if (alloc1 == alloc0 || realloc1 == realloc0 || free1 == free0) {
+        printf("memory functions are restored\n");
+        ok = 0;
+    }
+    f2p_alloc_reset_stats();
+    count = irreducible_count();
+    if (count != expected) {
+        printf("count out of scope = %d expected = %d\n", count,
+               expected);
+        ok = 0;
+    }
+    f2p_alloc_get_stats(&stats);
+    if (stats.alloc != 0 || stats.free != 0) {
+        printf("allocation out of scope is counted\n");
+        ok = 0;
+    }
+    if (mpz_sizeinbase(escape, 2) != 1001) {
+        printf("escaped value is broken\n");
+        ok = 0;
+    }
+    mpz_clear(escape);
+    if (verbose) {
+        printf("end test_alloc\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_alloc(verbose);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -0,0 +1,201 @@
+/**
+ * @file test_async.c
+ *
+ * @brief test program for f2p_async.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "f2p_async.h"
+#include "tinymt32.h"
+#include <stdio.h>
+#include <time.h>
+
+static pthread_mutex_t count_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int callback_count = 0;
+
+static void count_callback(f2p_job_t *job, void *arg)
+{
+    int *state = arg;
+    pthread_mutex_lock(&count_mutex);
+    callback_count++;
+    *state = f2p_job_state(job);
+    pthread_mutex_unlock(&count_mutex);
+}
+
+static void make_seq(mpz_t seq, int mexp)
+{
+    tinymt32_t tiny32;
+    tiny32.mat1 = 0x8f7011ee;
+    tiny32.mat2 = 0xfc78ff1f;
+    tiny32.tmat = 0x3793fdff;
+    tinymt32_init(&tiny32, 1234);
+    mpz_set_ui(seq, 0);
+    for (int i = 0; i < mexp * 2; i++) {
+        if (tinymt32_generate_uint32(&tiny32) & 1) {
+            mpz_setbit(seq, i);
+        }
+    }
+}
+
+int test_async(int verbose)
+{
+    if (verbose) {
+        printf("start test_async\n");
+    }
+    int ok = 1;
+    int mexp = 127;
+    int state[4] = {-1, -1, -1, -1};
+    mpz_t seq;
+    mpz_t minpoly;
+    mpz_t expected;
+    mpz_t poly;
+    mpz_t step;
+    mpz_init(seq);
+    mpz_init(minpoly);
+    mpz_init(expected);
+    mpz_init(poly);
+    mpz_init_set_ui(step, 123456789);
+    make_seq(seq, mexp);
+    f2p_minpoly(minpoly, seq, mexp);
+    f2p_job_t *job[4];
+    job[0] = f2p_minpoly_async(seq, mexp, count_callback, &state[0]);
+    f2p_set_hexstr(poly, "d8524022ed8dff4a8dcc50c798faba43");
+    job[1] = f2p_is_irreducible_async(poly, count_callback, &state[1]);
+    f2p_set_hexstr(poly, "d8524022ed8dff4a8dcc50c798faba47");
+    job[2] = f2p_is_irreducible_async(poly, count_callback, &state[2]);
+    job[3] = f2p_calc_jump_async(minpoly, step, count_callback, &state[3]);
+    for (int i = 0; i < 4; i++) {
+        if (f2p_job_wait(job[i]) != F2P_JOB_DONE) {
+            printf("test_async job %d not done\n", i);
+            ok = 0;
+        }
+    }
+    f2p_job_get_poly(poly, job[0]);
+    if (mpz_cmp(poly, minpoly) != 0) {
+        printf("test_async minpoly failure\n");
+        ok = 0;
+    }
+    if (f2p_job_get_irreducible(job[1]) != 1
+        || f2p_job_get_irreducible(job[2]) != 0) {
+        printf("test_async irreducible failure\n");
+        ok = 0;
+    }
+    f2p_calc_jump(expected, minpoly, step);
+    f2p_job_get_poly(poly, job[3]);
+    if (mpz_cmp(poly, expected) != 0) {
+        printf("test_async calc_jump failure\n");
+        ok = 0;
+    }
+    pthread_mutex_lock(&count_mutex);
+    if (callback_count != 4) {
+        printf("test_async callback count = %d\n", callback_count);
+        ok = 0;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (state[i] != F2P_JOB_DONE) {
+            printf("test_async callback state %d = %d\n", i, state[i]);
+            ok = 0;
+        }
+    }
+    pthread_mutex_unlock(&count_mutex);
+    for (int i = 0; i < 4; i++) {
+        f2p_job_free(job[i]);
+    }
+    // cancel irreducibility check of x^9689 + x^84 + 1
+    mpz_set_ui(poly, 0);
+    mpz_setbit(poly, 9689);
+    mpz_setbit(poly, 84);
+    mpz_setbit(poly, 0);
+    int cstate = -1;
+    f2p_job_t *cjob = f2p_is_irreducible_async(poly, count_callback,
+                                               &cstate);
+    struct timespec wait = {0, 1000000};
+    while (f2p_job_progress(cjob) < 2
+           && f2p_job_state(cjob) == F2P_JOB_RUNNING) {
+        nanosleep(&wait, NULL);
+    }
+    long progress = f2p_job_progress(cjob);
+    f2p_job_cancel(cjob);
+    if (f2p_job_wait(cjob) != F2P_JOB_CANCELLED) {
+        printf("test_async cancel failure\n");
+        ok = 0;
+    }
+    if (verbose) {
+        printf("cancelled at %ld, stopped at %ld of %d squarings\n",
+               progress, f2p_job_progress(cjob), 9689 / 2);
+    }
+    if (f2p_job_progress(cjob) >= 9689 / 2) {
+        printf("test_async cancel too late\n");
+        ok = 0;
+    }
+    pthread_mutex_lock(&count_mutex);
+    if (callback_count != 5 || cstate != F2P_JOB_CANCELLED) {
+        printf("test_async cancel callback failure\n");
+        ok = 0;
+    }
+    pthread_mutex_unlock(&count_mutex);
+    f2p_job_free(cjob);
+    // t + 1 is checked without loop, so cancel does not stop it
+    mpz_set_ui(poly, 3);
+    cjob = f2p_is_irreducible_async(poly, NULL, NULL);
+    f2p_job_cancel(cjob);
+    if (f2p_job_wait(cjob) != F2P_JOB_DONE
+        || f2p_job_get_irreducible(cjob) != 1) {
+        printf("test_async late cancel failure\n");
+        ok = 0;
+    }
+    f2p_job_free(cjob);
+    // cancel of the gcd loop
+    f2p_control_t ctl = {1, 0, 0};
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    f2p_control_set(&ctl);
+    f2p_gcd(expected, seq, minpoly, &wm);
+    f2p_control_set(NULL);
+    f2p_wm_clear(&wm);
+    if (!f2p_control_stopped(&ctl) || f2p_control_progress(&ctl) != 0) {
+        printf("test_async gcd cancel failure\n");
+        ok = 0;
+    }
+    mpz_clear(seq);
+    mpz_clear(minpoly);
+    mpz_clear(expected);
+    mpz_clear(poly);
+    mpz_clear(step);
+    if (verbose) {
+        printf("end test_async\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_async(verbose);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -0,0 +1,203 @@
+/**
+ * @file test_batch.c
+ *
+ * @brief test program for f2p_batch.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+
+static double now_ms(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+int test_batch_aux(int verbose, int degree, int count, int num_threads,
+                   gmp_randstate_t rs, f2p_wm_t *wm)
+{
+    int ok = 1;
+    mpz_t mod, e, r, expected;
+    mpz_inits(mod, e, r, expected, NULL);
+    mpz_t *a = malloc(sizeof(mpz_t) * count);
+    mpz_t *b = malloc(sizeof(mpz_t) * count);
+    mpz_urandomb(mod, rs, degree);
+    mpz_setbit(mod, degree);
+    f2p_modctx_t ctx;
+    f2p_modctx_init(&ctx, mod);
+    f2p_batch_t ba;
+    f2p_batch_t bb;
+    f2p_batch_t br;
+    f2p_batch_init(&ba, count, &ctx);
+    f2p_batch_init(&bb, count, &ctx);
+    f2p_batch_init(&br, count, &ctx);
+    for (int i = 0; i < count; i++) {
+        mpz_init(a[i]);
+        mpz_init(b[i]);
+        // elements larger than mod are reduced by f2p_batch_set
+        mpz_urandomb(a[i], rs, degree + 10);
+        mpz_urandomb(b[i], rs, degree);
+        f2p_batch_set(&ba, i, a[i]);
+        f2p_batch_set(&bb, i, b[i]);
+    }
+    f2p_mulmod_batch(&br, &ba, &bb, num_threads);
+    for (int i = 0; i < count; i++) {
+        f2p_batch_get(r, &br, i);
+        f2p_mulmod(expected, a[i], b[i], mod, wm);
+        if (mpz_cmp(r, expected) != 0) {
+            printf("mulmod_batch failure degree = %d i = %d\n", degree, i);
+            ok = 0;
+        }
+    }
+    mpz_urandomb(e, rs, 80);
+    // result overwrites operand
+    f2p_powermod_batch(&ba, &ba, e, num_threads);
+    for (int i = 0; i < count; i++) {
+        f2p_batch_get(r, &ba, i);
+        f2p_powermod(expected, a[i], e, mod, wm);
+        f2p_mod(expected, mod, wm);
+        if (mpz_cmp(r, expected) != 0) {
+            printf("powermod_batch failure degree = %d i = %d\n", degree, i);
+            ok = 0;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        mpz_clear(a[i]);
+        mpz_clear(b[i]);
+    }
+    free(a);
+    free(b);
+    f2p_batch_clear(&ba);
+    f2p_batch_clear(&bb);
+    f2p_batch_clear(&br);
+    f2p_modctx_clear(&ctx);
+    mpz_clears(mod, e, r, expected, NULL);
+    if (verbose && !ok) {
+        printf("degree = %d count = %d\n", degree, count);
+    }
+    return ok;
+}
+
+int test_batch(int verbose)
+{
+    if (verbose) {
+        printf("start test_batch\n");
+    }
+    int ok = 1;
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 2468);
+    int degrees[] = {0, 1, 5, 63, 64, 65, 127, 128, 300, 521, 2203};
+    for (int i = 0; i < (int)(sizeof(degrees) / sizeof(int)); i++) {
+        ok &= test_batch_aux(verbose, degrees[i], 13, 1, rs, &wm);
+        ok &= test_batch_aux(verbose, degrees[i], 37, 4, rs, &wm);
+    }
+    gmp_randclear(rs);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_batch\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_batch_speed(int verbose)
+{
+    if (!verbose) {
+        return 1;
+    }
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 1);
+    int degree = 4253;
+    int count = 256;
+    mpz_t mod, r;
+    mpz_inits(mod, r, NULL);
+    mpz_t *a = malloc(sizeof(mpz_t) * count);
+    mpz_urandomb(mod, rs, degree);
+    mpz_setbit(mod, degree);
+    f2p_modctx_t ctx;
+    f2p_modctx_init(&ctx, mod);
+    f2p_batch_t ba;
+    f2p_batch_init(&ba, count, &ctx);
+    for (int i = 0; i < count; i++) {
+        mpz_init(a[i]);
+        mpz_urandomb(a[i], rs, degree);
+        f2p_batch_set(&ba, i, a[i]);
+    }
+    double start = now_ms();
+    for (int i = 0; i < count; i++) {
+        f2p_mulmod(r, a[i], a[(i + 1) % count], mod, &wm);
+    }
+    double t1 = now_ms() - start;
+    start = now_ms();
+    f2p_mulmod_batch(&ba, &ba, &ba, 1);
+    double t2 = now_ms() - start;
+    start = now_ms();
+    f2p_mulmod_batch(&ba, &ba, &ba, 0);
+    double t3 = now_ms() - start;
+    printf("degree %d %d mulmod loop %.3f ms, batch %.3f ms, "
+           "batch threads %.3f ms\n", degree, count, t1, t2, t3);
+    mpz_t e;
+    mpz_init(e);
+    mpz_urandomb(e, rs, 64);
+    start = now_ms();
+    for (int i = 0; i < count; i++) {
+        f2p_powermod(r, a[i], e, mod, &wm);
+    }
+    t1 = now_ms() - start;
+    start = now_ms();
+    f2p_powermod_batch(&ba, &ba, e, 1);
+    t2 = now_ms() - start;
+    printf("degree %d %d powermod of 64 bits loop %.3f ms, batch %.3f ms\n",
+           degree, count, t1, t2);
+    mpz_clear(e);
+    for (int i = 0; i < count; i++) {
+        mpz_clear(a[i]);
+    }
+    free(a);
+    f2p_batch_clear(&ba);
+    f2p_modctx_clear(&ctx);
+    mpz_clears(mod, r, NULL);
+    gmp_randclear(rs);
+    f2p_wm_clear(&wm);
+    return 1;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_batch(verbose);
+    ok *= test_batch_speed(verbose);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -17,19 +17,20 @@
 #include "f2p_gmp.h"
 #include <string.h>
 
-int test_string(int verbose, int wp, f2p_wm_t *wm)
+int test_string(int verbose, f2p_wm_t *wm)
 {
     if (verbose) {
         printf("start test_string\n");
     }
     char * str1 = "101";
     char buffer[100];
-    mpz_t *x = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
     f2p_set_binstr(*x, str1);
     f2p_get_binstr(buffer, *x);
     int r;
     r = strcmp(str1, buffer);
+    f2p_wm_release(wm, mark);
     if (r != 0) {
         printf("test_string failure\n");
         printf("org str = |%s|\n", str1);
@@ -47,14 +48,14 @@ int test_string(int verbose, int wp, f2p_wm_t *wm)
     }
 }
 
-int test_degree(int verbose, int wp, f2p_wm_t *wm)
+int test_degree(int verbose, f2p_wm_t *wm)
 {
     if (verbose) {
         printf("start test_degree\n");
     }
     //int r = 0;
-    mpz_t *x = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
 
     f2p_set_binstr(*x, "101");
     size_t deg = f2p_degree(*x);
@@ -77,20 +78,21 @@ int test_degree(int verbose, int wp, f2p_wm_t *wm)
     } else {
         printf("x");
     }
+    f2p_wm_release(wm, mark);
     return ok;
 }
 
-int test_add(int verbose, int wp, f2p_wm_t *wm)
+int test_add(int verbose, f2p_wm_t *wm)
 {
     if (verbose) {
         printf("start test_add\n");
     }
     //int r = 0;
     int ok = 1;
-    mpz_t *x = &(wm->ar[wp++]);
-    mpz_t *y = &(wm->ar[wp++]);
-    mpz_t *z = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_t *y = f2p_wm_alloc(wm);
+    mpz_t *z = f2p_wm_alloc(wm);
 
     f2p_set_binstr(*x, "101");
     f2p_set_binstr(*y, "011");
@@ -117,17 +119,18 @@ int test_add(int verbose, int wp, f2p_wm_t *wm)
         printf("x");
     }
 
+    f2p_wm_release(wm, mark);
     return ok;
 }
 
-int test_lshift(int verbose, int wp, f2p_wm_t *wm)
+int test_lshift(int verbose, f2p_wm_t *wm)
 {
     if (verbose) {
         printf("start test_lshift\n");
     }
     int ok = 1;
-    mpz_t *x = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
 
     f2p_set_binstr(*x, "101");
     f2p_lshift(*x, 2);
@@ -153,17 +156,18 @@ int test_lshift(int verbose, int wp, f2p_wm_t *wm)
         printf("x");
     }
 
+    f2p_wm_release(wm, mark);
     return ok;
 }
 
-int test_rshift(int verbose, int wp, f2p_wm_t *wm)
+int test_rshift(int verbose, f2p_wm_t *wm)
 {
     if (verbose) {
         printf("start test_rshift\n");
     }
     int ok = 1;
-    mpz_t *x = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
 
     f2p_set_binstr(*x, "1011");
     f2p_rshift(*x, 2);
@@ -195,17 +199,18 @@ int test_rshift(int verbose, int wp, f2p_wm_t *wm)
     } else {
         printf("x");
     }
+    f2p_wm_release(wm, mark);
     return ok;
 }
 
-int test_coefficient(int verbose, int wp, f2p_wm_t *wm)
+int test_coefficient(int verbose, f2p_wm_t *wm)
 {
     if (verbose) {
         printf("start test_coefficient\n");
     }
     int ok = 1;
-    mpz_t *x = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
 
     f2p_set_binstr(*x, "1011");
     int c = f2p_coefficient(*x, 0);
@@ -236,23 +241,24 @@ int test_coefficient(int verbose, int wp, f2p_wm_t *wm)
     } else {
         printf("x");
     }
+    f2p_wm_release(wm, mark);
     return ok;
 }
 
-int test_mod(int verbose, int wp, f2p_wm_t *wm)
+int test_mod(int verbose, f2p_wm_t *wm)
 {
     if (verbose) {
         printf("start test_mod\n");
     }
     int ok = 1;
-    mpz_t *x = &(wm->ar[wp++]);
-    mpz_t *y = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_t *y = f2p_wm_alloc(wm);
     char buff[200];
 
     f2p_set_binstr(*x, "1011");
     f2p_set_binstr(*y, "11");
-    f2p_mod(*x, *y, wp, wm);
+    f2p_mod(*x, *y, wm);
     f2p_get_binstr(buff, *x);
     if (strcmp(buff, "1") != 0) {
         printf("test_mod failure 1 expected 1 returns %s\n", buff);
@@ -260,7 +266,7 @@ int test_mod(int verbose, int wp, f2p_wm_t *wm)
     }
     f2p_set_binstr(*x, "11");
     f2p_set_binstr(*y, "1011");
-    f2p_mod(*x, *y, wp, wm);
+    f2p_mod(*x, *y, wm);
     f2p_get_binstr(buff, *x);
     if (strcmp(buff, "11") != 0) {
         printf("test_mod failure 2 expected 11 returns %s\n", buff);
@@ -274,25 +280,26 @@ int test_mod(int verbose, int wp, f2p_wm_t *wm)
     } else {
         printf("x");
     }
+    f2p_wm_release(wm, mark);
     return ok;
 }
 
-int test_divrem(int verbose, int wp, f2p_wm_t *wm)
+int test_divrem(int verbose, f2p_wm_t *wm)
 {
     if (verbose) {
         printf("start test_divrem\n");
     }
     int ok = 1;
-    mpz_t *x = &(wm->ar[wp++]);
-    mpz_t *y = &(wm->ar[wp++]);
-    mpz_t *q = &(wm->ar[wp++]);
-    mpz_t *rem = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_t *y = f2p_wm_alloc(wm);
+    mpz_t *q = f2p_wm_alloc(wm);
+    mpz_t *rem = f2p_wm_alloc(wm);
     char buff[200];
 
     f2p_set_binstr(*x, "1011");
     f2p_set_binstr(*y, "11");
-    f2p_divrem(*q, *rem, *x, *y, wp, wm);
+    f2p_divrem(*q, *rem, *x, *y, wm);
     f2p_get_binstr(buff, *q);
     if (strcmp(buff, "110") != 0) {
         printf("test_divrem failure 1 expected 110 returns %s\n", buff);
@@ -315,7 +322,7 @@ int test_divrem(int verbose, int wp, f2p_wm_t *wm)
     }
     f2p_set_binstr(*x, "11");
     f2p_set_binstr(*y, "1011");
-    f2p_divrem(*q, *rem, *x, *y, wp, wm);
+    f2p_divrem(*q, *rem, *x, *y, wm);
     f2p_get_binstr(buff, *q);
     if (strcmp(buff, "0") != 0) {
         printf("test_divrem failure 3 expected 0 returns %s\n", buff);
@@ -328,7 +335,7 @@ int test_divrem(int verbose, int wp, f2p_wm_t *wm)
     }
     f2p_set_binstr(*x, "1101");
     f2p_set_binstr(*y, "1011");
-    f2p_divrem(*q, *rem, *x, *y, wp, wm);
+    f2p_divrem(*q, *rem, *x, *y, wm);
     f2p_get_binstr(buff, *q);
     if (strcmp(buff, "1") != 0) {
         printf("test_divrem failure 5 expected 0 returns %s\n", buff);
@@ -342,7 +349,7 @@ int test_divrem(int verbose, int wp, f2p_wm_t *wm)
     }
     f2p_set_binstr(*x, "1011");
     f2p_set_binstr(*y, "11");
-    f2p_divrem(*x, *y, *x, *y, wp, wm);
+    f2p_divrem(*x, *y, *x, *y, wm);
     f2p_get_binstr(buff, *x);
     if (strcmp(buff, "110") != 0) {
         printf("test_divrem failure 7 expected 0 returns %s\n", buff);
@@ -355,7 +362,7 @@ int test_divrem(int verbose, int wp, f2p_wm_t *wm)
     }
     f2p_set_binstr(*x, "1011");
     f2p_set_binstr(*y, "11");
-    f2p_divrem(*y, *x, *x, *y, wp, wm);
+    f2p_divrem(*y, *x, *x, *y, wm);
     f2p_get_binstr(buff, *y);
     if (strcmp(buff, "110") != 0) {
         printf("test_divrem failure 9 expected 0 returns %s\n", buff);
@@ -369,7 +376,7 @@ int test_divrem(int verbose, int wp, f2p_wm_t *wm)
 
     f2p_set_binstr(*x, "1011");
     f2p_set_binstr(*y, "1");
-    f2p_divrem(*q, *rem, *x, *y, wp, wm);
+    f2p_divrem(*q, *rem, *x, *y, wm);
     f2p_get_binstr(buff, *q);
     if (strcmp(buff, "1011") != 0) {
         printf("test_divrem failure 11 expected 1011 returns %s\n", buff);
@@ -383,7 +390,7 @@ int test_divrem(int verbose, int wp, f2p_wm_t *wm)
 
     f2p_set_binstr(*x, "1110110");
     f2p_set_binstr(*y, "1001");
-    f2p_divrem(*q, *rem, *x, *y, wp, wm);
+    f2p_divrem(*q, *rem, *x, *y, wm);
     f2p_get_binstr(buff, *q);
     if (strcmp(buff, "1111") != 0) {
         printf("test_divrem failure 13 expected 1111 returns %s\n", buff);
@@ -403,26 +410,27 @@ int test_divrem(int verbose, int wp, f2p_wm_t *wm)
     } else {
         printf("x");
     }
+    f2p_wm_release(wm, mark);
     return ok;
 }
 
-int test_mulmod(int verbose, int wp, f2p_wm_t *wm)
+int test_mulmod(int verbose, f2p_wm_t *wm)
 {
     if (verbose) {
         printf("start test_mulmod\n");
     }
     int ok = 1;
-    mpz_t *x = &(wm->ar[wp++]);
-    mpz_t *y = &(wm->ar[wp++]);
-    mpz_t *mod = &(wm->ar[wp++]);
-    mpz_t *rem = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_t *y = f2p_wm_alloc(wm);
+    mpz_t *mod = f2p_wm_alloc(wm);
+    mpz_t *rem = f2p_wm_alloc(wm);
     char buff[200];
 
     f2p_set_binstr(*x, "101");
     f2p_set_binstr(*y, "11");
     f2p_set_binstr(*mod, "10");
-    f2p_mulmod(*rem, *x, *y, *mod, wp, wm);
+    f2p_mulmod(*rem, *x, *y, *mod, wm);
     f2p_get_binstr(buff, *rem);
     if (strcmp(buff, "1") != 0) {
         printf("test_mulmod failure 1 expected 1 returns %s\n", buff);
@@ -447,7 +455,7 @@ int test_mulmod(int verbose, int wp, f2p_wm_t *wm)
     f2p_set_binstr(*x, "11");
     f2p_set_binstr(*y, "1011");
     f2p_set_binstr(*mod, "101");
-    f2p_mulmod(*x, *x, *y, *mod, wp, wm);
+    f2p_mulmod(*x, *x, *y, *mod, wm);
     f2p_get_binstr(buff, *x);
     if (strcmp(buff, "11") != 0) {
         printf("test_mulmod failure 5 expected 11 returns %s\n", buff);
@@ -466,18 +474,110 @@ int test_mulmod(int verbose, int wp, f2p_wm_t *wm)
     } else {
         printf("x");
     }
+    f2p_wm_release(wm, mark);
     return ok;
 }
 
-int test_square_aux(int verbose, char * a, char *b, int wp, f2p_wm_t * wm)
+/*
+ * r = a * b by shift and add
+ */
+static void naive_mul(mpz_t r, mpz_t a, mpz_t b, f2p_wm_t *wm)
+{
+    int mark = f2p_wm_mark(wm);
+    mpz_t *v = f2p_wm_alloc(wm);
+    mpz_set(*v, a);
+    mpz_set_ui(r, 0);
+    for (size_t i = 0; mpz_cmp_ui(b, 0) != 0 && i <= f2p_degree(b); i++) {
+        if (f2p_coefficient(b, i)) {
+            f2p_add(r, r, *v);
+        }
+        f2p_lshift(*v, 1);
+    }
+    f2p_wm_release(wm, mark);
+}
+
+int test_addmul(int verbose, f2p_wm_t *wm)
+{
+    if (verbose) {
+        printf("start test_addmul\n");
+    }
+    int ok = 1;
+    int mark = f2p_wm_mark(wm);
+    mpz_t *a = f2p_wm_alloc(wm);
+    mpz_t *b = f2p_wm_alloc(wm);
+    mpz_t *r = f2p_wm_alloc(wm);
+    mpz_t *mod = f2p_wm_alloc(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_t *y = f2p_wm_alloc(wm);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 5489);
+    for (int i = 0; i < 50; i++) {
+        mpz_urandomb(*a, rs, 10 + 7 * i);
+        mpz_urandomb(*b, rs, 300 - 5 * i);
+        mpz_urandomb(*r, rs, 200);
+        mpz_urandomb(*mod, rs, 40 + 6 * i);
+        mpz_setbit(*mod, 40 + 6 * i);
+        // r ^= a * b
+        naive_mul(*x, *a, *b, wm);
+        f2p_add(*x, *x, *r);
+        f2p_addmul(*r, *a, *b);
+        if (mpz_cmp(*r, *x) != 0) {
+            printf("test_addmul failure addmul i = %d\n", i);
+            ok = 0;
+        }
+        f2p_mul(*r, *a, *b, wm);
+        naive_mul(*x, *a, *b, wm);
+        if (mpz_cmp(*r, *x) != 0) {
+            printf("test_addmul failure mul i = %d\n", i);
+            ok = 0;
+        }
+        // expected (a * b) % mod
+        f2p_mod(*x, *mod, wm);
+        mpz_set(*r, *a);
+        f2p_mulmod_inplace(*r, *b, *mod, wm);
+        if (mpz_cmp(*r, *x) != 0) {
+            printf("test_addmul failure mulmod_inplace i = %d\n", i);
+            ok = 0;
+        }
+        mpz_set(*r, *b);
+        f2p_mulmod(*r, *a, *r, *mod, wm);
+        if (mpz_cmp(*r, *x) != 0) {
+            printf("test_addmul failure mulmod alias i = %d\n", i);
+            ok = 0;
+        }
+        // expected (a * a) % mod
+        naive_mul(*y, *a, *a, wm);
+        f2p_mod(*y, *mod, wm);
+        mpz_set(*r, *a);
+        f2p_mulmod(*r, *r, *r, *mod, wm);
+        if (mpz_cmp(*r, *y) != 0) {
+            printf("test_addmul failure mulmod square i = %d\n", i);
+            ok = 0;
+        }
+    }
+    gmp_randclear(rs);
+    f2p_wm_release(wm, mark);
+    if (verbose) {
+        printf("end test_addmul\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_square_aux(int verbose, char * a, char *b, f2p_wm_t *wm)
 {
     int ok = 1;
-    mpz_t *x = &(wm->ar[wp++]);
-    mpz_t *y = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_t *y = f2p_wm_alloc(wm);
     char buff[200];
     f2p_set_binstr(*x, a);
-    f2p_square(*y, *x, wp, wm);
+    f2p_square(*y, *x, wm);
     f2p_get_binstr(buff, *y);
     if (strcmp(buff, b) != 0) {
         ok = 0;
@@ -486,20 +586,21 @@ int test_square_aux(int verbose, char * a, char *b, int wp, f2p_wm_t * wm)
         printf("test_square a = %s, result = %s, expected = %s\n",
                a, buff, b);
     }
+    f2p_wm_release(wm, mark);
     return ok;
 }
 
-int test_square(int verbose, int wp, f2p_wm_t *wm)
+int test_square(int verbose, f2p_wm_t *wm)
 {
     if (verbose) {
         printf("start test_square\n");
     }
     int ok = 1;
-    ok *= test_square_aux(verbose, "0", "0", wp, wm);
-    ok *= test_square_aux(verbose, "1", "1", wp, wm);
-    ok *= test_square_aux(verbose, "11", "101", wp, wm);
-    ok *= test_square_aux(verbose, "101", "10001", wp, wm);
-    ok *= test_square_aux(verbose, "111", "10101", wp, wm);
+    ok *= test_square_aux(verbose, "0", "0", wm);
+    ok *= test_square_aux(verbose, "1", "1", wm);
+    ok *= test_square_aux(verbose, "11", "101", wm);
+    ok *= test_square_aux(verbose, "101", "10001", wm);
+    ok *= test_square_aux(verbose, "111", "10101", wm);
     if (verbose) {
         printf("end test_square\n");
     }
@@ -507,19 +608,19 @@ int test_square(int verbose, int wp, f2p_wm_t *wm)
 }
 
 int test_powermod_aux(int verbose, char *astr, int eint, char *modstr,
-                      char *res, int wp, f2p_wm_t *wm)
+                      char *res, f2p_wm_t *wm)
 {
     int ok = 1;
-    mpz_t *a = &(wm->ar[wp++]);
-    mpz_t *e = &(wm->ar[wp++]);
-    mpz_t *mod = &(wm->ar[wp++]);
-    mpz_t *r = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *a = f2p_wm_alloc(wm);
+    mpz_t *e = f2p_wm_alloc(wm);
+    mpz_t *mod = f2p_wm_alloc(wm);
+    mpz_t *r = f2p_wm_alloc(wm);
     char buff[200];
     f2p_set_binstr(*a, astr);
     mpz_set_ui(*e, eint);
     f2p_set_binstr(*mod, modstr);
-    f2p_powermod(*r, *a, *e, *mod, wp, wm);
+    f2p_powermod(*r, *a, *e, *mod, wm);
     f2p_get_binstr(buff, *r);
     if (strcmp(buff, res) != 0) {
         ok = 0;
@@ -528,18 +629,19 @@ int test_powermod_aux(int verbose, char *astr, int eint, char *modstr,
         printf("%s: a = %s, e = %d, mod = %s, result = %s, expected = %s\n",
                "test_powermod", astr, eint, modstr, buff, res);
     }
+    f2p_wm_release(wm, mark);
     return ok;
 }
 
-int test_powermod(int verbose, int wp, f2p_wm_t *wm)
+int test_powermod(int verbose, f2p_wm_t *wm)
 {
     if (verbose) {
         printf("start test_powermod\n");
     }
     int ok = 1;
-    ok *= test_powermod_aux(verbose, "11", 2, "111", "10", wp, wm);
-    ok *= test_powermod_aux(verbose, "11", 3, "111", "1", wp, wm);
-    ok *= test_powermod_aux(verbose, "11", 5, "111", "10", wp, wm);
+    ok *= test_powermod_aux(verbose, "11", 2, "111", "10", wm);
+    ok *= test_powermod_aux(verbose, "11", 3, "111", "1", wm);
+    ok *= test_powermod_aux(verbose, "11", 5, "111", "10", wm);
     if (verbose) {
         printf("end test_powermod\n");
     }
@@ -552,34 +654,131 @@ int test_powermod(int verbose, int wp, f2p_wm_t *wm)
 }
 
 int test_gcd_aux(const char * binx, const char * biny, const char * bingcd,
-                 int verbose, int wp, f2p_wm_t *wm)
+                 int verbose, f2p_wm_t *wm)
 {
     static char buff[2000];
-    mpz_t *x = &(wm->ar[wp++]);
-    mpz_t *y = &(wm->ar[wp++]);
-    mpz_t *expected = &(wm->ar[wp++]);
-    mpz_t *gcd = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    int mark = f2p_wm_mark(wm);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_t *y = f2p_wm_alloc(wm);
+    mpz_t *expected = f2p_wm_alloc(wm);
+    mpz_t *gcd = f2p_wm_alloc(wm);
     f2p_set_binstr(*x, binx);
     f2p_set_binstr(*y, biny);
     f2p_set_binstr(*expected, bingcd);
-    f2p_gcd(*gcd, *x, *y, wp, wm);
+    f2p_gcd(*gcd, *x, *y, wm);
     int r = mpz_cmp(*gcd, *expected);
     if (r != 0 && verbose) {
         f2p_get_binstr(buff, *gcd);
         printf("gcd(%s, %s) expected = %s, returns %s\n", binx, biny, bingcd,
                 buff);
         fflush(stdout);
+        f2p_wm_release(wm, mark);
         return 0;
     } else {
+        f2p_wm_release(wm, mark);
         return 1;
     }
 }
 
-int test_gcd(int verbose, int wp, f2p_wm_t *wm)
+int test_gcd(int verbose, f2p_wm_t *wm)
+{
+    int ok = 1;
+    ok *= test_gcd_aux("10", "1", "1", verbose, wm);
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_wm(int verbose)
 {
+    if (verbose) {
+        printf("start test_wm\n");
+    }
     int ok = 1;
-    ok *= test_gcd_aux("10", "1", "1", verbose, wp, wm);
+    f2p_wm_t wm;
+    f2p_wm_init2(&wm, 2, 256);
+    int mark = f2p_wm_mark(&wm);
+    mpz_t *first = f2p_wm_alloc(&wm);
+    mpz_set_ui(*first, 12345);
+    mpz_t *slot[40];
+    for (int i = 0; i < 40; i++) {
+        slot[i] = f2p_wm_alloc(&wm);
+        mpz_set_ui(*slot[i], (unsigned long)i);
+    }
+    if (mpz_cmp_ui(*first, 12345) != 0) {
+        printf("test_wm failure first slot changed\n");
+        ok = 0;
+    }
+    for (int i = 0; i < 40; i++) {
+        if (mpz_cmp_ui(*slot[i], (unsigned long)i) != 0) {
+            printf("test_wm failure slot %d changed\n", i);
+            ok = 0;
+        }
+    }
+    if (wm.high_water != 41 || wm.max_size < 41) {
+        printf("test_wm failure high_water = %d max_size = %d\n",
+               wm.high_water, wm.max_size);
+        ok = 0;
+    }
+    f2p_wm_release(&wm, mark);
+    if (f2p_wm_alloc(&wm) != first) {
+        printf("test_wm failure release\n");
+        ok = 0;
+    }
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_wm\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_wm_thread_local(int verbose)
+{
+    if (verbose) {
+        printf("start test_wm_thread_local\n");
+    }
+    int ok = 1;
+    mpz_t poly;
+    mpz_init(poly);
+    // t^521 + t^32 + 1, larger than the fast path of degree 127 or less
+    mpz_setbit(poly, 521);
+    mpz_setbit(poly, 32);
+    mpz_setbit(poly, 0);
+    f2p_wm_t *wm = f2p_wm_thread_local();
+    if (f2p_is_irreducible(poly) != 1) {
+        printf("test_wm_thread_local failure irreducible\n");
+        ok = 0;
+    }
+    if (wm->high_water <= 0) {
+        printf("test_wm_thread_local failure not used\n");
+        ok = 0;
+    }
+    int max_size = wm->max_size;
+    for (int i = 0; i < 10; i++) {
+        f2p_is_irreducible(poly);
+        if (f2p_wm_thread_local() != wm) {
+            printf("test_wm_thread_local failure thread local changed\n");
+            ok = 0;
+        }
+    }
+    if (wm->top != 0 || wm->max_size != max_size) {
+        printf("test_wm_thread_local failure top = %d max_size = %d\n",
+               wm->top, wm->max_size);
+        ok = 0;
+    }
+    f2p_wm_thread_cleanup();
+    mpz_clear(poly);
+    if (verbose) {
+        printf("end test_wm_thread_local\n");
+    }
     if (ok) {
         printf("o");
     } else {
@@ -595,23 +794,25 @@ int main(int argc, char * argv[])
     if (argc > 1 && argv[1][0] == 'v') {
         verbose = 1;
     }
-    int wp = 0;
     f2p_wm_t wm;
 
     f2p_wm_init(&wm, 20);
 
-    ok *= test_string(verbose, wp, &wm);
-    ok *= test_degree(verbose, wp, &wm);
-    ok *= test_add(verbose, wp, &wm);
-    ok *= test_lshift(verbose, wp, &wm);
-    ok *= test_rshift(verbose, wp, &wm);
-    ok *= test_coefficient(verbose, wp, &wm);
-    ok *= test_mod(verbose, wp, &wm);
-    ok *= test_divrem(verbose, wp, &wm);
-    ok *= test_mulmod(verbose, wp, &wm);
-    ok *= test_square(verbose, wp, &wm);
-    ok *= test_powermod(verbose, wp, &wm);
-    ok *= test_gcd(verbose, wp, &wm);
+    ok *= test_string(verbose, &wm);
+    ok *= test_degree(verbose, &wm);
+    ok *= test_add(verbose, &wm);
+    ok *= test_lshift(verbose, &wm);
+    ok *= test_rshift(verbose, &wm);
+    ok *= test_coefficient(verbose, &wm);
+    ok *= test_mod(verbose, &wm);
+    ok *= test_divrem(verbose, &wm);
+    ok *= test_mulmod(verbose, &wm);
+    ok *= test_addmul(verbose, &wm);
+    ok *= test_square(verbose, &wm);
+    ok *= test_powermod(verbose, &wm);
+    ok *= test_gcd(verbose, &wm);
+    ok *= test_wm(verbose);
+    ok *= test_wm_thread_local(verbose);
     printf("\n");
     f2p_wm_clear(&wm);
 
@@ -0,0 +1,210 @@
+/**
+ * @file test_f2p_cpp.cpp
+ *
+ * @brief test program for f2p_gmp.hpp
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_gmp.hpp"
+#include <stdio.h>
+#include <utility>
+
+using namespace f2p;
+
+static unsigned long alloc_count = 0;
+static void *(*prev_alloc)(size_t);
+static void *(*prev_realloc)(void *, size_t, size_t);
+static void (*prev_free)(void *, size_t);
+
+static void * count_alloc(size_t size)
+{
+    alloc_count++;
+    return prev_alloc(size);
+}
+
+static void * count_realloc(void *ptr, size_t old_size, size_t new_size)
+{
+    alloc_count++;
+    return prev_realloc(ptr, old_size, new_size);
+}
+
+static int check(const char *name, bool ok)
+{
+    if (!ok) {
+        printf("%s failed\n", name);
+    }
+    return ok ? 1 : 0;
+}
+
+int test_move(int verbose)
+{
+    if (verbose) {
+        printf("start test_move\n");
+    }
+    int ok = 1;
+    Poly a = Poly::from_hex("123456789abcdef0123456789abcdef");
+    const mp_limb_t *limbs = mpz_limbs_read(a.mp());
+    Poly b(std::move(a));
+    ok &= check("move construct", mpz_limbs_read(b.mp()) == limbs);
+    Poly c;
+    c = std::move(b);
+    ok &= check("move assign", mpz_limbs_read(c.mp()) == limbs);
+    ok &= check("value", c.to_hex() == "123456789abcdef0123456789abcdef");
+    Poly d = c.clone();
+    ok &= check("clone", d == c && mpz_limbs_read(d.mp()) != limbs);
+    ok &= check("bin", Poly::from_bin("1011").to_bin() == "1011");
+    ok &= check("degree", d.degree() == 120 && Poly().degree() == -1);
+    if (verbose) {
+        printf("end test_move\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_expr(int verbose)
+{
+    if (verbose) {
+        printf("start test_expr\n");
+    }
+    int ok = 1;
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 1234);
+    mpz_t za, zq, zb, zr;
+    mpz_inits(za, zq, zb, zr, NULL);
+    for (int i = 0; i < 20; i++) {
+        mpz_urandomb(za, rs, 300);
+        mpz_urandomb(zq, rs, 100 + static_cast<mp_bitcnt_t>(i) * 10);
+        mpz_urandomb(zb, rs, 200);
+        Poly a(za);
+        Poly q(zq);
+        Poly b(zb);
+        // expected a + q * b
+        f2p_mul(zr, zq, zb, &wm);
+        f2p_add(zr, zr, za);
+        Poly expected(zr);
+        Poly r = a + q * b;
+        ok &= check("a + q * b", r == expected);
+        r = q * b + a;
+        ok &= check("q * b + a", r == expected);
+        Poly a2 = a.clone();
+        a2 = a2 + q * b;
+        ok &= check("a = a + q * b", a2 == expected);
+        a2 = a.clone();
+        a2 += q * b;
+        ok &= check("a += q * b", a2 == expected);
+        // aliasing
+        Poly b2 = b.clone();
+        b2 = a + q * b2;
+        ok &= check("b = a + q * b", b2 == expected);
+        Poly q2 = q.clone();
+        q2 = q2 * q2;
+        f2p_square(zr, zq, &wm);
+        ok &= check("q = q * q", q2 == Poly(zr));
+        r = (a + b) * q;
+        f2p_add(zr, za, zb);
+        f2p_mul(zr, zr, zq, &wm);
+        ok &= check("(a + b) * q", r == Poly(zr));
+        r = a + b + q;
+        f2p_add(zr, za, zb);
+        f2p_add(zr, zr, zq);
+        ok &= check("a + b + q", r == Poly(zr));
+        // divrem and mod
+        Poly qq;
+        Poly rr;
+        divrem(qq, rr, a, b);
+        ok &= check("divrem", a == qq * b + rr);
+        ok &= check("mod", a % b == rr && a / b == qq);
+    }
+    // fused update does not allocate when capacity is enough
+    Poly a = Poly::from_hex("1");
+    a <<= 1000;
+    a = a >> 1000;
+    Poly q = Poly::from_hex("123456789abcdef");
+    Poly b = Poly::from_hex("fedcba9876543210fedcba9876543210");
+    mp_get_memory_functions(&prev_alloc, &prev_realloc, &prev_free);
+    mp_set_memory_functions(count_alloc, count_realloc, prev_free);
+    alloc_count = 0;
+    for (int i = 0; i < 10; i++) {
+        a = a + q * b;
+    }
+    mp_set_memory_functions(prev_alloc, prev_realloc, prev_free);
+    ok &= check("no allocation", alloc_count == 0);
+    ok &= check("twice cancel", a == Poly(1));
+    mpz_clears(za, zq, zb, zr, NULL);
+    gmp_randclear(rs);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_expr\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_functions(int verbose)
+{
+    if (verbose) {
+        printf("start test_functions\n");
+    }
+    int ok = 1;
+    Poly x = Poly::from_bin("1101011");
+    Poly y = Poly::from_bin("10011");
+    Poly a;
+    Poly b;
+    Poly c;
+    exeuclid(a, b, c, x, y);
+    ok &= check("exeuclid", a * x + b * y == c && c == gcd(x, y));
+    Poly m = Poly::from_hex("d8524022ed8dff4a8dcc50c798faba43");
+    ok &= check("irreducible", is_irreducible(m));
+    mpz_t e;
+    mpz_init_set_ui(e, 1000);
+    Poly j = calc_jump(m, e);
+    ok &= check("jump", j == powermod(Poly(2), e, m));
+    ok &= check("mulmod", mulmod(j, x, m) == (j * x) % m);
+    mpz_clear(e);
+    if (verbose) {
+        printf("end test_functions\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_move(verbose);
+    ok *= test_expr(verbose);
+    ok *= test_functions(verbose);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -1,23 +1,22 @@
 #include "f2p_gmp.h"
 #include <string.h>
 
-int test_exeuclid(int verbose, int wp, f2p_wm_t *wm)
+int test_exeuclid(int verbose, f2p_wm_t *wm)
 {
     if (verbose) {
         printf("start test_euclid\n");
     }
     int ok = 1;
-    mpz_t *x = &(wm->ar[wp++]);
-    mpz_t *y = &(wm->ar[wp++]);
-    mpz_t *a = &(wm->ar[wp++]);
-    mpz_t *b = &(wm->ar[wp++]);
-    mpz_t *c = &(wm->ar[wp++]);
-    assert(wp <= wm->max_size);
+    mpz_t *x = f2p_wm_alloc(wm);
+    mpz_t *y = f2p_wm_alloc(wm);
+    mpz_t *a = f2p_wm_alloc(wm);
+    mpz_t *b = f2p_wm_alloc(wm);
+    mpz_t *c = f2p_wm_alloc(wm);
     char buff[200];
 
     f2p_set_binstr(*x, "110");
     f2p_set_binstr(*y, "1");
-    f2p_exeuclid(*a, *b, *c, *x, *y, wp, wm);
+    f2p_exeuclid(*a, *b, *c, *x, *y, wm);
     f2p_get_binstr(buff, *c);
     if (strcmp(buff, "1") != 0) {
         printf("failure 0.1 expected 1 returns %s\n", buff);
@@ -26,7 +25,7 @@ int test_exeuclid(int verbose, int wp, f2p_wm_t *wm)
 
     f2p_set_binstr(*x, "110");
     f2p_set_binstr(*y, "111");
-    f2p_exeuclid(*a, *b, *c, *x, *y, wp, wm);
+    f2p_exeuclid(*a, *b, *c, *x, *y, wm);
     f2p_get_binstr(buff, *x);
     if (strcmp(buff, "110") != 0) {
         printf("failure 1 expected 110 returns %s\n", buff);
@@ -55,7 +54,7 @@ int test_exeuclid(int verbose, int wp, f2p_wm_t *wm)
 
     f2p_set_binstr(*x, "1101");
     f2p_set_binstr(*y, "11111");
-    f2p_exeuclid(*a, *b, *c, *x, *y, wp, wm);
+    f2p_exeuclid(*a, *b, *c, *x, *y, wm);
     f2p_get_binstr(buff, *a);
     if (strcmp(buff, "1100") != 0) {
         printf("failure 6 expected 1100 returns %s\n", buff);
@@ -87,12 +86,11 @@ int main(int argc, char * argv[])
     if (argc > 1 && argv[1][0] == 'v') {
         verbose = 1;
     }
-    int wp = 0;
     f2p_wm_t wm;
 
     f2p_wm_init(&wm, 30);
 
-    ok *= test_exeuclid(verbose, wp, &wm);
+    ok *= test_exeuclid(verbose, &wm);
     printf("\n");
     f2p_wm_clear(&wm);
 
@@ -0,0 +1,159 @@
+/**
+ * @file test_fixed.cpp
+ *
+ * @brief test program for f2p_fixed.hpp
+ *
+ * results are compared with functions of f2p_gmp.c.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_fixed.hpp"
+#include "f2p_gmp.h"
+#include <stdio.h>
+
+using namespace f2p;
+
+struct TinyMTMod {
+    static constexpr int degree = 127;
+    static F2P_CONSTEXPR F2Poly<128> poly() {
+        return F2Poly<128>::from_hex("d8524022ed8dff4a8dcc50c798faba43");
+    }
+};
+
+struct Mod521 {
+    static constexpr int degree = 521;
+    static F2P_CONSTEXPR F2Poly<522> poly() {
+        return F2Poly<522>::monomial(521) + F2Poly<522>::monomial(32)
+            + F2Poly<522>(1);
+    }
+};
+
+#if __cplusplus >= 201703L
+// evaluated at compile time
+static_assert(F2Poly<70>::from_hex("3").degree() == 1, "degree");
+static_assert((F2Poly<70>(1) << 69).degree() == 69, "lshift");
+static_assert((F2Poly<70>(1) << 70).is_zero(), "lshift overflow");
+static_assert(mul(F2Poly<2>(3), F2Poly<2>(3)) == F2Poly<3>(5), "mul");
+static_assert(F2PolyMod<TinyMTMod>::x().pow(1) == F2PolyMod<TinyMTMod>::x(),
+              "pow");
+#endif
+
+template<int Bits>
+static int same(const char *name, const F2Poly<Bits>& p, mpz_t z)
+{
+    mpz_t x;
+    mpz_init(x);
+    p.get_mpz(x);
+    int ok = mpz_cmp(x, z) == 0;
+    if (!ok) {
+        printf("%s differs\n", name);
+    }
+    mpz_clear(x);
+    return ok;
+}
+
+template<typename Modulus>
+static int test_fixed_mod(gmp_randstate_t rs, int verbose)
+{
+    typedef F2PolyMod<Modulus> mod_t;
+    typedef typename mod_t::poly_type poly_t;
+    int ok = 1;
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    mpz_t a, b, m, r, e;
+    mpz_inits(a, b, m, r, e, NULL);
+    mod_t::modulus().get_mpz(m);
+    if (verbose) {
+        printf("degree %d\n", mod_t::degree);
+    }
+    for (int i = 0; i < 10 && ok; i++) {
+        mpz_urandomb(a, rs, mod_t::degree);
+        mpz_urandomb(b, rs, mod_t::degree);
+        mpz_urandomb(e, rs, 200);
+        poly_t pa = poly_t::from_mpz(a);
+        poly_t pb = poly_t::from_mpz(b);
+        f2p_add(r, a, b);
+        ok &= same("add", pa + pb, r);
+        f2p_mul(r, a, b, &wm);
+        ok &= same("mul", mul(pa, pb), r);
+        f2p_square(r, a, &wm);
+        ok &= same("square", square(pa), r);
+        mpz_mul_2exp(r, a, 5);
+        f2p_mod(r, m, &wm);
+        ok &= same("mod", mod(pa, mod_t::modulus()).template
+                   resize<mod_t::degree>(), a);
+        ok &= same("mod shift", mod_t::reduce(mul(pa, F2Poly<6>(32))).value,
+                   r);
+        f2p_mulmod(r, a, b, m, &wm);
+        ok &= same("mulmod", (mod_t(pa) * mod_t(pb)).value, r);
+        f2p_powermod(r, a, e, m, &wm);
+        ok &= same("powermod", mod_t(pa).pow(e).value, r);
+        mpz_set_ui(e, 123456789);
+        f2p_powermod(r, a, e, m, &wm);
+        ok &= same("powermod ui", mod_t(pa).pow(123456789).value, r);
+    }
+    // jump polynomial x^(2^100)
+    mpz_set_ui(e, 1);
+    mpz_mul_2exp(e, e, 100);
+    f2p_calc_jump(r, m, e);
+    ok &= same("calc_jump", mod_t::x().pow(e).value, r);
+    mpz_clears(a, b, m, r, e, NULL);
+    f2p_wm_clear(&wm);
+    return ok;
+}
+
+int test_fixed(int verbose)
+{
+    if (verbose) {
+        printf("start test_fixed\n");
+    }
+    int ok = 1;
+    // shifts across word boundary
+    F2Poly<130> p = F2Poly<130>::from_hex("3ffffffffffffffffffffffffffffffff");
+    ok &= p.degree() == 129;
+    ok &= (p >> 65).degree() == 64;
+    ok &= (p << 1).degree() == 129;
+    ok &= (p << 1).coefficient(0) == 0;
+    if (!ok) {
+        printf("shift failed\n");
+    }
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 1234);
+    ok &= test_fixed_mod<TinyMTMod>(rs, verbose);
+    ok &= test_fixed_mod<Mod521>(rs, verbose);
+    gmp_randclear(rs);
+    if (verbose) {
+        printf("end test_fixed\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_fixed(verbose);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
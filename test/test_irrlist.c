@@ -0,0 +1,232 @@
+/**
+ * @file test_irrlist.c
+ *
+ * @brief test program for f2p_irrlist.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "f2p_irrlist.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1000.0
+        + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+int test_count(int verbose)
+{
+    if (verbose) {
+        printf("start test_count\n");
+    }
+    int ok = 1;
+    // sum_{d | n} d * count(d) = 2^n
+    mpz_t count;
+    mpz_t sum;
+    mpz_t x;
+    mpz_inits(count, sum, x, NULL);
+    for (int n = 1; n <= 100; n++) {
+        mpz_set_ui(sum, 0);
+        for (int d = 1; d <= n; d++) {
+            if (n % d == 0) {
+                f2p_irreducible_count(count, d);
+                mpz_addmul_ui(sum, count, (unsigned long)d);
+            }
+        }
+        mpz_set_ui(x, 0);
+        mpz_setbit(x, (mp_bitcnt_t)n);
+        if (mpz_cmp(sum, x) != 0) {
+            printf("test_count failure n = %d\n", n);
+            ok = 0;
+        }
+    }
+    f2p_irreducible_count(count, 32);
+    if (mpz_cmp_ui(count, 134215680UL) != 0) {
+        printf("test_count failure n = 32\n");
+        ok = 0;
+    }
+    mpz_clears(count, sum, x, NULL);
+    if (verbose) {
+        printf("end test_count\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_irrlist(int verbose)
+{
+    if (verbose) {
+        printf("start test_irrlist\n");
+    }
+    int ok = 1;
+    setenv("F2P_NUM_THREADS", "4", 1);
+    f2p_irrlist_t list;
+    f2p_irrlist_init(&list, 18, 0);
+    f2p_irrlist_t single;
+    f2p_irrlist_init(&single, 18, 1);
+    long total = list.offset[18] + list.count[18];
+    if (list.count[18] != 14532 || total != single.offset[18]
+        + single.count[18] || memcmp(list.poly, single.poly,
+                                     total * sizeof(uint32_t)) != 0) {
+        printf("test_irrlist failure multi thread\n");
+        ok = 0;
+    }
+    mpz_t f;
+    mpz_init(f);
+    // all polynomials of degree 1 to 12
+    for (uint64_t i = 2; i < 1 << 13; i++) {
+        mpz_set_ui(f, (unsigned long)i);
+        int expected = f2p_is_irreducible(f);
+        if ((f2p_irrlist_index(&list, i) >= 0) != expected) {
+            printf("test_irrlist failure %lx\n", (unsigned long)i);
+            ok = 0;
+        }
+    }
+    // every 97th polynomial of degree 18
+    for (long i = 0; i < list.count[18]; i += 97) {
+        uint64_t g = f2p_irrlist_get(&list, 18, i);
+        mpz_set_ui(f, (unsigned long)g);
+        if (!f2p_is_irreducible(f)
+            || f2p_irrlist_index(&list, g) != list.offset[18] + i) {
+            printf("test_irrlist failure degree 18 %lx\n", (unsigned long)g);
+            ok = 0;
+        }
+        if (i > 0 && g <= f2p_irrlist_get(&list, 18, i - 1)) {
+            printf("test_irrlist failure order\n");
+            ok = 0;
+        }
+    }
+    mpz_clear(f);
+    FILE *fp = tmpfile();
+    f2p_irrlist_t read;
+    if (fp == NULL || f2p_irrlist_write(fp, &list) != 0) {
+        printf("test_irrlist failure write\n");
+        ok = 0;
+    } else {
+        rewind(fp);
+        if (f2p_irrlist_read(fp, &read) != 0) {
+            printf("test_irrlist failure read\n");
+            ok = 0;
+        } else {
+            if (read.max_degree != 18
+                || memcmp(read.count, list.count, sizeof(list.count)) != 0
+                || memcmp(read.offset, list.offset, sizeof(list.offset)) != 0
+                || memcmp(read.poly, list.poly, total * sizeof(uint32_t))
+                != 0) {
+                printf("test_irrlist failure read data\n");
+                ok = 0;
+            }
+            f2p_irrlist_clear(&read);
+        }
+        // broken file
+        rewind(fp);
+        fputc('x', fp);
+        rewind(fp);
+        if (f2p_irrlist_read(fp, &read) == 0) {
+            printf("test_irrlist failure broken file\n");
+            f2p_irrlist_clear(&read);
+            ok = 0;
+        }
+        // count of degree 18 plus 1, and one more polynomial
+        long tail = total * (long)sizeof(uint32_t) + 4;
+        rewind(fp);
+        if (f2p_irrlist_write(fp, &list) != 0
+            || fwrite("\0\0\0\0", 1, 4, fp) != 4
+            || fseek(fp, -(tail + 16), SEEK_END) != 0) {
+            printf("test_irrlist failure write\n");
+            ok = 0;
+        } else {
+            uint64_t count = (uint64_t)list.count[18] + 1;
+            for (int i = 0; i < 8; i++) {
+                fputc((int)((count >> (8 * i)) & 0xff), fp);
+            }
+            rewind(fp);
+            if (f2p_irrlist_read(fp, &read) == 0) {
+                printf("test_irrlist failure wrong count\n");
+                f2p_irrlist_clear(&read);
+                ok = 0;
+            }
+        }
+    }
+    if (fp != NULL) {
+        fclose(fp);
+    }
+    f2p_irrlist_clear(&single);
+    f2p_irrlist_clear(&list);
+    if (verbose) {
+        printf("end test_irrlist\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+/**
+ * speed of enumeration, verbose mode only
+ */
+void speed_irrlist(int degree)
+{
+    struct timespec t0;
+    struct timespec t1;
+    struct timespec t2;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    f2p_irrlist_t list;
+    f2p_irrlist_init(&list, degree, 0);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    mpz_t f;
+    mpz_init(f);
+    long found = 0;
+    for (uint64_t i = (uint64_t)1 << (degree - 4);
+         i < (uint64_t)1 << (degree - 3); i++) {
+        mpz_set_ui(f, (unsigned long)i);
+        found += f2p_is_irreducible(f);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+    printf("degree <= %d: %ld polynomials %.2fms, f2p_is_irreducible on"
+           " degree %d: %ld polynomials %.2fms\n", degree,
+           list.offset[degree] + list.count[degree], elapsed(&t0, &t1),
+           degree - 4, found, elapsed(&t1, &t2));
+    mpz_clear(f);
+    f2p_irrlist_clear(&list);
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_count(verbose);
+    ok *= test_irrlist(verbose);
+    printf("\n");
+    if (verbose) {
+        speed_irrlist(24);
+    }
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
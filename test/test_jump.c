@@ -0,0 +1,329 @@
+/**
+ * @file test_jump.c
+ *
+ * @brief test program for f2p_jump.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#define LINEARITY_CHECK
+#include "tinymt32_jump.h"
+#include "f2p_gmp.h"
+#include <stdlib.h>
+
+static void tiny_init(tinymt32_t *tiny32, uint32_t seed)
+{
+    tiny32->mat1 = 0x8f7011ee;
+    tiny32->mat2 = 0xfc78ff1f;
+    tiny32->tmat = 0x3793fdff;
+    tinymt32_init(tiny32, seed);
+}
+
+static void tiny_minpoly(mpz_t minpoly, tinymt32_t *tiny32)
+{
+    tinymt32_t work = *tiny32;
+    int mexp = tinymt32_get_mexp(&work);
+    mpz_t seq;
+    mpz_init(seq);
+    for (int i = 0; i < 2 * mexp; i++) {
+        if (tinymt32_generate_uint32(&work) & 1) {
+            mpz_setbit(seq, i);
+        }
+    }
+    f2p_minpoly(minpoly, seq, mexp);
+    mpz_clear(seq);
+}
+
+/**
+ * compare outputs of two generators
+ */
+static int same_output(tinymt32_t *a, tinymt32_t *b)
+{
+    for (int i = 0; i < 10; i++) {
+        if (tinymt32_generate_uint32(a) != tinymt32_generate_uint32(b)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int test_jump_apply(int verbose, unsigned long step, int window)
+{
+    if (verbose) {
+        printf("start test_jump_apply step = %lu window = %d\n",
+               step, window);
+    }
+    tinymt32_t tiny32;
+    tinymt32_t jumped;
+    mpz_t minpoly;
+    mpz_t jump;
+    mpz_t mstep;
+    mpz_inits(minpoly, jump, mstep, NULL);
+    tiny_init(&tiny32, 1234);
+    tiny_minpoly(minpoly, &tiny32);
+    mpz_set_ui(mstep, step);
+    f2p_calc_jump(jump, minpoly, mstep);
+    jumped = tiny32;
+    f2p_jump_apply(&jumped, &tinymt32_state_ops, jump, window);
+    for (unsigned long i = 0; i < step; i++) {
+        tinymt32_next_state(&tiny32);
+    }
+    int ok = same_output(&tiny32, &jumped);
+    mpz_clears(minpoly, jump, mstep, NULL);
+    if (!ok) {
+        printf("test_jump_apply failure step = %lu window = %d\n",
+               step, window);
+    }
+    if (verbose) {
+        printf("end test_jump_apply\n");
+    }
+    return ok;
+}
+
+int test_jump_window(int verbose)
+{
+    if (verbose) {
+        printf("start test_jump_window\n");
+    }
+    int ok = 1;
+    tinymt32_t tiny32;
+    tinymt32_t jumped;
+    tinymt32_t expected;
+    mpz_t minpoly;
+    mpz_t jump;
+    mpz_t mstep;
+    mpz_inits(minpoly, jump, mstep, NULL);
+    tiny_init(&tiny32, 4321);
+    tiny_minpoly(minpoly, &tiny32);
+    f2p_jump_window_t win;
+    f2p_jump_window_init(&win, &tinymt32_state_ops, &tiny32, 0);
+    for (unsigned long step = 100; step < 1000; step += 300) {
+        mpz_set_ui(mstep, step);
+        f2p_calc_jump(jump, minpoly, mstep);
+        f2p_jump_window_apply(&jumped, &win, jump);
+        expected = tiny32;
+        for (unsigned long i = 0; i < step; i++) {
+            tinymt32_next_state(&expected);
+        }
+        if (!same_output(&expected, &jumped)) {
+            printf("test_jump_window failure step = %lu\n", step);
+            ok = 0;
+        }
+    }
+    f2p_jump_window_clear(&win);
+    mpz_clears(minpoly, jump, mstep, NULL);
+    if (verbose) {
+        printf("end test_jump_window\n");
+    }
+    return ok;
+}
+
+int test_jump_table(int verbose)
+{
+    if (verbose) {
+        printf("start test_jump_table\n");
+    }
+    int ok = 1;
+    tinymt32_t tiny32;
+    mpz_t minpoly;
+    mpz_t stride;
+    mpz_t step;
+    mpz_t total;
+    mpz_t expected;
+    mpz_t jump;
+    mpz_inits(minpoly, stride, step, total, expected, jump, NULL);
+    tiny_init(&tiny32, 1);
+    tiny_minpoly(minpoly, &tiny32);
+    unsigned long strides[] = {1, 1000};
+    unsigned long steps[] = {0, 1, 5, 1023, 1024, 123456789};
+    for (int i = 0; i < 2; i++) {
+        f2p_jump_table_t table;
+        mpz_set_ui(stride, strides[i]);
+        f2p_jump_table_init(&table, minpoly, stride, 20);
+        for (int j = 0; j < 6; j++) {
+            mpz_set_ui(step, steps[j]);
+            mpz_mul(total, stride, step);
+            f2p_calc_jump(expected, minpoly, total);
+            f2p_jump_table_calc(jump, &table, step);
+            if (mpz_cmp(jump, expected) != 0) {
+                printf("test_jump_table failure stride = %lu step = %lu\n",
+                       strides[i], steps[j]);
+                ok = 0;
+            }
+        }
+        FILE *fp = tmpfile();
+        f2p_jump_table_t read;
+        if (fp == NULL || f2p_jump_table_write(fp, &table) != 0) {
+            printf("test_jump_table failure write\n");
+            ok = 0;
+        } else {
+            rewind(fp);
+            if (f2p_jump_table_read(fp, &read) != 0) {
+                printf("test_jump_table failure read\n");
+                ok = 0;
+            } else {
+                for (int j = 0; j < table.size; j++) {
+                    if (mpz_cmp(read.table[j], table.table[j]) != 0) {
+                        printf("test_jump_table failure entry %d\n", j);
+                        ok = 0;
+                    }
+                }
+                if (read.size != table.size
+                    || mpz_cmp(read.minpoly, table.minpoly) != 0
+                    || mpz_cmp(read.stride, table.stride) != 0) {
+                    printf("test_jump_table failure header\n");
+                    ok = 0;
+                }
+                f2p_jump_table_clear(&read);
+            }
+        }
+        if (fp != NULL) {
+            fclose(fp);
+        }
+        f2p_jump_table_clear(&table);
+    }
+    // corrupt header, size larger than needed by the stride
+    FILE *fp = tmpfile();
+    if (fp != NULL) {
+        f2p_jump_table_t read;
+        fprintf(fp, "f2p_jump_table 1\n2000000000\n3\n3e8\n");
+        rewind(fp);
+        if (f2p_jump_table_read(fp, &read) == 0) {
+            printf("test_jump_table failure corrupt size\n");
+            f2p_jump_table_clear(&read);
+            ok = 0;
+        }
+        fclose(fp);
+    }
+    mpz_clears(minpoly, stride, step, total, expected, jump, NULL);
+    if (verbose) {
+        printf("end test_jump_table\n");
+    }
+    return ok;
+}
+
+int test_jump_series(int verbose, int num_threads)
+{
+    if (verbose) {
+        printf("start test_jump_series\n");
+    }
+    int ok = 1;
+    int n = 50;
+    tinymt32_t tiny32;
+    mpz_t minpoly;
+    mpz_t step;
+    mpz_t total;
+    mpz_t expected;
+    mpz_t out[50];
+    mpz_inits(minpoly, step, total, expected, NULL);
+    for (int i = 0; i < n; i++) {
+        mpz_init(out[i]);
+    }
+    tiny_init(&tiny32, 1);
+    tiny_minpoly(minpoly, &tiny32);
+    mpz_set_ui(step, 1000003);
+    f2p_calc_jump_series(out, minpoly, step, n, num_threads);
+    for (int i = 0; i < n; i++) {
+        mpz_mul_ui(total, step, (unsigned long)(i + 1));
+        f2p_calc_jump(expected, minpoly, total);
+        if (mpz_cmp(out[i], expected) != 0) {
+            printf("test_jump_series failure i = %d threads = %d\n",
+                   i, num_threads);
+            ok = 0;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        mpz_clear(out[i]);
+    }
+    mpz_clears(minpoly, step, total, expected, NULL);
+    if (verbose) {
+        printf("end test_jump_series\n");
+    }
+    return ok;
+}
+
+int test_jump_streams(int verbose, int num_threads)
+{
+    if (verbose) {
+        printf("start test_jump_streams\n");
+    }
+    int ok = 1;
+    int n = 20;
+    unsigned long stride = 1000;
+    tinymt32_t tiny32;
+    tinymt32_t expected;
+    tinymt32_t streams[20];
+    mpz_t minpoly;
+    mpz_t mstride;
+    mpz_inits(minpoly, mstride, NULL);
+    tiny_init(&tiny32, 5);
+    tiny_minpoly(minpoly, &tiny32);
+    mpz_set_ui(mstride, stride);
+    tinymt32_jump_streams(streams, &tiny32, minpoly, mstride, n, num_threads);
+    expected = tiny32;
+    for (int i = 0; i < n; i++) {
+        tinymt32_t work = expected;
+        if (!same_output(&work, &streams[i])) {
+            printf("test_jump_streams failure i = %d threads = %d\n",
+                   i, num_threads);
+            ok = 0;
+        }
+        for (unsigned long j = 0; j < stride; j++) {
+            tinymt32_next_state(&expected);
+        }
+    }
+    mpz_clears(minpoly, mstride, NULL);
+    if (verbose) {
+        printf("end test_jump_streams\n");
+    }
+    return ok;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    unsigned long steps[] = {1, 2, 127, 128, 1000, 12345};
+    int windows[] = {1, 3, 0};
+    for (int i = 0; i < 6; i++) {
+        for (int j = 0; j < 3; j++) {
+            int r = test_jump_apply(verbose, steps[i], windows[j]);
+            printf("%c", r ? 'o' : 'x');
+            ok *= r;
+        }
+    }
+    int r = test_jump_window(verbose);
+    printf("%c", r ? 'o' : 'x');
+    ok *= r;
+    r = test_jump_table(verbose);
+    printf("%c", r ? 'o' : 'x');
+    ok *= r;
+    r = test_jump_series(verbose, 1);
+    printf("%c", r ? 'o' : 'x');
+    ok *= r;
+    r = test_jump_series(verbose, 4);
+    printf("%c", r ? 'o' : 'x');
+    ok *= r;
+    r = test_jump_streams(verbose, 1);
+    printf("%c", r ? 'o' : 'x');
+    ok *= r;
+    r = test_jump_streams(verbose, 3);
+    printf("%c", r ? 'o' : 'x');
+    ok *= r;
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
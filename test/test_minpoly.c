@@ -132,7 +132,7 @@ int test_irreducible(int verbose)
 
 #if 0
 void f2p_exeuclid3(mpz_t a, mpz_t b, mpz_t c, mpz_t x, mpz_t y, int m,
-                   int wp, f2p_wm_t *wm)
+                   f2p_wm_t *wm)
 {
     PUTS("f2p_exeuclid3 start\n");
     //mp_bitcnt_t max_deg = m;
@@ -140,19 +140,18 @@ void f2p_exeuclid3(mpz_t a, mpz_t b, mpz_t c, mpz_t x, mpz_t y, int m,
     assert(zcmp != 0);
     zcmp = mpz_cmp_ui(y, 0);
     assert(zcmp != 0);
-    mpz_t *q1 = &(wm->ar[wp++]);
-    mpz_t *r0 = &(wm->ar[wp++]);
-    mpz_t *r1 = &(wm->ar[wp++]);
-    mpz_t *r2 = &(wm->ar[wp++]);
-    mpz_t *a0 = &(wm->ar[wp++]);
-    mpz_t *a1 = &(wm->ar[wp++]);
-    mpz_t *a2 = &(wm->ar[wp++]);
-    mpz_t *b0 = &(wm->ar[wp++]);
-    mpz_t *b1 = &(wm->ar[wp++]);
-    mpz_t *b2 = &(wm->ar[wp++]);
-    mpz_t *tmp = &(wm->ar[wp++]);
+    mpz_t *q1 = f2p_wm_alloc(wm);
+    mpz_t *r0 = f2p_wm_alloc(wm);
+    mpz_t *r1 = f2p_wm_alloc(wm);
+    mpz_t *r2 = f2p_wm_alloc(wm);
+    mpz_t *a0 = f2p_wm_alloc(wm);
+    mpz_t *a1 = f2p_wm_alloc(wm);
+    mpz_t *a2 = f2p_wm_alloc(wm);
+    mpz_t *b0 = f2p_wm_alloc(wm);
+    mpz_t *b1 = f2p_wm_alloc(wm);
+    mpz_t *b2 = f2p_wm_alloc(wm);
+    mpz_t *tmp = f2p_wm_alloc(wm);
     //mpz_t *t; 後で使う
-    assert(wp <= wm->max_size);
     PRT("x= ", x);
     PRT("y= ", y);
     mpz_set(*r0, x);
@@ -172,13 +171,13 @@ void f2p_exeuclid3(mpz_t a, mpz_t b, mpz_t c, mpz_t x, mpz_t y, int m,
     for (;;) {
         //while (mpz_cmp_ui(*r1, 0) > 0) {
         PUTS("f2p_divrem\n");
-        f2p_divrem(*q1, *r2, *r0, *r1, wp, wm); // 2 wm
+        f2p_divrem(*q1, *r2, *r0, *r1, wm); // 2 wm
         PUTS("f2p_mul\n");
-        f2p_mul(*tmp, *q1, *a1, wp, wm); // 2 wm
+        f2p_mul(*tmp, *q1, *a1, wm); // 2 wm
         PUTS("f2p_add\n");
         f2p_add(*a2, *a0, *tmp);
         PUTS("f2p_mul\n");
-        f2p_mul(*tmp, *q1, *b1, wp, wm);// 2 wm
+        f2p_mul(*tmp, *q1, *b1, wm);// 2 wm
         PUTS("f2p_add\n");
         f2p_add(*b2, *b0, *tmp);
         PRT("q1 = ", *q1);
@@ -225,16 +224,15 @@ void test_f2p_minpoly2(f2rng gen, int mexp)
 {
     PUTS("minpoly start\n");
     f2p_wm_t wm;
-    int wp = 0;
     f2p_wm_init(&wm, 25);
-    mpz_t *poly = &(wm.ar[wp++]);
-    mpz_t *seq = &(wm.ar[wp++]);
-    mpz_t *b = &(wm.ar[wp++]);
-    mpz_t *c = &(wm.ar[wp++]);
-    mpz_t *x2t = &(wm.ar[wp++]);
-    mpz_t *r1 = &(wm.ar[wp++]);
-    mpz_t *r2 = &(wm.ar[wp++]);
-    //mpz_t *r3 = &(wm.ar[wp++]);
+    mpz_t *poly = f2p_wm_alloc(&wm);
+    mpz_t *seq = f2p_wm_alloc(&wm);
+    mpz_t *b = f2p_wm_alloc(&wm);
+    mpz_t *c = f2p_wm_alloc(&wm);
+    mpz_t *x2t = f2p_wm_alloc(&wm);
+    mpz_t *r1 = f2p_wm_alloc(&wm);
+    mpz_t *r2 = f2p_wm_alloc(&wm);
+    //mpz_t *r3 = f2p_wm_alloc(&wm);
     mpz_setbit(*x2t, 2 * mexp);
     //mpz_setbit(*x2t, 0);
 //    for (int i = 0; i < 2 * mexp; i++) {
@@ -247,15 +245,15 @@ void test_f2p_minpoly2(f2rng gen, int mexp)
         }
     }
     PRT("seq = ", *seq);
-    //f2p_exeuclid2(*poly, *b, *c, *seq, *x2t, mexp, wp, &wm); // 13 wm
-    f2p_exeuclid3(*poly, *b, *c, *seq, *x2t, mexp, wp, &wm); // 13 wm
+    //f2p_exeuclid2(*poly, *b, *c, *seq, *x2t, mexp, &wm); // 13 wm
+    f2p_exeuclid3(*poly, *b, *c, *seq, *x2t, mexp, &wm); // 13 wm
     PRT("poly = ", *poly);
     //PRT("b = ", *b);
     PRT("c = ", *c);
     PRT("seq = ", *seq);
     PRT("x2t = ", *x2t);
-    f2p_mul(*r1, *poly, *seq, wp, &wm);
-    f2p_mul(*r2, *b, *x2t, wp, &wm);
+    f2p_mul(*r1, *poly, *seq, &wm);
+    f2p_mul(*r2, *b, *x2t, &wm);
     f2p_add(*r1, *r1, *r2);
     int cmp = mpz_cmp(*r1, *c);
     if (cmp == 0) {
@@ -0,0 +1,205 @@
+/**
+ * @file test_mul.c
+ *
+ * @brief test program for Karatsuba and parallel multiplication of
+ * f2p_mul
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "f2p_gmp.h"
+#include "f2p_thread.h"
+#include "tinymt32.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static void random_poly(mpz_t r, int bits, tinymt32_t *tiny)
+{
+    int size = (bits + 31) / 32;
+    uint32_t *w = malloc(sizeof(uint32_t) * size);
+    for (int i = 0; i < size; i++) {
+        w[i] = tinymt32_generate_uint32(tiny);
+    }
+    mpz_import(r, size, -1, sizeof(uint32_t), 0, 0, w);
+    free(w);
+    mpz_setbit(r, bits - 1);
+}
+
+static double elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1000.0
+        + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+int test_mul(int verbose)
+{
+    if (verbose) {
+        printf("start test_mul\n");
+    }
+    int ok = 1;
+    int bits = mp_bits_per_limb;
+    // around the thresholds, unbalanced and large operands
+    int sizes[][2] = {
+        {F2P_KARATSUBA_THRESHOLD - 1, F2P_KARATSUBA_THRESHOLD},
+        {F2P_KARATSUBA_THRESHOLD, F2P_KARATSUBA_THRESHOLD},
+        {F2P_KARATSUBA_THRESHOLD * 2 + 1, F2P_KARATSUBA_THRESHOLD * 2 + 1},
+        {F2P_KARATSUBA_THRESHOLD * 5 + 3, F2P_KARATSUBA_THRESHOLD},
+        {1000, 333},
+        {F2P_MUL_PARALLEL_THRESHOLD, F2P_MUL_PARALLEL_THRESHOLD},
+        {F2P_MUL_PARALLEL_THRESHOLD * 3 + 7, F2P_MUL_PARALLEL_THRESHOLD + 1},
+        {5000, 4999}
+    };
+    int num = sizeof(sizes) / sizeof(sizes[0]);
+    tinymt32_t tiny;
+    tinymt32_init(&tiny, 1234);
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    mpz_t a;
+    mpz_t b;
+    mpz_t r;
+    mpz_t expected;
+    mpz_init(a);
+    mpz_init(b);
+    mpz_init(r);
+    mpz_init(expected);
+    for (int i = 0; i < num; i++) {
+        random_poly(a, sizes[i][0] * bits - i, &tiny);
+        random_poly(b, sizes[i][1] * bits - 3, &tiny);
+        struct timespec t0;
+        struct timespec t1;
+        struct timespec t2;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        mpz_set_ui(expected, 0);
+        f2p_addmul(expected, a, b);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        f2p_mul(r, a, b, &wm);
+        clock_gettime(CLOCK_MONOTONIC, &t2);
+        if (verbose) {
+            printf("degree %d * %d: basecase %.2fms, f2p_mul %.2fms\n",
+                   (int)f2p_degree(a), (int)f2p_degree(b),
+                   elapsed(&t0, &t1), elapsed(&t1, &t2));
+        }
+        if (mpz_cmp(r, expected) != 0) {
+            printf("test_mul failure i = %d\n", i);
+            ok = 0;
+        }
+        // aliased operands
+        mpz_set(r, b);
+        f2p_mul(r, a, r, &wm);
+        if (mpz_cmp(r, expected) != 0) {
+            printf("test_mul alias failure i = %d\n", i);
+            ok = 0;
+        }
+        f2p_mul(r, a, a, &wm);
+        f2p_square(expected, a, &wm);
+        if (mpz_cmp(r, expected) != 0) {
+            printf("test_mul square failure i = %d\n", i);
+            ok = 0;
+        }
+    }
+    mpz_clear(a);
+    mpz_clear(b);
+    mpz_clear(r);
+    mpz_clear(expected);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_mul\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_mulmod_parallel(int verbose)
+{
+    if (verbose) {
+        printf("start test_mulmod_parallel\n");
+    }
+    int ok = 1;
+    // residues of F2P_MUL_PARALLEL_THRESHOLD limbs or more
+    int degree = 110503;
+    tinymt32_t tiny;
+    tinymt32_init(&tiny, 4321);
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    mpz_t mod;
+    mpz_t x;
+    mpz_t e;
+    mpz_t r;
+    mpz_t expected;
+    mpz_inits(mod, x, e, r, expected, NULL);
+    random_poly(mod, degree + 1, &tiny);
+    random_poly(x, degree, &tiny);
+    mpz_set_ui(e, 3);
+    long tasks = f2p_executor_tasks();
+    struct timespec t0;
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    f2p_powermod(r, x, e, mod, &wm);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    tasks = f2p_executor_tasks() - tasks;
+    if (verbose) {
+        printf("powermod of degree %d: %.2fms, %ld tasks\n", degree,
+               elapsed(&t0, &t1), tasks);
+    }
+    // x^3 by the basecase
+    mpz_set_ui(expected, 0);
+    f2p_addmul(expected, x, x);
+    f2p_mod(expected, mod, &wm);
+    mpz_set(e, expected);
+    mpz_set_ui(expected, 0);
+    f2p_addmul(expected, e, x);
+    f2p_mod(expected, mod, &wm);
+    if (mpz_cmp(r, expected) != 0) {
+        printf("test_mulmod_parallel failure\n");
+        ok = 0;
+    }
+    if (tasks == 0) {
+        printf("test_mulmod_parallel not parallel\n");
+        ok = 0;
+    }
+    mpz_clears(mod, x, e, r, expected, NULL);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_mulmod_parallel\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    // parallel multiplication even on a single core machine
+    setenv("F2P_NUM_THREADS", "4", 1);
+    ok *= test_mul(verbose);
+    ok *= test_mulmod_parallel(verbose);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -0,0 +1,180 @@
+/**
+ * @file test_multimod.c
+ *
+ * @brief test program for f2p_multimod.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "f2p_multimod.h"
+#include "tinymt32.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static void random_poly(mpz_t r, int degree, tinymt32_t *tiny)
+{
+    int size = degree / 32 + 1;
+    uint32_t *w = malloc(sizeof(uint32_t) * size);
+    for (int i = 0; i < size; i++) {
+        w[i] = tinymt32_generate_uint32(tiny);
+    }
+    mpz_import(r, size, -1, sizeof(uint32_t), 0, 0, w);
+    free(w);
+    mpz_tdiv_r_2exp(r, r, degree);
+    mpz_setbit(r, degree);
+}
+
+static double elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1000.0
+        + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+int test_reciprocal(int verbose)
+{
+    if (verbose) {
+        printf("start test_reciprocal\n");
+    }
+    int ok = 1;
+    tinymt32_t tiny;
+    tinymt32_init(&tiny, 4321);
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    mpz_t mod;
+    mpz_t inv;
+    mpz_t rev;
+    mpz_t x;
+    mpz_inits(mod, inv, rev, x, NULL);
+    int degrees[] = {1, 63, 64, 3000, 10000};
+    int precs[] = {1, 2, 100, 2049, 9000};
+    for (int i = 0; i < 5; i++) {
+        random_poly(mod, degrees[i], &tiny);
+        f2p_reciprocal(inv, mod, precs[i], &wm);
+        mpz_set_ui(rev, 0);
+        for (int j = 0; j <= degrees[i]; j++) {
+            if (mpz_tstbit(mod, j)) {
+                mpz_setbit(rev, degrees[i] - j);
+            }
+        }
+        f2p_mul(x, rev, inv, &wm);
+        mpz_tdiv_r_2exp(x, x, precs[i]);
+        if (mpz_cmp_ui(x, 1) != 0) {
+            printf("test_reciprocal failure i = %d\n", i);
+            ok = 0;
+        }
+    }
+    mpz_clears(mod, inv, rev, x, NULL);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_reciprocal\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+static int check_multimod(int count, int maxdeg, int adeg,
+                          tinymt32_t *tiny, int verbose)
+{
+    int ok = 1;
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    mpz_t *mods = malloc(count * sizeof(mpz_t));
+    mpz_t *r = malloc(count * sizeof(mpz_t));
+    mpz_t a;
+    mpz_t x;
+    mpz_init(a);
+    mpz_init(x);
+    for (int i = 0; i < count; i++) {
+        mpz_init(mods[i]);
+        mpz_init(r[i]);
+        random_poly(mods[i], tinymt32_generate_uint32(tiny) % maxdeg, tiny);
+    }
+    random_poly(a, adeg, tiny);
+    struct timespec t0;
+    struct timespec t1;
+    struct timespec t2;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    f2p_multimod(r, a, mods, count);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    for (int i = 0; i < count; i++) {
+        mpz_set(x, a);
+        f2p_mod(x, mods[i], &wm);
+        if (mpz_cmp(x, r[i]) != 0) {
+            printf("check_multimod failure count = %d i = %d\n", count, i);
+            ok = 0;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+    if (verbose) {
+        printf("%d moduli of degree < %d, degree %d: multimod %.2fms,"
+               " f2p_mod %.2fms\n", count, maxdeg, adeg,
+               elapsed(&t0, &t1), elapsed(&t1, &t2));
+    }
+    for (int i = 0; i < count; i++) {
+        mpz_clear(mods[i]);
+        mpz_clear(r[i]);
+    }
+    free(mods);
+    free(r);
+    mpz_clear(a);
+    mpz_clear(x);
+    f2p_wm_clear(&wm);
+    return ok;
+}
+
+int test_multimod(int verbose)
+{
+    if (verbose) {
+        printf("start test_multimod\n");
+    }
+    int ok = 1;
+    tinymt32_t tiny;
+    tinymt32_init(&tiny, 1234);
+    ok &= check_multimod(1, 100, 50, &tiny, verbose);
+    ok &= check_multimod(1, 5000, 20000, &tiny, verbose);
+    ok &= check_multimod(7, 30, 1000, &tiny, verbose);
+    ok &= check_multimod(100, 200, 5000, &tiny, verbose);
+    ok &= check_multimod(33, 6000, 50000, &tiny, verbose);
+    ok &= check_multimod(64, 2000, 30000, &tiny, verbose);
+    if (verbose) {
+        printf("end test_multimod\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_reciprocal(verbose);
+    ok *= test_multimod(verbose);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -0,0 +1,268 @@
+/**
+ * @file test_poly.c
+ *
+ * @brief test program for f2p_poly.c
+ *
+ * results are compared with functions of f2p_gmp.c.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#define LINEARITY_CHECK
+#include "tinymt32.h"
+#include "f2p_poly.h"
+#include <stdio.h>
+
+static int same(const char *name, f2p_poly_t *p, mpz_t z)
+{
+    mpz_t view;
+    if (mpz_cmp(f2p_poly_mpz_view(view, p), z) != 0) {
+        printf("%s differs\n", name);
+        return 0;
+    }
+    int deg = mpz_sgn(z) == 0 ? -1 : (int)f2p_degree(z);
+    if (f2p_poly_degree(p) != deg) {
+        printf("%s degree %d != %d\n", name, f2p_poly_degree(p), deg);
+        return 0;
+    }
+    return 1;
+}
+
+int test_poly_arith(int verbose)
+{
+    if (verbose) {
+        printf("start test_poly_arith\n");
+    }
+    int ok = 1;
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 1234);
+    mpz_t a, b, m, r, q, e;
+    mpz_inits(a, b, m, r, q, e, NULL);
+    f2p_poly_t pa, pb, pm, pr, pq;
+    f2p_poly_init(&pr);
+    f2p_poly_init(&pq);
+    int sizes[] = {1, 7, 63, 64, 65, 127, 200, 521};
+    int num = sizeof(sizes) / sizeof(int);
+    for (int i = 0; i < num && ok; i++) {
+        for (int j = 0; j < num && ok; j++) {
+            mpz_urandomb(a, rs, (mp_bitcnt_t)sizes[i]);
+            mpz_urandomb(b, rs, (mp_bitcnt_t)sizes[j]);
+            mpz_setbit(b, (mp_bitcnt_t)sizes[j]);
+            mpz_urandomb(m, rs, (mp_bitcnt_t)sizes[j]);
+            mpz_setbit(m, (mp_bitcnt_t)sizes[j]);
+            mpz_urandomb(e, rs, 100);
+            f2p_poly_view_mpz(&pa, a);
+            f2p_poly_view_mpz(&pb, b);
+            f2p_poly_view_mpz(&pm, m);
+            f2p_add(r, a, b);
+            f2p_poly_add(&pr, &pa, &pb);
+            ok &= same("add", &pr, r);
+            f2p_mul(r, a, b, &wm);
+            f2p_poly_mul(&pr, &pa, &pb, &wm);
+            ok &= same("mul", &pr, r);
+            f2p_square(r, a, &wm);
+            f2p_poly_square(&pr, &pa, &wm);
+            ok &= same("square", &pr, r);
+            f2p_divrem(q, r, a, b, &wm);
+            f2p_poly_divrem(&pq, &pr, &pa, &pb, &wm);
+            ok &= same("divrem q", &pq, q);
+            ok &= same("divrem r", &pr, r);
+            mpz_set(r, a);
+            f2p_mod(r, b, &wm);
+            f2p_poly_set(&pr, &pa);
+            f2p_poly_mod(&pr, &pb, &wm);
+            ok &= same("mod", &pr, r);
+            f2p_mulmod(r, a, b, m, &wm);
+            f2p_poly_mulmod(&pr, &pa, &pb, &pm, &wm);
+            ok &= same("mulmod", &pr, r);
+            f2p_pow2mod(r, a, m, &wm);
+            f2p_poly_pow2mod(&pr, &pa, &pm, &wm);
+            ok &= same("pow2mod", &pr, r);
+            f2p_powermod(r, a, e, m, &wm);
+            f2p_poly_powermod(&pr, &pa, e, &pm, &wm);
+            ok &= same("powermod", &pr, r);
+            if (mpz_sgn(a) != 0) {
+                f2p_gcd(r, a, b, &wm);
+                f2p_poly_gcd(&pr, &pa, &pb, &wm);
+                ok &= same("gcd", &pr, r);
+            }
+            mpz_mul_2exp(r, a, (mp_bitcnt_t)sizes[j]);
+            f2p_poly_lshift(&pr, &pa, sizes[j]);
+            ok &= same("lshift", &pr, r);
+            mpz_fdiv_q_2exp(r, r, (mp_bitcnt_t)sizes[i]);
+            f2p_poly_rshift(&pr, &pr, sizes[i]);
+            ok &= same("rshift", &pr, r);
+            // a, b, c of exeuclid
+            if (mpz_sgn(a) != 0) {
+                f2p_poly_t px, py, pc;
+                mpz_t x, y, c;
+                f2p_poly_init(&px);
+                f2p_poly_init(&py);
+                f2p_poly_init(&pc);
+                mpz_inits(x, y, c, NULL);
+                f2p_poly_exeuclid(&px, &py, &pc, &pa, &pm, &wm);
+                f2p_poly_get_mpz(x, &px);
+                f2p_poly_get_mpz(y, &py);
+                f2p_poly_get_mpz(c, &pc);
+                f2p_mul(x, x, a, &wm);
+                f2p_mul(y, y, m, &wm);
+                f2p_add(x, x, y);
+                ok &= same("exeuclid", &pc, x);
+                f2p_gcd(r, a, m, &wm);
+                ok &= same("exeuclid gcd", &pc, r);
+                f2p_poly_clear(&px);
+                f2p_poly_clear(&py);
+                f2p_poly_clear(&pc);
+                mpz_clears(x, y, c, NULL);
+            }
+        }
+    }
+    if (wm.top != 0) {
+        printf("wm is not released top = %d\n", wm.top);
+        ok = 0;
+    }
+    f2p_poly_clear(&pr);
+    f2p_poly_clear(&pq);
+    mpz_clears(a, b, m, r, q, e, NULL);
+    gmp_randclear(rs);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_poly_arith\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_poly_minpoly(int verbose)
+{
+    if (verbose) {
+        printf("start test_poly_minpoly\n");
+    }
+    int ok = 1;
+    int mexp = 127;
+    tinymt32_t tiny32;
+    tiny32.mat1 = 0x8f7011ee;
+    tiny32.mat2 = 0xfc78ff1f;
+    tiny32.tmat = 0x3793fdff;
+    tinymt32_init(&tiny32, 1);
+    mpz_t seq, poly, step, jump;
+    mpz_inits(seq, poly, step, jump, NULL);
+    f2p_poly_t pseq, ppoly, pjump;
+    f2p_poly_init(&pseq);
+    f2p_poly_init(&ppoly);
+    f2p_poly_init(&pjump);
+    for (int i = 0; i < mexp * 2; i++) {
+        if (tinymt32_generate_uint32(&tiny32) & 1) {
+            mpz_setbit(seq, (mp_bitcnt_t)i);
+            f2p_poly_setbit(&pseq, i);
+        }
+    }
+    f2p_minpoly(poly, seq, mexp);
+    f2p_poly_minpoly(&ppoly, &pseq, mexp);
+    ok &= same("minpoly", &ppoly, poly);
+    if (f2p_poly_is_irreducible(&ppoly) != 1) {
+        printf("minpoly is not irreducible\n");
+        ok = 0;
+    }
+    mpz_set_ui(step, 1);
+    mpz_mul_2exp(step, step, 100);
+    f2p_calc_jump(jump, poly, step);
+    f2p_poly_calc_jump(&pjump, &ppoly, step);
+    ok &= same("calc_jump", &pjump, jump);
+    // irreducible polynomials of degree 16
+    int pcount = 0;
+    for (unsigned long i = 0; i < (1UL << 15); i++) {
+        mpz_set_ui(poly, 2 * i + 1);
+        mpz_setbit(poly, 16);
+        f2p_poly_t p;
+        f2p_poly_view_mpz(&p, poly);
+        pcount += f2p_poly_is_irreducible(&p);
+    }
+    // (2^16 - 2^8) / 16
+    if (pcount != 4080) {
+        printf("irreducible count = %d\n", pcount);
+        ok = 0;
+    }
+    f2p_poly_clear(&pseq);
+    f2p_poly_clear(&ppoly);
+    f2p_poly_clear(&pjump);
+    mpz_clears(seq, poly, step, jump, NULL);
+    if (verbose) {
+        printf("end test_poly_minpoly\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_poly_view(int verbose)
+{
+    if (verbose) {
+        printf("start test_poly_view\n");
+    }
+    int ok = 1;
+    mpz_t z, copy;
+    mpz_inits(z, copy, NULL);
+    f2p_set_hexstr(z, "123456789abcdef0123456789");
+    mpz_set(copy, z);
+    f2p_poly_t view;
+    f2p_poly_view_mpz(&view, z);
+    if (view.limb != mpz_limbs_read(z)) {
+        printf("view is copied\n");
+        ok = 0;
+    }
+    // modification of view does not change z
+    f2p_poly_setbit(&view, 200);
+    if (mpz_cmp(z, copy) != 0) {
+        printf("view modified original\n");
+        ok = 0;
+    }
+    mpz_setbit(copy, 200);
+    ok &= same("setbit", &view, copy);
+    f2p_poly_clear(&view);
+    mpz_clears(z, copy, NULL);
+    if (verbose) {
+        printf("end test_poly_view\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_poly_arith(verbose);
+    ok *= test_poly_minpoly(verbose);
+    ok *= test_poly_view(verbose);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -0,0 +1,163 @@
+/**
+ * @file test_precomp.c
+ *
+ * @brief test program for f2p_precomp.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_precomp.h"
+#include <stdio.h>
+#include <time.h>
+
+int test_precomp_aux(int verbose, int degree, gmp_randstate_t rs,
+                     f2p_wm_t *wm)
+{
+    int ok = 1;
+    mpz_t mod, a, b, r, expected;
+    mpz_inits(mod, a, b, r, expected, NULL);
+    mpz_urandomb(mod, rs, degree);
+    mpz_setbit(mod, degree);
+    f2p_modctx_t ctx;
+    f2p_modctx_init(&ctx, mod);
+    for (int i = 0; i < 10; i++) {
+        // b and a may be larger than mod
+        mpz_urandomb(b, rs, degree + 70);
+        mpz_urandomb(a, rs, i == 0 ? degree : degree + 70);
+        f2p_mulmod_precomp_t pre;
+        f2p_mulmod_precomp_init(&pre, b, &ctx);
+        f2p_mulmod_precomp(r, a, &pre);
+        f2p_mulmod(expected, a, b, mod, wm);
+        if (mpz_cmp(r, expected) != 0) {
+            printf("test_precomp failure degree = %d i = %d\n", degree, i);
+            ok = 0;
+        }
+        // r = r * b % mod chain, r aliases a
+        mpz_set(r, a);
+        mpz_set(expected, a);
+        for (int j = 0; j < 5; j++) {
+            f2p_mulmod_precomp_aux(r, r, &pre, wm);
+            f2p_mulmod(expected, expected, b, mod, wm);
+        }
+        if (mpz_cmp(r, expected) != 0) {
+            printf("test_precomp chain failure degree = %d i = %d\n",
+                   degree, i);
+            ok = 0;
+        }
+        f2p_mulmod_precomp_clear(&pre);
+    }
+    mpz_set_ui(b, 0);
+    f2p_mulmod_precomp_t zero;
+    f2p_mulmod_precomp_init(&zero, b, &ctx);
+    f2p_mulmod_precomp(r, a, &zero);
+    if (mpz_cmp_ui(r, 0) != 0) {
+        printf("test_precomp zero failure degree = %d\n", degree);
+        ok = 0;
+    }
+    f2p_mulmod_precomp_clear(&zero);
+    if (ctx.mtable != NULL) {
+        printf("test_precomp Barrett table is made\n");
+        ok = 0;
+    }
+    f2p_modctx_clear(&ctx);
+    mpz_clears(mod, a, b, r, expected, NULL);
+    if (verbose && !ok) {
+        printf("degree = %d\n", degree);
+    }
+    return ok;
+}
+
+int test_precomp(int verbose)
+{
+    if (verbose) {
+        printf("start test_precomp\n");
+    }
+    int ok = 1;
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 4321);
+    int degrees[] = {0, 1, 2, 5, 63, 64, 65, 127, 128, 129, 200, 521,
+                     607, 1279, 2203, 19937};
+    for (int i = 0; i < (int)(sizeof(degrees) / sizeof(int)); i++) {
+        ok &= test_precomp_aux(verbose, degrees[i], rs, &wm);
+    }
+    gmp_randclear(rs);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_precomp\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_precomp_speed(int verbose)
+{
+    if (!verbose) {
+        return 1;
+    }
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 1);
+    mpz_t mod, b, r;
+    mpz_inits(mod, b, r, NULL);
+    int degree = 19937;
+    int count = 200;
+    mpz_urandomb(mod, rs, degree);
+    mpz_setbit(mod, degree);
+    mpz_urandomb(b, rs, degree);
+    mpz_urandomb(r, rs, degree);
+    f2p_modctx_t ctx;
+    f2p_modctx_init(&ctx, mod);
+    f2p_mulmod_precomp_t pre;
+    f2p_mulmod_precomp_init(&pre, b, &ctx);
+    clock_t start = clock();
+    for (int i = 0; i < count; i++) {
+        f2p_mulmod(r, r, b, mod, &wm);
+    }
+    double t1 = (double)(clock() - start) * 1000 / CLOCKS_PER_SEC;
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        f2p_mulmod_precomp_aux(r, r, &pre, &wm);
+    }
+    double t2 = (double)(clock() - start) * 1000 / CLOCKS_PER_SEC;
+    printf("degree %d mulmod %.3f ms, precomp %.3f ms\n", degree,
+           t1 / count, t2 / count);
+    f2p_mulmod_precomp_clear(&pre);
+    f2p_modctx_clear(&ctx);
+    mpz_clears(mod, b, r, NULL);
+    gmp_randclear(rs);
+    f2p_wm_clear(&wm);
+    return 1;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_precomp(verbose);
+    ok *= test_precomp_speed(verbose);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * @file test_profile.c
+ *
+ * @brief test program for f2p_profile.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#define LINEARITY_CHECK
+#include "tinymt32.h"
+#include "f2p_profile.h"
+#include <stdlib.h>
+
+static uint64_t tiny_gen(void *state)
+{
+    return tinymt32_generate_uint32((tinymt32_t *)state);
+}
+
+int test_profile(int verbose, int num_threads)
+{
+    if (verbose) {
+        printf("start test_profile\n");
+    }
+    int ok = 1;
+    tinymt32_t tiny32;
+    tiny32.mat1 = 0x8f7011ee;
+    tiny32.mat2 = 0xfc78ff1f;
+    tiny32.tmat = 0x3793fdff;
+    tinymt32_init(&tiny32, 1);
+    uint64_t masks[34];
+    for (int i = 0; i < 32; i++) {
+        masks[i] = UINT64_C(1) << i;
+    }
+    masks[32] = 0;
+    masks[33] = 0x81;
+    f2p_profile_t report;
+    f2p_profile_bits(&report, tiny_gen, &tiny32, sizeof(tiny32),
+                     masks, 34, 127, num_threads);
+    if (verbose) {
+        f2p_profile_fprint(stdout, &report);
+    }
+    mpz_t expected;
+    mpz_init(expected);
+    f2p_set_hexstr(expected, "d8524022ed8dff4a8dcc50c798faba43");
+    for (int i = 0; i < 32; i++) {
+        if (report.degree[i] != 127 || report.class_id[i] != 0) {
+            printf("mask %d degree = %d class = %d\n", i,
+                   report.degree[i], report.class_id[i]);
+            ok = 0;
+        }
+    }
+    if (mpz_cmp(report.minpoly[0], expected) != 0) {
+        printf("minpoly of bit 0 differs\n");
+        ok = 0;
+    }
+    if (report.degree[32] != 0 || report.class_id[32] != 32) {
+        printf("mask 0 degree = %d class = %d\n",
+               report.degree[32], report.class_id[32]);
+        ok = 0;
+    }
+    if (report.degree[33] != 127 || report.class_id[33] != 0) {
+        printf("mask 0x81 degree = %d class = %d\n",
+               report.degree[33], report.class_id[33]);
+        ok = 0;
+    }
+    if (report.num_classes != 2) {
+        printf("num_classes = %d\n", report.num_classes);
+        ok = 0;
+    }
+    mpz_clear(expected);
+    f2p_profile_clear(&report);
+    if (verbose) {
+        printf("end test_profile\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_profile(verbose, 1);
+    ok *= test_profile(verbose, 4);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -0,0 +1,311 @@
+/**
+ * @file test_random.c
+ *
+ * @brief test program for f2p_random.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "f2p_random.h"
+#include "tinymt32.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+static uint64_t generate(void *state)
+{
+    tinymt32_t *tiny = state;
+    uint64_t x = tinymt32_generate_uint32(tiny);
+    return (x << 32) | tinymt32_generate_uint32(tiny);
+}
+
+static double elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1000.0
+        + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+struct SEARCH_T {
+    f2p_control_t control;
+    mpz_t poly;
+    int degree;
+    int found;
+};
+
+static void * search_main(void *p)
+{
+    struct SEARCH_T *search = p;
+    tinymt32_t tiny;
+    tinymt32_init(&tiny, 1234);
+    f2p_control_set(&search->control);
+    search->found = f2p_random_irreducible(search->poly, search->degree,
+                                           generate, &tiny, 0);
+    f2p_control_set(NULL);
+    return NULL;
+}
+
+/**
+ * order of t modulo poly by brute force
+ */
+static long order_of_t(mpz_t poly, f2p_wm_t *wm)
+{
+    mpz_t x;
+    mpz_init_set_ui(x, 2);
+    f2p_mod(x, poly, wm);
+    long order = 1;
+    while (mpz_cmp_ui(x, 1) != 0 && order < 1000000) {
+        f2p_lshift(x, 1);
+        f2p_mod(x, poly, wm);
+        order++;
+    }
+    mpz_clear(x);
+    return order;
+}
+
+int test_random_irreducible(int verbose)
+{
+    if (verbose) {
+        printf("start test_random_irreducible\n");
+    }
+    int ok = 1;
+    setenv("F2P_NUM_THREADS", "4", 1);
+    tinymt32_t tiny;
+    tinymt32_init(&tiny, 1234);
+    mpz_t poly;
+    mpz_t poly2;
+    mpz_inits(poly, poly2, NULL);
+    int degrees[] = {1, 2, 3, 8, 13, 31, 64, 100, 300};
+    for (int i = 0; i < 9; i++) {
+        for (int j = 0; j < 3; j++) {
+            if (!f2p_random_irreducible(poly, degrees[i], generate, &tiny,
+                                        0)
+                || (int)f2p_degree(poly) != degrees[i]
+                || !f2p_is_irreducible(poly)) {
+                printf("test_random_irreducible failure degree = %d\n",
+                       degrees[i]);
+                ok = 0;
+            }
+        }
+    }
+    // same result for any number of threads
+    tinymt32_init(&tiny, 5678);
+    f2p_random_irreducible(poly, 200, generate, &tiny, 1);
+    tinymt32_init(&tiny, 5678);
+    f2p_random_irreducible(poly2, 200, generate, &tiny, 4);
+    if (mpz_cmp(poly, poly2) != 0) {
+        printf("test_random_irreducible failure threads\n");
+        ok = 0;
+    }
+    // shared sieve of any degree gives the same result
+    f2p_sieve_t sieve;
+    f2p_sieve_init(&sieve, 5);
+    for (int j = 0; j < 3; j++) {
+        tinymt32_init(&tiny, (uint32_t)(100 + j));
+        f2p_random_irreducible(poly, 64, generate, &tiny, 0);
+        tinymt32_init(&tiny, (uint32_t)(100 + j));
+        if (!f2p_random_irreducible_sieve(poly2, 64, &sieve, generate,
+                                          &tiny, 0)
+            || mpz_cmp(poly, poly2) != 0) {
+            printf("test_random_irreducible failure sieve\n");
+            ok = 0;
+        }
+    }
+    f2p_sieve_clear(&sieve);
+    // cancelled by the control of the caller
+    f2p_control_t ctl = {1, 0, 0};
+    f2p_control_set(&ctl);
+    if (f2p_random_irreducible(poly, 200, generate, &tiny, 0) != 0) {
+        printf("test_random_irreducible failure cancel\n");
+        ok = 0;
+    }
+    f2p_control_set(NULL);
+    // cancelled while the irreducibility of candidates is tested
+    struct SEARCH_T search;
+    f2p_control_t zero = {0, 0, 0, NULL};
+    search.control = zero;
+    search.degree = 20000;
+    search.found = -1;
+    mpz_init(search.poly);
+    pthread_t th;
+    struct timespec t0;
+    struct timespec t1;
+    struct timespec wait = {1, 0};
+    pthread_create(&th, NULL, search_main, &search);
+    nanosleep(&wait, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    f2p_control_cancel(&search.control);
+    pthread_join(th, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (verbose) {
+        printf("search of degree %d stopped in %.2fms\n", search.degree,
+               elapsed(&t0, &t1));
+    }
+    // a test of candidate takes seconds without forwarding of cancel
+    if (search.found != 0 || elapsed(&t0, &t1) > 1000) {
+        printf("test_random_irreducible failure cancel search\n");
+        ok = 0;
+    }
+    mpz_clear(search.poly);
+    mpz_clears(poly, poly2, NULL);
+    if (verbose) {
+        printf("end test_random_irreducible\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_random_primitive(int verbose)
+{
+    if (verbose) {
+        printf("start test_random_primitive\n");
+    }
+    int ok = 1;
+    tinymt32_t tiny;
+    tinymt32_init(&tiny, 4321);
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    mpz_t poly;
+    mpz_init(poly);
+    // 2^12 - 1 = 3^2 * 5 * 7 * 13, 2^16 - 1 = 3 * 5 * 17 * 257
+    unsigned long f12[] = {3, 5, 7, 13};
+    unsigned long f16[] = {3, 5, 17, 257};
+    mpz_t factors[4];
+    for (int k = 0; k < 2; k++) {
+        int degree = k == 0 ? 12 : 16;
+        for (int i = 0; i < 4; i++) {
+            mpz_init_set_ui(factors[i], k == 0 ? f12[i] : f16[i]);
+        }
+        for (int j = 0; j < 10; j++) {
+            f2p_random_primitive(poly, degree, factors, 4, generate, &tiny,
+                                 0);
+            if ((int)f2p_degree(poly) != degree
+                || order_of_t(poly, &wm) != (1L << degree) - 1) {
+                printf("test_random_primitive failure degree = %d\n",
+                       degree);
+                ok = 0;
+            }
+        }
+        for (int i = 0; i < 4; i++) {
+            mpz_clear(factors[i]);
+        }
+    }
+    // 2^127 - 1 is prime
+    f2p_random_primitive(poly, 127, NULL, 0, generate, &tiny, 0);
+    if ((int)f2p_degree(poly) != 127 || !f2p_is_irreducible(poly)) {
+        printf("test_random_primitive failure degree = 127\n");
+        ok = 0;
+    }
+    // shared sieve
+    f2p_sieve_t sieve;
+    f2p_sieve_init(&sieve, f2p_random_sieve_degree(127));
+    for (int j = 0; j < 3; j++) {
+        f2p_random_primitive_sieve(poly, 127, NULL, 0, &sieve, generate,
+                                   &tiny, 0);
+        if ((int)f2p_degree(poly) != 127 || !f2p_is_irreducible(poly)) {
+            printf("test_random_primitive failure sieve\n");
+            ok = 0;
+        }
+    }
+    f2p_sieve_clear(&sieve);
+    mpz_clear(poly);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_random_primitive\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+/**
+ * speed of random irreducible polynomials, verbose mode only
+ */
+void speed_random(int degree, int num_threads)
+{
+    tinymt32_t tiny;
+    tinymt32_init(&tiny, 1);
+    mpz_t poly;
+    mpz_init(poly);
+    struct timespec t0;
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    f2p_random_irreducible(poly, degree, generate, &tiny, num_threads);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("random irreducible of degree %d, %d threads: %.2fms\n", degree,
+           num_threads, elapsed(&t0, &t1));
+    mpz_clear(poly);
+}
+
+/**
+ * speed of many random irreducible polynomials with and without a
+ * shared sieve, verbose mode only
+ */
+void speed_random_sieve(int degree, int count)
+{
+    tinymt32_t tiny;
+    tinymt32_init(&tiny, 1);
+    mpz_t poly;
+    mpz_init(poly);
+    struct timespec t0;
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < count; i++) {
+        f2p_random_irreducible(poly, degree, generate, &tiny, 1);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("%d random irreducible of degree %d: %.2fms\n", count, degree,
+           elapsed(&t0, &t1));
+    f2p_sieve_t sieve;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    f2p_sieve_init(&sieve, f2p_random_sieve_degree(degree));
+    for (int i = 0; i < count; i++) {
+        f2p_random_irreducible_sieve(poly, degree, &sieve, generate, &tiny,
+                                     1);
+    }
+    f2p_sieve_clear(&sieve);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("%d random irreducible of degree %d, shared sieve: %.2fms\n",
+           count, degree, elapsed(&t0, &t1));
+    mpz_clear(poly);
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_random_irreducible(verbose);
+    ok *= test_random_primitive(verbose);
+    printf("\n");
+    if (verbose) {
+        speed_random(521, 1);
+        speed_random(2203, 0);
+        speed_random_sieve(127, 100);
+        speed_random_sieve(521, 20);
+    }
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -0,0 +1,221 @@
+/**
+ * @file test_sieve.c
+ *
+ * @brief test program for f2p_sieve.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "f2p_sieve.h"
+#include "tinymt32.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NUM_POLYS 300
+#define DEGREE 12
+
+static void random_poly(mpz_t r, int degree, tinymt32_t *tiny)
+{
+    int size = degree / 32 + 1;
+    uint32_t *w = malloc(sizeof(uint32_t) * size);
+    for (int i = 0; i < size; i++) {
+        w[i] = tinymt32_generate_uint32(tiny);
+    }
+    mpz_import(r, size, -1, sizeof(uint32_t), 0, 0, w);
+    free(w);
+    mpz_tdiv_r_2exp(r, r, degree);
+    mpz_setbit(r, degree);
+}
+
+static double elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1000.0
+        + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static mpz_t small_irr[1000];
+static int num_small_irr = 0;
+
+/**
+ * 1 if poly has no irreducible factor of degree DEGREE or less, by
+ * trial division.
+ */
+static int trial_division(mpz_t poly, f2p_wm_t *wm)
+{
+    if (num_small_irr == 0) {
+        for (unsigned long i = 2; i < (2UL << DEGREE); i++) {
+            mpz_init_set_ui(small_irr[num_small_irr], i);
+            if (f2p_is_irreducible(small_irr[num_small_irr])) {
+                num_small_irr++;
+            } else {
+                mpz_clear(small_irr[num_small_irr]);
+            }
+        }
+    }
+    if (mpz_cmp_ui(poly, 0) == 0) {
+        return 0;
+    }
+    if ((int)f2p_degree(poly) <= DEGREE) {
+        return f2p_is_irreducible(poly);
+    }
+    mpz_t r;
+    mpz_init(r);
+    int result = 1;
+    for (int i = 0; i < num_small_irr && result; i++) {
+        mpz_set(r, poly);
+        f2p_mod(r, small_irr[i], wm);
+        if (mpz_cmp_ui(r, 0) == 0) {
+            result = 0;
+        }
+    }
+    mpz_clear(r);
+    return result;
+}
+
+int test_sieve(int verbose)
+{
+    if (verbose) {
+        printf("start test_sieve\n");
+    }
+    int ok = 1;
+    f2p_sieve_t sieve;
+    f2p_sieve_init(&sieve, DEGREE);
+    // number and total degree of irreducible polynomials of degree <= 12
+    if (sieve.count != 747 || sieve.product_degree != 8032) {
+        printf("test_sieve count = %d degree = %d\n", sieve.count,
+               sieve.product_degree);
+        ok = 0;
+    }
+    tinymt32_t tiny;
+    tinymt32_init(&tiny, 5678);
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    mpz_t polys[NUM_POLYS];
+    int result[NUM_POLYS];
+    for (int i = 0; i < NUM_POLYS; i++) {
+        mpz_init(polys[i]);
+        int degree = tinymt32_generate_uint32(&tiny) % 200 + 1;
+        if (i % 50 == 0) {
+            degree = 9000; // larger than the product
+        } else if (i % 10 == 0) {
+            degree = 2048 + i; // remainder tree in batch mode
+        }
+        random_poly(polys[i], degree, &tiny);
+        mpz_setbit(polys[i], 0);
+    }
+    mpz_set_ui(polys[1], 0);
+    mpz_set_ui(polys[2], 0x13); // t^4 + t + 1
+    mpz_set_ui(polys[3], 0x15); // t^4 + t^2 + 1
+    f2p_sieve_check_batch(result, &sieve, polys, NUM_POLYS, 0);
+    for (int i = 0; i < NUM_POLYS; i++) {
+        int expected = trial_division(polys[i], &wm);
+        int r = f2p_sieve_check(&sieve, polys[i]);
+        if (r != expected || result[i] != expected) {
+            printf("test_sieve failure i = %d, %d %d %d\n", i, expected,
+                   r, result[i]);
+            ok = 0;
+        }
+        if (f2p_is_irreducible_sieve(&sieve, polys[i])
+            != f2p_is_irreducible(polys[i])) {
+            printf("test_sieve irreducible failure i = %d\n", i);
+            ok = 0;
+        }
+    }
+    for (int i = 0; i < NUM_POLYS; i++) {
+        mpz_clear(polys[i]);
+    }
+    for (int i = 0; i < num_small_irr; i++) {
+        mpz_clear(small_irr[i]);
+    }
+    f2p_wm_clear(&wm);
+    f2p_sieve_clear(&sieve);
+    if (verbose) {
+        printf("end test_sieve\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+/**
+ * speed of filtering random candidates, verbose mode only
+ */
+void speed_sieve(int degree, int count)
+{
+    tinymt32_t tiny;
+    tinymt32_init(&tiny, 1);
+    mpz_t *polys = malloc(count * sizeof(mpz_t));
+    int *result = malloc(count * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        mpz_init(polys[i]);
+        random_poly(polys[i], degree, &tiny);
+        mpz_setbit(polys[i], 0);
+    }
+    struct timespec t0;
+    struct timespec t1;
+    struct timespec t2;
+    struct timespec t3;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    f2p_sieve_t sieve;
+    f2p_sieve_init(&sieve, 16);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    f2p_sieve_check_batch(result, &sieve, polys, count, 0);
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        if (result[i]) {
+            found += f2p_is_irreducible(polys[i]);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+    int expected = 0;
+    for (int i = 0; i < count; i++) {
+        expected += f2p_is_irreducible(polys[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t3);
+    printf("%d candidates of degree %d: %d irreducible, sieve init %.2fms,"
+           " sieve %.2fms, f2p_is_irreducible %.2fms\n", count, degree,
+           expected, elapsed(&t0, &t1), elapsed(&t1, &t2),
+           elapsed(&t2, &t3));
+    if (found != expected) {
+        printf("speed_sieve failure\n");
+    }
+    f2p_sieve_clear(&sieve);
+    for (int i = 0; i < count; i++) {
+        mpz_clear(polys[i]);
+    }
+    free(polys);
+    free(result);
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_sieve(verbose);
+    printf("\n");
+    if (verbose) {
+        speed_sieve(521, 2000);
+    }
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
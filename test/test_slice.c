@@ -0,0 +1,311 @@
+/**
+ * @file test_slice.c
+ *
+ * @brief test program for f2p_slice.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_slice.h"
+#include <stdio.h>
+#include <time.h>
+
+/*
+ * random lanes, degree of lane l is at most maxdeg and at least 0
+ */
+static void random_slice(f2p_slice_t *s, int maxdeg, int nonzero,
+                         gmp_randstate_t rs, mpz_t z)
+{
+    f2p_slice_zero(s);
+    for (int l = 0; l < 64; l++) {
+        int deg = (int)gmp_urandomm_ui(rs, maxdeg + 1);
+        mpz_urandomb(z, rs, deg);
+        if (nonzero) {
+            mpz_setbit(z, deg);
+        }
+        f2p_slice_set_lane(s, l, z);
+    }
+}
+
+int test_slice_ops(int verbose)
+{
+    if (verbose) {
+        printf("start test_slice_ops\n");
+    }
+    int ok = 1;
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 97);
+    mpz_t x, y, m, z, expected;
+    mpz_inits(x, y, m, z, expected, NULL);
+    f2p_slice_t a;
+    f2p_slice_t b;
+    f2p_slice_t mod;
+    f2p_slice_t r;
+    uint64_t u[64];
+    uint64_t v[64];
+    for (int i = 0; i < 64; i++) {
+        u[i] = gmp_urandomb_ui(rs, 32) << 32 | gmp_urandomb_ui(rs, 32);
+    }
+    f2p_slice_set_u64(&a, u);
+    f2p_slice_get_u64(v, &a);
+    for (int l = 0; l < 64; l++) {
+        f2p_slice_get_lane(z, &a, l);
+        mpz_set_ui(x, (unsigned long)(u[l] >> 32));
+        mpz_mul_2exp(x, x, 32);
+        mpz_add_ui(x, x, (unsigned long)(u[l] & 0xffffffffUL));
+        if (v[l] != u[l] || mpz_cmp(x, z) != 0) {
+            printf("test_slice u64 failure lane = %d\n", l);
+            ok = 0;
+        }
+    }
+    for (int i = 0; i < 20; i++) {
+        uint64_t mask = i == 0 ? UINT64_MAX
+            : gmp_urandomb_ui(rs, 32) << 32 | gmp_urandomb_ui(rs, 32);
+        random_slice(&a, 2 * F2P_SLICE_MAX_DEGREE - 1, 0, rs, z);
+        random_slice(&b, F2P_SLICE_MAX_DEGREE, 0, rs, z);
+        random_slice(&mod, F2P_SLICE_MAX_DEGREE, 1, rs, z);
+        random_slice(&r, F2P_SLICE_MAX_DEGREE, 0, rs, z);
+        f2p_slice_t g = r;
+        f2p_slice_t s = r;
+        f2p_slice_t p = r;
+        f2p_slice_t q = r;
+        f2p_slice_add(&s, &a, &b, mask);
+        f2p_slice_lshift(&q, &b, 13, mask);
+        f2p_slice_mod(&r, &a, &mod, mask);
+        f2p_slice_gcd(&g, &b, &mod, mask);
+        f2p_slice_t b0 = b;
+        f2p_slice_mod(&b, &b, &mod, UINT64_MAX);
+        f2p_slice_pow2mod(&p, &b, &mod, mask);
+        int deg[64];
+        f2p_slice_degree(deg, &mod);
+        for (int l = 0; l < 64; l++) {
+            int in = (mask >> l) & 1;
+            f2p_slice_get_lane(x, &a, l);
+            f2p_slice_get_lane(y, &b, l);
+            f2p_slice_get_lane(m, &mod, l);
+            if (deg[l] != (int)f2p_degree(m)) {
+                printf("test_slice degree failure lane = %d\n", l);
+                ok = 0;
+            }
+            if (!in) {
+                // lanes out of mask are unchanged
+                f2p_slice_get_lane(expected, &g, l);
+                f2p_slice_get_lane(z, &r, l);
+                if (mpz_cmp(z, expected) != 0) {
+                    printf("test_slice mask failure lane = %d\n", l);
+                    ok = 0;
+                }
+                continue;
+            }
+            f2p_slice_get_lane(z, &r, l);
+            mpz_set(expected, x);
+            f2p_mod(expected, m, &wm);
+            if (mpz_cmp(z, expected) != 0) {
+                printf("test_slice mod failure i = %d lane = %d\n", i, l);
+                ok = 0;
+            }
+            f2p_slice_get_lane(z, &p, l);
+            f2p_mulmod(expected, y, y, m, &wm);
+            if (mpz_cmp(z, expected) != 0) {
+                printf("test_slice pow2mod failure i = %d lane = %d\n", i, l);
+                ok = 0;
+            }
+            f2p_slice_get_lane(z, &s, l);
+            f2p_slice_get_lane(expected, &b0, l);
+            f2p_add(expected, expected, x);
+            if (mpz_cmp(z, expected) != 0) {
+                printf("test_slice add failure i = %d lane = %d\n", i, l);
+                ok = 0;
+            }
+            f2p_slice_get_lane(z, &q, l);
+            f2p_slice_get_lane(expected, &b0, l);
+            f2p_lshift(expected, 13);
+            if (mpz_cmp(z, expected) != 0) {
+                printf("test_slice lshift failure i = %d lane = %d\n", i, l);
+                ok = 0;
+            }
+        }
+    }
+    // gcd against f2p_gcd
+    for (int i = 0; i < 20; i++) {
+        random_slice(&a, F2P_SLICE_MAX_DEGREE, 0, rs, z);
+        random_slice(&b, F2P_SLICE_MAX_DEGREE, 0, rs, z);
+        // common factor
+        f2p_slice_t c;
+        random_slice(&c, 8, 1, rs, z);
+        for (int l = 0; l < 64; l++) {
+            f2p_slice_get_lane(x, &a, l);
+            f2p_slice_get_lane(y, &b, l);
+            f2p_slice_get_lane(m, &c, l);
+            if (i % 2 == 0) {
+                f2p_mul(x, x, m, &wm);
+                f2p_mul(y, y, m, &wm);
+            }
+            if (l == 0) {
+                mpz_set_ui(x, 0);
+            }
+            if (l == 1) {
+                mpz_set_ui(y, 0);
+            }
+            if (l == 2) {
+                mpz_set_ui(x, 0);
+                mpz_set_ui(y, 0);
+            }
+            f2p_slice_set_lane(&a, l, x);
+            f2p_slice_set_lane(&b, l, y);
+        }
+        f2p_slice_gcd(&r, &a, &b, UINT64_MAX);
+        for (int l = 0; l < 64; l++) {
+            f2p_slice_get_lane(x, &a, l);
+            f2p_slice_get_lane(y, &b, l);
+            f2p_slice_get_lane(z, &r, l);
+            if (mpz_cmp_ui(x, 0) == 0) {
+                mpz_set(expected, y);
+            } else if (mpz_cmp_ui(y, 0) == 0) {
+                mpz_set(expected, x);
+            } else {
+                f2p_gcd(expected, x, y, &wm);
+            }
+            if (mpz_cmp(z, expected) != 0) {
+                printf("test_slice gcd failure i = %d lane = %d\n", i, l);
+                ok = 0;
+            }
+        }
+    }
+    mpz_clears(x, y, m, z, expected, NULL);
+    gmp_randclear(rs);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_slice_ops\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_slice_irreducible(int verbose)
+{
+    if (verbose) {
+        printf("start test_slice_irreducible\n");
+    }
+    int ok = 1;
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 31);
+    mpz_t z;
+    mpz_init(z);
+    f2p_slice_t f;
+    // number of irreducible polynomials of degree 16 is 4080
+    int count = 0;
+    uint64_t u[64];
+    for (uint64_t i = 0; i < (1 << 16); i += 64) {
+        for (int l = 0; l < 64; l++) {
+            u[l] = (1 << 16) | (i + l);
+        }
+        f2p_slice_set_u64(&f, u);
+        count += __builtin_popcountll(f2p_slice_is_irreducible(&f,
+                                                               UINT64_MAX));
+    }
+    if (count != 4080) {
+        printf("test_slice_irreducible count = %d\n", count);
+        ok = 0;
+    }
+    // mixed degrees against f2p_is_irreducible
+    for (int i = 0; i < 50; i++) {
+        random_slice(&f, F2P_SLICE_MAX_DEGREE, 1, rs, z);
+        uint64_t mask = i == 0 ? UINT64_MAX : gmp_urandomb_ui(rs, 32) << 32
+            | gmp_urandomb_ui(rs, 32);
+        uint64_t irr = f2p_slice_is_irreducible(&f, mask);
+        for (int l = 0; l < 64; l++) {
+            f2p_slice_get_lane(z, &f, l);
+            int expected = ((mask >> l) & 1) && f2p_degree(z) >= 1
+                && f2p_is_irreducible_aux(z, &wm);
+            if ((int)((irr >> l) & 1) != expected) {
+                printf("test_slice_irreducible failure i = %d lane = %d\n",
+                       i, l);
+                ok = 0;
+            }
+        }
+    }
+    mpz_clear(z);
+    gmp_randclear(rs);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_slice_irreducible\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_slice_speed(int verbose)
+{
+    if (!verbose) {
+        return 1;
+    }
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 5);
+    mpz_t z;
+    mpz_init(z);
+    f2p_slice_t f;
+    int rounds = 100;
+    int found = 0;
+    clock_t start = clock();
+    for (int i = 0; i < rounds; i++) {
+        f2p_slice_zero(&f);
+        for (int l = 0; l < 64; l++) {
+            mpz_urandomb(z, rs, 64);
+            mpz_setbit(z, 64);
+            mpz_setbit(z, 0);
+            f2p_slice_set_lane(&f, l, z);
+        }
+        found += __builtin_popcountll(f2p_slice_is_irreducible(&f,
+                                                               UINT64_MAX));
+    }
+    double ms = (double)(clock() - start) * 1000 / CLOCKS_PER_SEC;
+    printf("degree 64, %d polynomials, %d irreducible, %.3f us each\n",
+           rounds * 64, found, ms * 1000 / (rounds * 64));
+    mpz_clear(z);
+    gmp_randclear(rs);
+    f2p_wm_clear(&wm);
+    return 1;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_slice_ops(verbose);
+    ok *= test_slice_irreducible(verbose);
+    ok *= test_slice_speed(verbose);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -0,0 +1,181 @@
+/**
+ * @file test_small.c
+ *
+ * @brief test program for f2p_small.h
+ *
+ * results of small polynomials are compared with f2p_poly.c, which
+ * does not use f2p_small.h.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_small.h"
+#include "f2p_poly.h"
+#include <stdio.h>
+#include <time.h>
+
+#if defined(F2P_SMALL)
+static int same(const char *name, mpz_t z, f2p_poly_t *p)
+{
+    mpz_t view;
+    if (mpz_cmp(z, f2p_poly_mpz_view(view, p)) != 0) {
+        printf("%s differs\n", name);
+        return 0;
+    }
+    return 1;
+}
+
+int test_small_clmul(int verbose)
+{
+    if (verbose) {
+        printf("start test_small_clmul\n");
+    }
+    int ok = 1;
+    uint64_t a = UINT64_C(0xfedcba9876543211);
+    uint64_t b = UINT64_C(0x8000000000000003);
+    for (int i = 0; i < 100; i++) {
+        f2p_u128 expected = 0;
+        for (int j = 0; j < 64; j++) {
+            if ((b >> j) & 1) {
+                expected ^= (f2p_u128)a << j;
+            }
+        }
+        if (f2p_small_clmul(a, b) != expected) {
+            printf("clmul differs %d\n", i);
+            ok = 0;
+            break;
+        }
+        a = a * UINT64_C(6364136223846793005) + 1;
+        b = b * UINT64_C(6364136223846793005) + 3;
+    }
+    if (verbose) {
+        printf("end test_small_clmul\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_small_dispatch(int verbose)
+{
+    if (verbose) {
+        printf("start test_small_dispatch\n");
+    }
+    int ok = 1;
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 1234);
+    mpz_t a, b, m, r;
+    mpz_inits(a, b, m, r, NULL);
+    f2p_poly_t pa, pb, pm, pr;
+    f2p_poly_init(&pr);
+    int degs[] = {1, 2, 5, 31, 63, 64, 65, 100, 127};
+    int num = sizeof(degs) / sizeof(int);
+    for (int i = 0; i < num && ok; i++) {
+        for (int j = 0; j < 50 && ok; j++) {
+            mp_bitcnt_t d = (mp_bitcnt_t)degs[i];
+            mpz_urandomb(a, rs, d);
+            mpz_urandomb(b, rs, d);
+            mpz_urandomb(m, rs, d);
+            mpz_setbit(a, d);
+            mpz_setbit(m, d);
+            mpz_setbit(m, 0);
+            f2p_poly_view_mpz(&pa, a);
+            f2p_poly_view_mpz(&pb, b);
+            f2p_poly_view_mpz(&pm, m);
+            mpz_set(r, a);
+            f2p_mod(r, m, &wm);
+            f2p_poly_set(&pr, &pa);
+            f2p_poly_mod(&pr, &pm, &wm);
+            ok &= same("mod", r, &pr);
+            f2p_mulmod(r, a, b, m, &wm);
+            f2p_poly_mulmod(&pr, &pa, &pb, &pm, &wm);
+            ok &= same("mulmod", r, &pr);
+            f2p_gcd(r, a, m, &wm);
+            f2p_poly_gcd(&pr, &pa, &pm, &wm);
+            ok &= same("gcd", r, &pr);
+            if (f2p_is_irreducible(m) != f2p_poly_is_irreducible(&pm)) {
+                printf("irreducible differs degree %d\n", degs[i]);
+                ok = 0;
+            }
+        }
+    }
+    // irreducible polynomials of degree 16
+    int count = 0;
+    for (unsigned long i = 0; i < (1UL << 16); i++) {
+        mpz_set_ui(m, i);
+        mpz_setbit(m, 16);
+        count += f2p_is_irreducible(m);
+    }
+    if (count != 4080) {
+        printf("irreducible count = %d\n", count);
+        ok = 0;
+    }
+    // x^127 + x + 1 is irreducible, x^127 + x^2 + 1 is not
+    mpz_set_ui(m, 3);
+    mpz_setbit(m, 127);
+    ok &= f2p_is_irreducible(m) == 1;
+    mpz_set_ui(m, 5);
+    mpz_setbit(m, 127);
+    ok &= f2p_is_irreducible(m) == 0;
+    if (verbose) {
+        mpz_set_ui(m, 3);
+        mpz_setbit(m, 63);
+        int n = 1000000;
+        clock_t start = clock();
+        for (int i = 0; i < n; i++) {
+            mpz_setbit(m, (mp_bitcnt_t)(1 + i % 60));
+            count += f2p_is_irreducible(m);
+            mpz_clrbit(m, (mp_bitcnt_t)(1 + i % 60));
+        }
+        double ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / n;
+        printf("degree 63 irreducibility %.0f ns\n", ns);
+    }
+    f2p_poly_clear(&pr);
+    mpz_clears(a, b, m, r, NULL);
+    gmp_randclear(rs);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_small_dispatch\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+#endif
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+#if defined(F2P_SMALL)
+    ok *= test_small_clmul(verbose);
+    ok *= test_small_dispatch(verbose);
+#else
+    printf("f2p_small.h is not available");
+#endif
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
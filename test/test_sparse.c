@@ -0,0 +1,155 @@
+/**
+ * @file test_sparse.c
+ *
+ * @brief test program for f2p_sparse.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#include "f2p_sparse.h"
+#include <stdio.h>
+#include <time.h>
+
+static int check(const char *name, int ok)
+{
+    if (!ok) {
+        printf("%s failed\n", name);
+    }
+    return ok;
+}
+
+int test_sparse_small(int verbose)
+{
+    if (verbose) {
+        printf("start test_sparse_small\n");
+    }
+    int ok = 1;
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 1234);
+    mpz_t a, m, r, e, expected;
+    mpz_inits(a, m, r, e, expected, NULL);
+    f2p_sparse_t s;
+    f2p_sparse_init(&s);
+    // x^5 + x^2 + x^2 + x^0 = x^5 + 1
+    int cancel[] = {2, 5, 0, 2};
+    f2p_sparse_set_exps(&s, cancel, 4);
+    ok &= check("cancel", s.size == 2 && s.exp[0] == 5 && s.exp[1] == 0);
+    int exps[][5] = {{127, 1, 0, 0, 0},
+                     {89, 38, 0, 0, 0},
+                     {300, 299, 150, 1, 0},
+                     {521, 32, 0, 0, 0},
+                     {200, 5, 3, 2, 0},
+                     {64, 63, 0, 0, 0}};
+    int terms[] = {3, 3, 5, 3, 5, 3};
+    for (int i = 0; i < 6; i++) {
+        f2p_sparse_set_exps(&s, exps[i], terms[i]);
+        f2p_sparse_get_mpz(m, &s);
+        f2p_sparse_t back;
+        f2p_sparse_init(&back);
+        f2p_sparse_set_mpz(&back, m);
+        ok &= check("conversion", back.size == terms[i]
+                    && back.exp[0] == exps[i][0]
+                    && back.exp[terms[i] - 1] == exps[i][terms[i] - 1]);
+        f2p_sparse_clear(&back);
+        for (int j = 0; j < 10; j++) {
+            mpz_urandomb(a, rs, 3 * (mp_bitcnt_t)exps[i][0]);
+            mpz_set(r, a);
+            f2p_sparse_mod(r, &s);
+            mpz_set(expected, a);
+            f2p_mod(expected, m, &wm);
+            ok &= check("mod", mpz_cmp(r, expected) == 0);
+            f2p_sparse_mul(r, &s, a, &wm);
+            f2p_mul(expected, m, a, &wm);
+            ok &= check("mul", mpz_cmp(r, expected) == 0);
+            mpz_urandomb(e, rs, 100);
+            f2p_sparse_powermod(r, a, e, &s, &wm);
+            f2p_powermod(expected, a, e, m, &wm);
+            ok &= check("powermod", mpz_cmp(r, expected) == 0);
+        }
+    }
+    f2p_sparse_clear(&s);
+    mpz_clears(a, m, r, e, expected, NULL);
+    gmp_randclear(rs);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_sparse_small\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_sparse_large(int verbose)
+{
+    if (verbose) {
+        printf("start test_sparse_large\n");
+    }
+    int ok = 1;
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 1234);
+    mpz_t a, u, v;
+    mpz_inits(a, u, v, NULL);
+    f2p_sparse_t s;
+    f2p_sparse_init(&s);
+    int exps[] = {100000, 8977, 4011, 36, 0};
+    f2p_sparse_set_exps(&s, exps, 5);
+    // a = u * s + v, then a % s should be v
+    mpz_urandomb(u, rs, 100000);
+    mpz_urandomb(v, rs, 100000);
+    f2p_sparse_mul(a, &s, u, &wm);
+    f2p_add(a, a, v);
+    clock_t start = clock();
+    f2p_sparse_mod(a, &s);
+    double ms = (double)(clock() - start) * 1000 / CLOCKS_PER_SEC;
+    ok &= check("large mod", mpz_cmp(a, v) == 0);
+    if (verbose) {
+        printf("degree 200000 mod pentanomial of degree 100000 %.3f ms\n",
+               ms);
+    }
+    f2p_sparse_clear(&s);
+    mpz_clears(a, u, v, NULL);
+    gmp_randclear(rs);
+    f2p_wm_clear(&wm);
+    if (verbose) {
+        printf("end test_sparse_large\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_sparse_small(verbose);
+    ok *= test_sparse_large(verbose);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
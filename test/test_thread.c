@@ -0,0 +1,167 @@
+/**
+ * @file test_thread.c
+ *
+ * @brief test program for f2p_thread.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "f2p_gmp.h"
+#include "f2p_thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_TASKS 64
+#define NUM_JOBS 40
+
+struct SUM_ARG_T {
+    int index;
+    long result;
+    int worker;
+    f2p_wm_t *wm;
+};
+
+static void sum_task(void *p)
+{
+    struct SUM_ARG_T *arg = p;
+    long s = 0;
+    for (int i = 0; i <= arg->index * 1000; i++) {
+        s += i;
+    }
+    arg->result = s;
+    arg->worker = f2p_executor_worker();
+    arg->wm = f2p_wm_thread_local();
+}
+
+struct NESTED_ARG_T {
+    mpz_t mod;
+    mpz_t x;
+    mpz_t r[NUM_JOBS];
+};
+
+static void nested_job(int index, int worker, void *p)
+{
+    (void)worker;
+    struct NESTED_ARG_T *arg = p;
+    mpz_t e;
+    mpz_init_set_ui(e, index + 1000);
+    f2p_powermod(arg->r[index], arg->x, e, arg->mod, f2p_wm_thread_local());
+    mpz_clear(e);
+}
+
+static void nested_task(void *p)
+{
+    f2p_parallel_for(NUM_JOBS, 4, nested_job, p);
+}
+
+int test_executor(int verbose)
+{
+    if (verbose) {
+        printf("start test_executor\n");
+    }
+    int ok = 1;
+    if (f2p_executor_size() != 3 || f2p_num_threads(0) != 3) {
+        printf("test_executor size = %d\n", f2p_executor_size());
+        ok = 0;
+    }
+    if (f2p_executor_worker() != -1) {
+        printf("test_executor main thread is a worker\n");
+        ok = 0;
+    }
+    struct SUM_ARG_T arg[NUM_TASKS];
+    f2p_task_group_t group;
+    f2p_task_group_init(&group);
+    for (int i = 0; i < NUM_TASKS; i++) {
+        arg[i].index = i;
+        f2p_task_submit(&group, sum_task, &arg[i]);
+    }
+    f2p_task_group_wait(&group);
+    if (group.count != 0) {
+        ok = 0;
+    }
+    for (int i = 0; i < NUM_TASKS; i++) {
+        long n = i * 1000L;
+        if (arg[i].result != n * (n + 1) / 2) {
+            printf("test_executor sum failure i = %d\n", i);
+            ok = 0;
+        }
+        // one working memory for one worker
+        for (int j = 0; j < i; j++) {
+            if ((arg[i].worker == arg[j].worker) != (arg[i].wm == arg[j].wm)) {
+                printf("test_executor wm failure i = %d j = %d\n", i, j);
+                ok = 0;
+            }
+        }
+    }
+    // tasks which run parallel for and wait in it
+    struct NESTED_ARG_T nested[4];
+    f2p_task_group_init(&group);
+    for (int i = 0; i < 4; i++) {
+        mpz_init(nested[i].mod);
+        mpz_init_set_ui(nested[i].x, 2 + i);
+        f2p_set_hexstr(nested[i].mod, "80000000000000000000000000000045");
+        for (int j = 0; j < NUM_JOBS; j++) {
+            mpz_init(nested[i].r[j]);
+        }
+        f2p_task_submit(&group, nested_task, &nested[i]);
+    }
+    f2p_task_group_wait(&group);
+    mpz_t e;
+    mpz_t expected;
+    mpz_init(e);
+    mpz_init(expected);
+    f2p_wm_t wm;
+    f2p_wm_init(&wm, 10);
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < NUM_JOBS; j++) {
+            mpz_set_ui(e, j + 1000);
+            f2p_powermod(expected, nested[i].x, e, nested[i].mod, &wm);
+            if (mpz_cmp(expected, nested[i].r[j]) != 0) {
+                printf("test_executor nested failure i = %d j = %d\n", i, j);
+                ok = 0;
+            }
+            mpz_clear(nested[i].r[j]);
+        }
+        mpz_clear(nested[i].mod);
+        mpz_clear(nested[i].x);
+    }
+    f2p_wm_clear(&wm);
+    mpz_clear(e);
+    mpz_clear(expected);
+    if (verbose) {
+        printf("end test_executor\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    setenv("F2P_NUM_THREADS", "3", 1);
+    ok *= test_executor(verbose);
+    printf("\n");
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
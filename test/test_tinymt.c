@@ -0,0 +1,211 @@
+/**
+ * @file test_tinymt.c
+ *
+ * @brief test program for f2p_tinymt.c
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "f2p_tinymt.h"
+#include "tinymt32.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1000.0
+        + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+/**
+ * minimal polynomial of outputs of tinymt32.c
+ */
+static void tinymt32_minpoly(mpz_t poly, f2p_tinymt32_param_t *param,
+                             uint32_t seed)
+{
+    tinymt32_t tiny;
+    tiny.mat1 = param->mat1;
+    tiny.mat2 = param->mat2;
+    tiny.tmat = param->tmat;
+    tinymt32_init(&tiny, seed);
+    mpz_t seq;
+    mpz_init(seq);
+    for (int i = 0; i < 2 * F2P_TINYMT32_MEXP; i++) {
+        if (tinymt32_generate_uint32(&tiny) & 1) {
+            mpz_setbit(seq, (mp_bitcnt_t)i);
+        }
+    }
+    f2p_minpoly(poly, seq, F2P_TINYMT32_MEXP);
+    mpz_clear(seq);
+}
+
+int test_tinymt32_check(int verbose)
+{
+    if (verbose) {
+        printf("start test_tinymt32_check\n");
+    }
+    int ok = 1;
+    f2p_tinymt32_param_t param;
+    f2p_tinymt32_param_init(&param);
+    mpz_t poly;
+    mpz_init(poly);
+    // parameter set of test_minpoly.c
+    param.mat1 = 0x8f7011ee;
+    param.mat2 = 0xfc78ff1f;
+    param.tmat = 0x3793fdff;
+    tinymt32_minpoly(poly, &param, 1234);
+    if (f2p_tinymt32_check(&param) != 1
+        || mpz_cmp(poly, param.charpoly) != 0
+        || param.weight != (int)mpz_popcount(poly)) {
+        printf("test_tinymt32_check failure known parameter\n");
+        ok = 0;
+    }
+    int accepted = 0;
+    for (uint64_t id = 0; id < 2000; id++) {
+        f2p_tinymt32_candidate(&param, 99, id);
+        int r = f2p_tinymt32_check(&param);
+        if (!r) {
+            continue;
+        }
+        accepted++;
+        tinymt32_minpoly(poly, &param, (uint32_t)id);
+        if (mpz_cmp(poly, param.charpoly) != 0
+            || !f2p_is_irreducible(poly)) {
+            printf("test_tinymt32_check failure id = %lu\n",
+                   (unsigned long)id);
+            ok = 0;
+        }
+    }
+    if (accepted == 0) {
+        printf("test_tinymt32_check no parameter accepted\n");
+        ok = 0;
+    }
+    mpz_clear(poly);
+    f2p_tinymt32_param_clear(&param);
+    if (verbose) {
+        printf("end test_tinymt32_check\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+int test_tinymt32_search(int verbose)
+{
+    if (verbose) {
+        printf("start test_tinymt32_search\n");
+    }
+    int ok = 1;
+    setenv("F2P_NUM_THREADS", "4", 1);
+    enum {N = 12};
+    f2p_tinymt32_param_t a[N];
+    f2p_tinymt32_param_t b[N];
+    for (int i = 0; i < N; i++) {
+        f2p_tinymt32_param_init(&a[i]);
+        f2p_tinymt32_param_init(&b[i]);
+    }
+    uint64_t id_a = 0;
+    uint64_t id_b = 0;
+    long found = f2p_tinymt32_search(a, N, 5, &id_a, 1);
+    // continued search with threads
+    found += f2p_tinymt32_search(b, N / 2, 5, &id_b, 0);
+    found += f2p_tinymt32_search(b + N / 2, N / 2, 5, &id_b, 4);
+    if (found != 2 * N || id_a != id_b) {
+        printf("test_tinymt32_search failure found = %ld\n", found);
+        ok = 0;
+    }
+    for (int i = 0; i < N && ok; i++) {
+        if (a[i].id != b[i].id || a[i].mat1 != b[i].mat1
+            || a[i].mat2 != b[i].mat2 || a[i].tmat != b[i].tmat
+            || mpz_cmp(a[i].charpoly, b[i].charpoly) != 0
+            || f2p_degree(a[i].charpoly) != F2P_TINYMT32_MEXP
+            || !f2p_is_irreducible(a[i].charpoly)
+            || (i > 0 && a[i].id <= a[i - 1].id)) {
+            printf("test_tinymt32_search failure i = %d\n", i);
+            ok = 0;
+        }
+    }
+    if (a[N - 1].id + 1 != id_a) {
+        printf("test_tinymt32_search failure next id\n");
+        ok = 0;
+    }
+    FILE *fp = tmpfile();
+    if (fp == NULL || f2p_tinymt32_param_fprint(fp, &a[0]) != 0) {
+        printf("test_tinymt32_search failure fprint\n");
+        ok = 0;
+    }
+    if (fp != NULL) {
+        fclose(fp);
+    }
+    for (int i = 0; i < N; i++) {
+        f2p_tinymt32_param_clear(&a[i]);
+        f2p_tinymt32_param_clear(&b[i]);
+    }
+    if (verbose) {
+        printf("end test_tinymt32_search\n");
+    }
+    if (ok) {
+        printf("o");
+    } else {
+        printf("x");
+    }
+    return ok;
+}
+
+/**
+ * speed of search, verbose mode only
+ */
+void speed_tinymt32(long count)
+{
+    f2p_tinymt32_param_t *params = malloc(count
+                                          * sizeof(f2p_tinymt32_param_t));
+    for (long i = 0; i < count; i++) {
+        f2p_tinymt32_param_init(&params[i]);
+    }
+    uint64_t id = 0;
+    struct timespec t0;
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    long found = f2p_tinymt32_search(params, count, 1, &id, 0);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("%ld parameter sets from %lu candidates: %.2fms\n", found,
+           (unsigned long)id, elapsed(&t0, &t1));
+    for (long i = 0; i < count; i++) {
+        f2p_tinymt32_param_clear(&params[i]);
+    }
+    free(params);
+}
+
+int main(int argc, char * argv[])
+{
+    int verbose = 0;
+    int ok = 1;
+    if (argc > 1 && argv[1][0] == 'v') {
+        verbose = 1;
+    }
+    ok *= test_tinymt32_check(verbose);
+    ok *= test_tinymt32_search(verbose);
+    printf("\n");
+    if (verbose) {
+        speed_tinymt32(1000);
+    }
+    if (ok == 1) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef TINYMT32_JUMP_H
+#define TINYMT32_JUMP_H
+/**
+ * @file tinymt32_jump.h
+ *
+ * @brief state operations of tinymt32 for f2p_jump_apply.
+ *
+ * @author Mutsuo Saito
+ * @author Makoto Matsumoto (Hiroshima University)
+ *
+ * Copyright (C) 2019 Mutsuo Saito, Makoto Matsumoto
+ * and Hiroshima University.
+ * All rights reserved.
+ *
+ * The MIT License is applied to this software, see
+ * LICENSE.txt
+ */
+
+#include "tinymt32.h"
+#include "f2p_jump.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+static void tinymt32_jump_next(void *state)
+{
+    tinymt32_next_state((tinymt32_t *)state);
+}
+
+static void tinymt32_jump_add(void *dst, const void *src)
+{
+    tinymt32_t *d = (tinymt32_t *)dst;
+    const tinymt32_t *s = (const tinymt32_t *)src;
+    for (int i = 0; i < 4; i++) {
+        d->status[i] ^= s->status[i];
+    }
+}
+
+static void tinymt32_jump_clear(void *state)
+{
+    tinymt32_t *t = (tinymt32_t *)state;
+    for (int i = 0; i < 4; i++) {
+        t->status[i] = 0;
+    }
+}
+
+static const f2p_state_ops_t tinymt32_state_ops = {
+    sizeof(tinymt32_t),
+    tinymt32_jump_next,
+    tinymt32_jump_add,
+    tinymt32_jump_clear
+};
+
+/**
+ * jump tinymt32 state.
+ *
+ *@param random tinymt internal status
+ *@param jump jump polynomial calculated by f2p_calc_jump from the
+ * characteristic polynomial of random.
+ */
+inline static void tinymt32_jump(tinymt32_t *random, mpz_t jump)
+{
+    f2p_jump_apply(random, &tinymt32_state_ops, jump, 0);
+}
+
+/**
+ * make tinymt32 substreams.
+ *
+ *@param streams array of n states, streams[i] is base jumped by
+ * i * stride.
+ *@param base base state
+ *@param minpoly characteristic polynomial of base
+ *@param stride jump step between neighbouring streams
+ *@param n number of streams
+ *@param num_threads number of threads, 0 means number of processors
+ */
+inline static void tinymt32_jump_streams(tinymt32_t *streams,
+                                         tinymt32_t *base,
+                                         mpz_t minpoly, mpz_t stride,
+                                         int n, int num_threads)
+{
+    f2p_jump_streams(streams, base, &tinymt32_state_ops, minpoly, stride,
+                     n, num_threads);
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TINYMT32_JUMP_H